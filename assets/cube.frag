@@ -2,17 +2,21 @@ precision mediump float;
 
 uniform float iTime;
 uniform vec2 iResolution;
+
+// Specialized permutations bake the parameters in, so the loops have constant bounds.
+#ifdef AA_SAMPLES
+const int AA = AA_SAMPLES;
+#else
 uniform int AA;
+#endif
+
+#ifdef MAX_STEPS
+const int maxSteps = MAX_STEPS;
+#else
 uniform int maxSteps;
+#endif
 
-float sdBoxFrame(vec3 p, vec3 b, float e) {
-    p = abs(p) - b;
-    vec3 q = abs(p + e) - e;
-    return min(min(
-        length(max(vec3(p.x, q.y, q.z), 0.0)) + min(max(p.x, max(q.y, q.z)), 0.0),
-        length(max(vec3(q.x, p.y, q.z), 0.0)) + min(max(q.x, max(p.y, q.z)), 0.0)),
-        length(max(vec3(q.x, q.y, p.z), 0.0)) + min(max(q.x, max(q.y, p.z)), 0.0));
-}
+#include "sdf.glsl"
 
 float map(in vec3 pos) {
     return sdBoxFrame(pos, vec3(0.5, 0.3, 0.5), 0.025);
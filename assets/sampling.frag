@@ -0,0 +1,9 @@
+precision mediump float;
+
+varying vec2 texCoord;
+uniform sampler2D image;
+
+void main() {
+    // The eight layers are added up.
+    gl_FragColor = texture2D(image, texCoord) * 0.125;
+}
@@ -0,0 +1,10 @@
+attribute vec2 position;
+uniform vec2 offset;
+uniform vec2 scale;
+varying vec2 texCoord;
+
+void main() {
+    // Computed per vertex, where the precision suffices to address every texel.
+    texCoord = (position * 0.5 + 0.5) * scale + offset;
+    gl_Position = vec4(position, 0.0, 1.0);
+}
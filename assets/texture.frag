@@ -0,0 +1,9 @@
+precision mediump float;
+
+varying vec2 fragCoord;
+uniform sampler2D image;
+
+void main() {
+    // Image rows are stored top row first.
+    gl_FragColor = texture2D(image, vec2(fragCoord.x, -fragCoord.y) * 0.5 + 0.5);
+}
@@ -0,0 +1,46 @@
+# Generates a C++ source file that embeds shader assets into the binary as a constexpr table.
+#
+# Usage: cmake -DOUTPUT=<file> -DSHADER_FILES=<file|file|...> -P EmbedShaders.cmake
+#
+# The files are separated by '|' because ';' would split the argument when passed to the command.
+
+string(REPLACE "|" ";" SHADER_FILES "${SHADER_FILES}")
+
+set(SHADER_ARRAYS "")
+set(SHADER_ENTRIES "")
+set(SHADER_COUNT 0)
+foreach(SHADER_FILE IN LISTS SHADER_FILES)
+    get_filename_component(SHADER_NAME ${SHADER_FILE} NAME)
+    file(READ ${SHADER_FILE} SHADER_HEX HEX)
+    string(LENGTH "${SHADER_HEX}" SHADER_HEX_LENGTH)
+    math(EXPR SHADER_SIZE "${SHADER_HEX_LENGTH} / 2")
+    # Every byte becomes a hex escape, so the source needs no other quoting.
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "\\\\x\\1" SHADER_ESCAPED "${SHADER_HEX}")
+    string(APPEND SHADER_ARRAYS "constexpr char SHADER_${SHADER_COUNT}[] = \"${SHADER_ESCAPED}\";\n")
+    string(APPEND SHADER_ENTRIES "    {\"${SHADER_NAME}\", SHADER_${SHADER_COUNT}, ${SHADER_SIZE}},\n")
+    math(EXPR SHADER_COUNT "${SHADER_COUNT} + 1")
+endforeach()
+
+if (SHADER_COUNT EQUAL 0)
+    set(SHADER_ENTRIES "    {nullptr, nullptr, 0},\n")
+endif()
+
+file(WRITE ${OUTPUT}.tmp
+"// Generated by cmake/EmbedShaders.cmake. Do not edit.
+
+#include \"EmbeddedShaders.h\"
+
+namespace {
+
+${SHADER_ARRAYS}
+} // namespace
+
+constexpr EmbeddedShader EMBEDDED_SHADERS[] = {
+${SHADER_ENTRIES}};
+
+constexpr size_t EMBEDDED_SHADER_COUNT = ${SHADER_COUNT};
+")
+
+# Only touch the output when it changed, so that unrelated asset edits do not trigger a rebuild.
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different ${OUTPUT}.tmp ${OUTPUT})
+file(REMOVE ${OUTPUT}.tmp)
@@ -0,0 +1,162 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VALYRIA_ASYNCTEXTURELOADER_H
+#define VALYRIA_ASYNCTEXTURELOADER_H
+
+#include "ImageLoader.h"
+
+#include <GLES2/gl2.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * The pipeline timings of one texture load.
+ */
+struct TextureLoadTiming {
+    std::string filePath;
+    unsigned int width = 0;    ///< Width of the decoded image.
+    unsigned int height = 0;   ///< Height of the decoded image.
+    size_t bytes = 0;          ///< Size of the decoded image.
+    double decodeWaitMs = 0.0; ///< From the request until a worker started decoding.
+    double decodeMs = 0.0;     ///< Decoding on the worker.
+    double uploadWaitMs = 0.0; ///< From the end of decoding until the upload started.
+    double uploadMs = 0.0;     ///< From the first to the last upload call, possibly over several frames.
+    double uploadCallMs = 0.0; ///< Time spent in the upload calls.
+    double totalMs = 0.0;      ///< From the request until the texture was complete.
+};
+
+/**
+ * Loads textures asynchronously: a pool of worker threads decodes images into pooled buffers, and
+ * the GL thread uploads them within a byte budget per frame.
+ *
+ * Requests are queued with `load`, which returns a future of the texture; the future is fulfilled
+ * by `processUploads` on the GL thread, with 0 if the image could not be decoded. Images larger than
+ * the budget are uploaded in strips with `glTexSubImage2D` over several frames. The number of pooled
+ * buffers bounds the memory held by decoded images: workers wait for a free buffer.
+ */
+class AsyncTextureLoader {
+public:
+    AsyncTextureLoader();
+    ~AsyncTextureLoader();
+
+    AsyncTextureLoader(const AsyncTextureLoader &) = delete;
+    AsyncTextureLoader &operator=(const AsyncTextureLoader &) = delete;
+
+    /**
+     * Starts the worker threads.
+     *
+     * @param workerCount The number of decoding threads.
+     * @param bufferCount The number of pooled decode buffers.
+     */
+    void start(unsigned int workerCount, size_t bufferCount);
+
+    /**
+     * Stops the worker threads and fails all outstanding requests. Must be called on the GL thread,
+     * since partially uploaded textures are deleted.
+     */
+    void stop();
+
+    /**
+     * Queues an image for loading.
+     *
+     * @param filePath The path to the image file.
+     * @return The future texture.
+     */
+    std::future<GLuint> load(const std::string &filePath);
+
+    /**
+     * Uploads decoded images until the budget is used up. Called once per frame on the GL thread.
+     * At least one strip of rows is uploaded per call, so images wider than the budget progress.
+     *
+     * @param budgetBytes The number of bytes to upload.
+     */
+    void processUploads(size_t budgetBytes);
+
+    /**
+     * Gets the number of requests waiting for or in decoding.
+     */
+    size_t getDecodeQueueDepth() const;
+
+    /**
+     * Gets the number of decoded images waiting for or in upload.
+     */
+    size_t getUploadQueueDepth() const;
+
+    /**
+     * Takes the timings of the loads completed since the last call.
+     *
+     * @return The timings, in completion order.
+     */
+    std::vector<TextureLoadTiming> takeTimings();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * A texture load moving through the pipeline.
+     */
+    struct Request {
+        std::string filePath;
+        std::promise<GLuint> promise;
+        ImageData image;
+        bool decoded = false;
+        Clock::time_point requestTime;
+        Clock::time_point decodeStartTime;
+        Clock::time_point decodeEndTime;
+        Clock::time_point uploadStartTime;
+        double uploadCallMs = 0.0;
+        GLuint texture = 0;
+        unsigned int nextRow = 0; ///< First row not uploaded yet.
+    };
+
+    /**
+     * Worker thread loop: decodes queued requests into pooled buffers.
+     */
+    void runWorker();
+
+    /**
+     * Completes a request and returns its buffer to the pool.
+     *
+     * @param request The request.
+     * @param texture The texture to deliver, or 0 on failure.
+     */
+    void complete(std::unique_ptr<Request> request, GLuint texture);
+
+    std::vector<std::thread> workers;
+    mutable std::mutex mutex;                            ///< Guards the members below.
+    std::condition_variable workAvailable;               ///< Signals queued requests and freed buffers.
+    std::deque<std::unique_ptr<Request>> decodeQueue;    ///< Requests waiting for a worker.
+    std::deque<std::unique_ptr<Request>> uploadQueue;    ///< Decoded requests waiting for the GL thread.
+    std::vector<ImageData> freeBuffers;                  ///< Pooled decode buffers.
+    size_t decoding;                                     ///< Requests being decoded.
+    bool stopping;
+
+    std::unique_ptr<Request> uploading;       ///< The request being uploaded; GL thread only.
+    std::vector<TextureLoadTiming> timings;   ///< Completed loads; GL thread only.
+};
+
+#endif // VALYRIA_ASYNCTEXTURELOADER_H
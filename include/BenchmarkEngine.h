@@ -20,10 +20,12 @@
 #ifndef VALYRIA_BENCHMARKENGINE_H
 #define VALYRIA_BENCHMARKENGINE_H
 
+#include "FlightRecorder.h"
 #include "GraphicsContext.h"
 #include "MetricsCollector.h"
 #include "RenderTask.h"
 
+#include <chrono>
 #include <memory>
 #include <vector>
 
@@ -52,8 +54,10 @@ public:
 
     /**
      * Runs the benchmarks on multiple RenderTasks in sequence.
+     *
+     * @return False if a significant regression against the configured baselines was detected.
      */
-    void runBenchmarks();
+    bool runBenchmarks();
 
     /**
      * Lists the names of all available RenderTasks.
@@ -64,6 +68,8 @@ private:
     std::unique_ptr<GraphicsContext> graphicsContext;   ///< The graphics context for rendering.
     std::unique_ptr<MetricsCollector> metricsCollector; ///< The metrics collector for gathering performance data.
     std::vector<std::shared_ptr<RenderTask>> tasks;     ///< A list of tasks to be executed during benchmarking.
+    std::chrono::steady_clock::time_point previousTaskEnd; ///< When the previous task's render loop ended.
+    FlightRecorder flightRecorder;                      ///< Recent frame timings, snapshotted on jank spikes.
 
     /**
      * Creates instances of RenderTask objects to be benchmarked.
@@ -75,8 +81,11 @@ private:
      *
      * @param task A shared pointer to the RenderTask to be benchmarked.
      * @param durationInSeconds The duration in seconds for which the benchmark should run.
+     * @param reportName The name the run is reported under.
+     * @param scored Whether the run counts towards the score.
      */
-    void runBenchmark(std::shared_ptr<RenderTask> task, int durationInSeconds);
+    void runBenchmark(std::shared_ptr<RenderTask> task, int durationInSeconds, const std::string &reportName,
+                      bool scored);
 
     /**
      * Cleans up resources used by the BenchmarkEngine.
@@ -0,0 +1,209 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VALYRIA_BINARYREPORT_H
+#define VALYRIA_BINARYREPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Compact columnar result format for long benchmark runs.
+ *
+ * Layout (all integers are unsigned LEB128 varints unless stated otherwise):
+ *
+ *   file    := "VLYR" version:u8 section* 'Z'
+ *   section := 'E' count (string string)*        -- environment
+ *            | 'C' count (string string)*        -- configuration
+ *            | 'T' string scored:u8 columns column*  -- one block per task
+ *   column  := string encoding:u8 metricType:u8 count size payload
+ *   string  := length bytes
+ *
+ * DELTA_VARINT payloads hold zigzag-encoded deltas between consecutive integer values,
+ * FLOAT32 payloads hold little-endian IEEE-754 floats. Version 1 task blocks have no scored flag;
+ * their tasks are read as scored.
+ */
+namespace BinaryReport {
+constexpr char MAGIC[4] = {'V', 'L', 'Y', 'R'};
+constexpr uint8_t VERSION = 2;
+
+enum class SectionTag : uint8_t {
+    ENVIRONMENT = 'E',
+    CONFIGURATION = 'C',
+    TASK = 'T',
+    END = 'Z'
+};
+
+enum class ColumnEncoding : uint8_t {
+    DELTA_VARINT = 0, ///< Monotonic integers such as timestamps.
+    FLOAT32 = 1       ///< Sampled metric values.
+};
+
+constexpr const char *FRAME_TIMESTAMP_COLUMN = "Frame timestamp (us)";
+} // namespace BinaryReport
+
+/**
+ * A small write-behind buffer on top of a POSIX file descriptor.
+ */
+class BufferedFileWriter {
+public:
+    explicit BufferedFileWriter(size_t capacity = 16 * 1024);
+    ~BufferedFileWriter();
+
+    BufferedFileWriter(const BufferedFileWriter &) = delete;
+    BufferedFileWriter &operator=(const BufferedFileWriter &) = delete;
+
+    bool open(const std::string &filePath);
+    void close();
+    bool isOpen() const { return fd >= 0; }
+
+    /**
+     * Writes out the buffered bytes.
+     *
+     * @return False if any write since opening the file has failed.
+     */
+    bool flush();
+
+    void write(const void *data, size_t size);
+    void writeByte(uint8_t value);
+    void writeVarint(uint64_t value);
+    void writeString(const std::string &value);
+
+private:
+    int fd;
+    std::vector<uint8_t> buffer;
+    size_t used;
+    bool failed;
+};
+
+/**
+ * Writes benchmark results in the compact binary format, one task block at a time.
+ */
+class BinaryReportWriter {
+public:
+    /**
+     * Creates the file and writes the environment and configuration sections.
+     *
+     * @param filePath The output file path.
+     * @param environment Static system information.
+     * @param configuration Tool configuration.
+     * @return True if the file was created successfully.
+     */
+    bool open(const std::string &filePath, const std::map<std::string, std::string> &environment,
+              const std::map<std::string, std::string> &configuration);
+
+    /**
+     * Starts a task block.
+     *
+     * @param taskName The name of the task.
+     * @param scored Whether the task's FPS contributes to the score.
+     * @param columnCount The number of columns that will follow.
+     */
+    void beginTask(const std::string &taskName, bool scored, size_t columnCount);
+
+    void writeTimestampColumn(const std::string &name, const std::vector<uint64_t> &values);
+    void writeFloatColumn(const std::string &name, uint8_t metricType, const std::vector<double> &values);
+
+    /**
+     * Completes the task block and flushes it to disk, so that an interrupted run keeps its finished tasks.
+     */
+    bool endTask();
+
+    /**
+     * Writes the end marker and closes the file.
+     */
+    bool close();
+
+    bool isOpen() const { return writer.isOpen(); }
+
+private:
+    BufferedFileWriter writer;
+    std::vector<uint8_t> scratch; ///< Reused encoding buffer for column payloads.
+
+    void writeSection(BinaryReport::SectionTag tag, const std::map<std::string, std::string> &entries);
+    void writeColumn(const std::string &name, BinaryReport::ColumnEncoding encoding, uint8_t metricType,
+                     size_t count);
+};
+
+/**
+ * A column inside a memory-mapped binary report.
+ */
+struct BinaryColumnView {
+    std::string name;
+    BinaryReport::ColumnEncoding encoding;
+    uint8_t metricType;
+    uint64_t count;
+    const uint8_t *payload;
+    size_t payloadSize;
+};
+
+/**
+ * A task block inside a memory-mapped binary report.
+ */
+struct BinaryTaskView {
+    std::string name;
+    bool scored = true; ///< Whether the task's FPS contributes to the score.
+    std::vector<BinaryColumnView> columns;
+};
+
+/**
+ * Reads a binary report through `mmap`. Column payloads are decoded on demand.
+ */
+class BinaryReportReader {
+public:
+    BinaryReportReader();
+    ~BinaryReportReader();
+
+    BinaryReportReader(const BinaryReportReader &) = delete;
+    BinaryReportReader &operator=(const BinaryReportReader &) = delete;
+
+    /**
+     * Maps and indexes the file. A truncated trailing task block is ignored.
+     *
+     * @param filePath The binary report path.
+     * @return True if the header was valid.
+     */
+    bool open(const std::string &filePath);
+    void close();
+
+    const std::map<std::string, std::string> &getEnvironment() const { return environment; }
+    const std::map<std::string, std::string> &getConfiguration() const { return configuration; }
+    const std::vector<BinaryTaskView> &getTasks() const { return tasks; }
+
+    /**
+     * Decodes a column into doubles.
+     *
+     * @param column The column to decode.
+     * @param values Receives the decoded values.
+     * @return False if the payload is malformed.
+     */
+    static bool decodeColumn(const BinaryColumnView &column, std::vector<double> &values);
+
+private:
+    const uint8_t *data;
+    size_t size;
+    std::map<std::string, std::string> environment;
+    std::map<std::string, std::string> configuration;
+    std::vector<BinaryTaskView> tasks;
+};
+
+#endif // VALYRIA_BINARYREPORT_H
@@ -0,0 +1,45 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VALYRIA_EMBEDDEDSHADERS_H
+#define VALYRIA_EMBEDDEDSHADERS_H
+
+#include <cstddef>
+
+/**
+ * A shader asset compiled into the binary.
+ */
+struct EmbeddedShader {
+    const char *fileName; ///< The file name, relative to the asset directory.
+    const char *source;   ///< The file contents, null-terminated.
+    size_t size;          ///< The length of the contents in bytes.
+};
+
+/**
+ * The vertex, fragment and include shaders of the asset directory, generated at build time by
+ * cmake/EmbedShaders.cmake.
+ */
+extern const EmbeddedShader EMBEDDED_SHADERS[];
+
+/**
+ * The number of entries in EMBEDDED_SHADERS.
+ */
+extern const size_t EMBEDDED_SHADER_COUNT;
+
+#endif // VALYRIA_EMBEDDEDSHADERS_H
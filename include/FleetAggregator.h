@@ -0,0 +1,117 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VALYRIA_FLEETAGGREGATOR_H
+#define VALYRIA_FLEETAGGREGATOR_H
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/**
+ * The fields of a single report that the fleet aggregation needs.
+ */
+struct ReportSummary {
+    std::string filePath;
+    std::string deviceName;
+    std::string imageName;
+    std::string renderer;
+    std::string timestamp;
+    double score = 0.0;
+    std::map<std::string, double> taskFPS; ///< Average FPS per task.
+};
+
+/**
+ * Distribution of a value across the reports of one group.
+ */
+struct Distribution {
+    size_t count = 0;
+    double mean = 0.0;
+    double stdDev = 0.0;
+    double minimum = 0.0;
+    double p5 = 0.0;
+    double median = 0.0;
+    double p95 = 0.0;
+    double maximum = 0.0;
+};
+
+/**
+ * Aggregates many Valyria JSON reports collected from a device fleet, grouped by device name,
+ * firmware image name and OpenGL renderer.
+ */
+class FleetAggregator {
+public:
+    using GroupKey = std::tuple<std::string, std::string, std::string>; ///< Device, image, renderer.
+
+    /**
+     * Parses every `valyria_report*.json` report below a directory, except those written by `valyria-convert`,
+     * using a pool of worker threads.
+     *
+     * @param rootDir The directory to scan recursively.
+     * @param threads The number of worker threads; 0 uses all available cores.
+     * @return The number of reports parsed successfully.
+     */
+    size_t ingest(const std::string &rootDir, unsigned threads = 0);
+
+    /**
+     * Writes the per-group distributions as CSV.
+     */
+    bool writeDistributionsCSV(const std::string &filePath) const;
+
+    /**
+     * Writes, per device and renderer, the median score and task FPS of each firmware image,
+     * ordered by the first time the image was seen.
+     */
+    bool writeTrendsCSV(const std::string &filePath) const;
+
+    /**
+     * Writes the distributions and trends as a self-contained HTML page.
+     */
+    bool writeHTML(const std::string &filePath) const;
+
+    /**
+     * Parses a single report file.
+     *
+     * @param filePath The report path.
+     * @param summary Receives the extracted fields.
+     * @return False if the file is not a readable Valyria report.
+     */
+    static bool parseReport(const std::string &filePath, ReportSummary &summary);
+
+private:
+    struct TrendRow {
+        std::string device;
+        std::string renderer;
+        std::string imageName;
+        std::string firstSeen;
+        size_t reports;
+        double medianScore;
+        std::map<std::string, double> medianTaskFPS;
+    };
+
+    std::vector<ReportSummary> reports;
+    std::map<GroupKey, std::vector<const ReportSummary *>> groups;
+
+    static Distribution distribution(std::vector<double> values);
+    std::vector<std::string> taskNames() const;
+    std::vector<TrendRow> trends() const;
+};
+
+#endif // VALYRIA_FLEETAGGREGATOR_H
@@ -0,0 +1,139 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VALYRIA_FLIGHTRECORDER_H
+#define VALYRIA_FLIGHTRECORDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * The loop phase durations of one frame, in milliseconds.
+ */
+struct FrameRecord {
+    uint64_t frame;  ///< Index of the frame within the task.
+    float startMs;   ///< Start of the frame, relative to the start of the task.
+    float updateMs;
+    float renderMs;
+    float displayMs;
+    float sleepMs;
+
+    float totalMs() const { return updateMs + renderMs + displayMs + sleepMs; }
+};
+
+/**
+ * A snapshot of the render loop taken when a frame exceeded the jank threshold.
+ */
+struct JankSpike {
+    FrameRecord spikeFrame;                         ///< The frame that exceeded the threshold.
+    std::vector<FrameRecord> history;               ///< The preceding frames and the spike, oldest first.
+    std::map<std::string, double> collectorSamples; ///< Latest sample of each collector metric.
+    uint64_t voluntaryContextSwitches = 0;          ///< Render thread switches since the previous snapshot.
+    uint64_t involuntaryContextSwitches = 0;        ///< Render thread preemptions since the previous snapshot.
+    std::string loadAverage;                        ///< Contents of `/proc/loadavg`.
+};
+
+/**
+ * Keeps the phase timings of the last frames of a task in a fixed-size ring buffer and takes a
+ * snapshot when a frame exceeds the jank threshold.
+ *
+ * Recording a frame does not allocate or lock. A snapshot is taken at most once per history length,
+ * so that snapshots do not overlap, and at most `MAX_SNAPSHOTS_PER_TASK` times per task; further
+ * spikes are only counted.
+ */
+class FlightRecorder {
+public:
+    static constexpr size_t MAX_SNAPSHOTS_PER_TASK = 8;
+
+    FlightRecorder();
+
+    /**
+     * Allocates the ring buffer.
+     *
+     * @param historyFrames The number of frames kept.
+     * @param thresholdMs Frames taking longer than this are spikes; 0 disables spike detection.
+     */
+    void configure(size_t historyFrames, double thresholdMs);
+
+    double getThresholdMs() const { return thresholdMs; }
+
+    /**
+     * Clears the history before a task and reads the context-switch counters of the calling thread,
+     * which must be the render thread.
+     */
+    void beginTask();
+
+    /**
+     * Records the phase timings of a frame.
+     *
+     * @param record The frame.
+     * @return True if the frame is a spike and a snapshot should be taken.
+     */
+    bool recordFrame(const FrameRecord &record) {
+        if (history.empty()) {
+            return false;
+        }
+        history[nextRecord % history.size()] = record;
+        ++nextRecord;
+        if (thresholdMs <= 0.0 || record.totalMs() <= thresholdMs) {
+            return false;
+        }
+        ++spikes;
+        return snapshots < MAX_SNAPSHOTS_PER_TASK &&
+               (snapshots == 0 || nextRecord - lastSnapshotRecord >= history.size());
+    }
+
+    /**
+     * Takes a snapshot of the history ending with the last recorded frame. Reads from `/proc`, so
+     * it is only called for spikes.
+     *
+     * @return The snapshot, without collector samples.
+     */
+    JankSpike snapshot();
+
+    /**
+     * Gets the number of spikes of the current task, including those without a snapshot.
+     */
+    uint64_t getSpikeCount() const { return spikes; }
+
+private:
+    /**
+     * Reads the context-switch counters of the render thread.
+     *
+     * @param voluntary Set to the number of voluntary context switches.
+     * @param involuntary Set to the number of involuntary context switches.
+     * @return True if the counters were read.
+     */
+    bool readContextSwitches(uint64_t &voluntary, uint64_t &involuntary) const;
+
+    std::vector<FrameRecord> history; ///< The ring buffer.
+    uint64_t nextRecord;              ///< Total number of frames recorded in the task.
+    uint64_t lastSnapshotRecord;      ///< `nextRecord` at the last snapshot.
+    uint64_t spikes;
+    size_t snapshots;
+    double thresholdMs;
+    long renderThreadId;
+    uint64_t voluntarySwitches;   ///< Counter at the last snapshot or the start of the task.
+    uint64_t involuntarySwitches; ///< Counter at the last snapshot or the start of the task.
+};
+
+#endif // VALYRIA_FLIGHTRECORDER_H
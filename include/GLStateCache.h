@@ -0,0 +1,139 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VALYRIA_GLSTATECACHE_H
+#define VALYRIA_GLSTATECACHE_H
+
+#include <GLES2/gl2.h>
+#include <cstdint>
+
+/**
+ * Counts state-changing GL calls routed through the GLStateCache.
+ */
+struct GLStateStatistics {
+    uint64_t issued = 0;   ///< Calls passed on to the driver.
+    uint64_t filtered = 0; ///< Calls dropped because the state was already set.
+};
+
+/**
+ * A singleton that shadows the GL state touched by the render tasks and drops calls that would
+ * not change it.
+ *
+ * All code that changes the tracked state must go through the cache, or call `invalidate`
+ * afterwards. When the cache is disabled every call is passed on, so that the cost of redundant
+ * state changes can be measured.
+ */
+class GLStateCache {
+public:
+    static constexpr int MAX_TEXTURE_UNITS = 16;
+    static constexpr int MAX_VERTEX_ATTRIBS = 16;
+
+    /**
+     * Retrieves the singleton instance of the GLStateCache.
+     *
+     * @return The singleton instance of GLStateCache.
+     */
+    static GLStateCache &getInstance();
+
+    GLStateCache(const GLStateCache &) = delete;
+    GLStateCache &operator=(const GLStateCache &) = delete;
+
+    /**
+     * Enables or disables filtering. Enabling invalidates the shadowed state.
+     *
+     * @param enable Whether redundant calls are dropped.
+     */
+    void setEnabled(bool enable);
+
+    bool isEnabled() const { return enabled; }
+
+    /**
+     * Forgets the shadowed state, e.g. after a new context was made current. Vertex attribute
+     * arrays enabled through the cache are disabled, so a context must be current if any are.
+     */
+    void invalidate();
+
+    void useProgram(GLuint program);
+    void bindArrayBuffer(GLuint buffer);
+    void activeTexture(GLenum unit);
+    void bindTexture(GLenum target, GLuint texture);
+
+    /**
+     * Enables exactly the vertex attribute arrays in the mask and disables all others.
+     *
+     * @param mask Bit `i` enables attribute `i`.
+     */
+    void setVertexAttribArrays(uint32_t mask);
+
+    void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    void setBlendEnabled(bool blend);
+    void blendFunc(GLenum sourceFactor, GLenum destinationFactor);
+    void clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+
+    /**
+     * Deletes GL objects and drops them from the shadowed state, since deleting a bound
+     * object resets the binding.
+     */
+    void deleteProgram(GLuint program);
+    void deleteBuffer(GLuint buffer);
+    void deleteTexture(GLuint texture);
+
+    /**
+     * Gets the call counters accumulated since the start of the run.
+     *
+     * @return The counters.
+     */
+    const GLStateStatistics &getStatistics() const { return statistics; }
+
+private:
+    GLStateCache();
+
+    /**
+     * Records a call and decides whether it must be issued.
+     *
+     * @param changed Whether the call changes the shadowed state.
+     * @return True if the call must be passed on to the driver.
+     */
+    bool shouldIssue(bool changed);
+
+    bool enabled;
+    GLStateStatistics statistics;
+
+    // Shadowed state. The `known` flags are false until the state has been set through the cache.
+    bool programKnown;
+    GLuint program;
+    bool arrayBufferKnown;
+    GLuint arrayBuffer;
+    bool activeTextureKnown;
+    GLenum activeTextureUnit;
+    bool textureKnown[MAX_TEXTURE_UNITS];
+    GLuint boundTextures[MAX_TEXTURE_UNITS];
+    uint32_t attribKnownMask;
+    uint32_t attribEnabledMask;
+    bool viewportKnown;
+    GLint viewportRect[4];
+    bool blendKnown;
+    bool blendEnabled;
+    bool blendFuncKnown;
+    GLenum blendFactors[2];
+    bool clearColorKnown;
+    GLfloat clearColorValue[4];
+};
+
+#endif // VALYRIA_GLSTATECACHE_H
@@ -21,6 +21,7 @@
 #define VALYRIA_GRAPHICSCONTEXT_H
 
 #include <essos.h>
+#include <string>
 
 /**
  * A class that manages the graphics context for rendering operations.
@@ -74,6 +75,14 @@ public:
      */
     void updateDisplay();
 
+    /**
+     * Checks whether the current OpenGL ES context exposes an extension.
+     *
+     * @param extension The extension name, e.g. "GL_OES_get_program_binary".
+     * @return True if the extension is listed in GL_EXTENSIONS.
+     */
+    static bool isExtensionSupported(const std::string &extension);
+
 private:
     EssCtx *context;   ///< Pointer to the Essos context used for rendering.
     int displayWidth;  ///< Width of the display in pixels.
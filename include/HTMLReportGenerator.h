@@ -20,28 +20,52 @@
 #ifndef VALYRIA_HTMLREPORTGEN_H
 #define VALYRIA_HTMLREPORTGEN_H
 
+#include <cstddef>
 #include <fstream>
 #include <string>
 
 #include <cjson/cJSON.h>
 
+/**
+ * Generates a self-contained HTML report from the JSON report. Styles are inlined and charts
+ * are rendered as inline SVG, so the report can be viewed without network access.
+ */
 class HTMLReportGenerator {
 public:
-    HTMLReportGenerator(const cJSON *jsonData, const std::string &filePath);
+    /**
+     * Constructs a report generator.
+     *
+     * @param jsonData The JSON report.
+     * @param filePath The output HTML file path.
+     * @param maxChartPoints The maximum number of points per chart; longer series are downsampled.
+     */
+    HTMLReportGenerator(const cJSON *jsonData, const std::string &filePath, size_t maxChartPoints = 300);
 
     void generateReport();
 
+    /**
+     * Escapes the HTML special characters `&`, `<`, `>`, `"` and `'` in a text.
+     *
+     * @param text The text to escape.
+     * @return The escaped text, safe to use in elements and quoted attributes.
+     */
+    static std::string escapeHTML(const std::string &text);
+
 private:
     std::string generateHeader(const std::string &deviceName) const;
     std::string generateEnvironmentSection(const cJSON *envData) const;
     std::string generateToolConfigSection(const cJSON *toolData) const;
+    std::string generateComparisonSection(const cJSON *comparisonData) const;
+    std::string generateFrameBudgetSection(const cJSON *frameBudgetData) const;
+    std::string generateJankSpikeSection(const cJSON *jankSpikeData) const;
     std::string generateMetricsTabs(const cJSON *metricsData) const;
-    std::string generateSparklineJS() const;
+    std::string generateChart(const cJSON *values) const;
     std::string generateFooter() const;
     std::string formatName(const std::string &name) const;
 
     const cJSON *jsonData;
     std::string filePath;
+    size_t maxChartPoints;
 };
 
 #endif // VALYRIA_HTMLREPORTGEN_H
@@ -20,23 +20,163 @@
 #ifndef VALYRIA_IMAGELOADER_H
 #define VALYRIA_IMAGELOADER_H
 
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <GLES2/gl2.h>
 
+/**
+ * A decoded image in client memory.
+ */
+struct ImageData {
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned int sourceWidth = 0;      ///< Size of the encoded image, larger than the decoded size after scaling.
+    unsigned int sourceHeight = 0;
+    GLenum format = GL_RGBA;           ///< `GL_RGBA` or `GL_RGB`.
+    std::vector<unsigned char> pixels; ///< Tightly packed rows, top row first.
+
+    size_t getSizeBytes() const { return pixels.size(); }
+};
+
+/**
+ * Counts the work done by the image decoders beyond decoding itself.
+ */
+struct ImageDecodeStatistics {
+    uint64_t images = 0;            ///< Images decoded.
+    uint64_t fileOpens = 0;         ///< Files opened.
+    uint64_t bufferAllocations = 0; ///< Heap allocations of file and pixel buffers.
+    uint64_t bytesCopied = 0;       ///< File and pixel bytes copied between buffers.
+};
+
+/**
+ * How the mipmap levels of a texture are created.
+ */
+enum class MipmapGeneration {
+    NONE,
+    CPU, ///< Box-filtered by the ImageLoader and uploaded level by level.
+    GPU  ///< `glGenerateMipmap`.
+};
+
+/**
+ * Describes a texture created from a compressed texture container.
+ */
+struct CompressedTextureInfo {
+    GLenum internalFormat = 0;
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned int levels = 0; ///< Mipmap levels uploaded.
+    size_t sizeBytes = 0;    ///< Compressed size of all levels.
+};
+
 /**
  * A utility class for loading images as OpenGL ES textures.
+ *
+ * Each file is opened once and memory-mapped; the format is detected from the mapped signature and
+ * the image is decoded directly into the destination buffer, which is reused when it is large enough.
+ * KTX and KTX2 containers are not decoded: their pre-compressed mipmap levels are uploaded straight
+ * from the mapping with `glCompressedTexImage2D`.
  */
 class ImageLoader {
 public:
     /**
-     * Loads an image from a file and creates an OpenGL texture.
+     * Loads an image from a file and creates an OpenGL texture. KTX and KTX2 files are loaded with
+     * `loadCompressedTexture`.
      *
      * @param filePath The path to the image file.
      * @return The OpenGL texture ID of the loaded texture, or 0 if loading failed.
      */
     static GLuint loadTextureFromFile(const std::string &filePath);
 
+    /**
+     * Decodes a PNG or JPG image from a file without creating a texture. Both formats are decoded
+     * to RGBA, or JPG to RGB when libjpeg lacks the RGBA extension.
+     *
+     * When a target size is given, JPG images are decoded at the smallest scale of 1/2, 1/4 or 1/8
+     * that still covers it, which libjpeg does in the inverse DCT at a fraction of the full cost.
+     *
+     * @param filePath The path to the image file.
+     * @param image Receives the decoded image. Its pixel buffer is reused if it is large enough.
+     * @param targetWidth The width the image is displayed at, or 0 for the full width.
+     * @param targetHeight The height the image is displayed at, or 0 for the full height.
+     * @return True if the image was decoded.
+     */
+    static bool decodeImage(const std::string &filePath, ImageData &image, unsigned int targetWidth = 0,
+                            unsigned int targetHeight = 0);
+
+    /**
+     * Creates an OpenGL texture from a decoded image.
+     *
+     * @param image The decoded image.
+     * @return The OpenGL texture ID of the created texture, or 0 if the image is empty.
+     */
+    static GLuint createTexture(const ImageData &image);
+
+    /**
+     * Creates the mipmap levels of a texture from the image it was created from, and selects
+     * trilinear filtering. OpenGL ES 2.0 only mipmaps non-power-of-two textures with
+     * `GL_OES_texture_npot`; other textures are left unchanged.
+     *
+     * @param texture The texture.
+     * @param image The image of the texture's base level.
+     * @param mode How the levels are created.
+     * @return True if mipmap levels were created.
+     */
+    static bool generateMipmaps(GLuint texture, const ImageData &image, MipmapGeneration mode);
+
+    /**
+     * Checks whether textures of a size can have mipmap levels.
+     *
+     * @param width The width of the texture.
+     * @param height The height of the texture.
+     * @return True if the size is a power of two or the driver supports non-power-of-two mipmaps.
+     */
+    static bool supportsMipmaps(unsigned int width, unsigned int height);
+
+    /**
+     * Halves an image with a rounding 2x2 box filter. RGBA images are filtered four channels at a
+     * time in 64-bit words. A trailing odd row or column is dropped.
+     *
+     * @param source The image to reduce.
+     * @param level Receives the reduced image. Its pixel buffer is reused if it is large enough.
+     */
+    static void downsample(const ImageData &source, ImageData &level);
+
+    /**
+     * Computes the memory of an uncompressed texture.
+     *
+     * @param width The width of the base level.
+     * @param height The height of the base level.
+     * @param bytesPerPixel The size of a pixel.
+     * @param mipmapped Whether the texture has a full mipmap chain.
+     * @return The size in bytes.
+     */
+    static size_t getTextureSizeBytes(unsigned int width, unsigned int height, size_t bytesPerPixel, bool mipmapped);
+
+    /**
+     * Creates an OpenGL texture from a KTX or KTX2 file holding a compressed format, uploading all
+     * mipmap levels it contains. Supercompressed KTX2 files (Basis Universal, zstd) are not supported.
+     *
+     * @param filePath The path to the texture file.
+     * @param info Receives the format, size and levels of the texture, if not null.
+     * @return The OpenGL texture ID of the created texture, or 0 if loading failed or the driver does not
+     *         support the format.
+     */
+    static GLuint loadCompressedTexture(const std::string &filePath, CompressedTextureInfo *info = nullptr);
+
+    /**
+     * Checks whether the driver advertises a compressed texture format, in
+     * `GL_COMPRESSED_TEXTURE_FORMATS` or through the extension that defines it.
+     *
+     * @param internalFormat The compressed internal format.
+     * @return True if textures of the format can be created.
+     */
+    static bool isCompressedFormatSupported(GLenum internalFormat);
+
     /**
      * Checks if the provided file path points to a PNG image.
      *
@@ -53,22 +193,140 @@ public:
      */
     static bool isJPG(const std::string &filePath);
 
+    /**
+     * Checks if the provided file path points to a KTX or KTX2 texture.
+     *
+     * @param filePath The path to the texture file.
+     * @return True if the file is a KTX or KTX2 texture, false otherwise.
+     */
+    static bool isKTX(const std::string &filePath);
+
+    /**
+     * Checks the extension of a file name, ignoring case, without opening the file.
+     *
+     * @param filePath The path to the file.
+     * @param extensions The accepted extensions in lower case, including the dot.
+     * @return True if the file name ends in one of the extensions.
+     */
+    static bool hasExtension(const std::string &filePath, std::initializer_list<const char *> extensions);
+
+    /**
+     * Gets the decoder counters accumulated since the start of the run.
+     *
+     * @return A snapshot of the counters.
+     */
+    static ImageDecodeStatistics getDecodeStatistics();
+
 private:
+    enum class ImageFormat { UNKNOWN, PNG, JPG, KTX, KTX2 };
+
+    /**
+     * The compressed mipmap levels of a texture container, pointing into the mapped file.
+     */
+    struct CompressedLevels {
+        GLenum internalFormat = 0;
+        unsigned int width = 0;
+        unsigned int height = 0;
+        std::vector<std::pair<const unsigned char *, size_t>> levels; ///< Data and size, largest first.
+    };
+
     /**
-     * Loads a PNG image from a file and creates an OpenGL texture.
+     * Detects the image format from the file signature.
      *
-     * @param filePath The path to the PNG image file.
-     * @return The OpenGL texture ID of the loaded texture, or 0 if loading failed.
+     * @param data The start of the file.
+     * @param size The number of bytes available.
+     * @return The format.
      */
-    static GLuint loadPNGTexture(const std::string &filePath);
+    static ImageFormat detectFormat(const unsigned char *data, size_t size);
 
     /**
-     * Loads a JPG image from a file and creates an OpenGL texture.
+     * Maps a file and decodes it.
      *
-     * @param filePath The path to the JPG image file.
-     * @return The OpenGL texture ID of the loaded texture, or 0 if loading failed.
+     * @param filePath The path to the image file.
+     * @param image Receives the decoded image.
+     * @param format Receives the detected format.
+     * @return True if the image was decoded.
+     */
+    static bool decodeFile(const std::string &filePath, ImageData &image, ImageFormat &format,
+                           unsigned int targetWidth = 0, unsigned int targetHeight = 0);
+
+    /**
+     * Decodes a mapped PNG or JPG image.
+     *
+     * @param data The encoded image.
+     * @param size The size of the encoded image.
+     * @param format The detected format.
+     * @param image Receives the decoded image.
+     * @param targetWidth The display width, or 0.
+     * @param targetHeight The display height, or 0.
+     * @return True if the image was decoded.
+     */
+    static bool decodeData(const unsigned char *data, size_t size, ImageFormat format, ImageData &image,
+                           unsigned int targetWidth = 0, unsigned int targetHeight = 0);
+
+    /**
+     * Creates a texture from a mapped KTX or KTX2 file.
+     *
+     * @param data The file contents.
+     * @param size The file size.
+     * @param format The detected container format.
+     * @param filePath The path, for messages.
+     * @param info Receives the texture description, if not null.
+     * @return The OpenGL texture ID, or 0 on failure.
+     */
+    static GLuint createCompressedTexture(const unsigned char *data, size_t size, ImageFormat format,
+                                         const std::string &filePath, CompressedTextureInfo *info);
+
+    /**
+     * Locates the mipmap levels of a KTX file. Files of either byte order are accepted.
+     *
+     * @param data The file contents.
+     * @param size The file size.
+     * @param texture Receives the format, size and levels.
+     * @return True if the file holds a single compressed 2D texture.
+     */
+    static bool parseKTX(const unsigned char *data, size_t size, CompressedLevels &texture);
+
+    /**
+     * Locates the mipmap levels of a KTX2 file and maps its Vulkan format to the GL format.
+     *
+     * @param data The file contents.
+     * @param size The file size.
+     * @param texture Receives the format, size and levels.
+     * @return True if the file holds a single compressed 2D texture without supercompression.
+     */
+    static bool parseKTX2(const unsigned char *data, size_t size, CompressedLevels &texture);
+
+    /**
+     * Decodes a PNG image from memory to RGBA.
+     *
+     * @param data The encoded image.
+     * @param size The size of the encoded image.
+     * @param image Receives the decoded image.
+     * @return True if the image was decoded.
+     */
+    static bool decodePNG(const unsigned char *data, size_t size, ImageData &image);
+
+    /**
+     * Decodes a JPG image from memory to RGBA, or RGB without libjpeg-turbo.
+     *
+     * @param data The encoded image.
+     * @param size The size of the encoded image.
+     * @param image Receives the decoded image.
+     * @param targetWidth The display width, or 0.
+     * @param targetHeight The display height, or 0.
+     * @return True if the image was decoded.
+     */
+    static bool decodeJPG(const unsigned char *data, size_t size, ImageData &image, unsigned int targetWidth,
+                          unsigned int targetHeight);
+
+    /**
+     * Sizes the pixel buffer of an image, counting an allocation if it has to grow.
+     *
+     * @param image The image.
+     * @param size The required size in bytes.
      */
-    static GLuint loadJPGTexture(const std::string &filePath);
+    static void resizePixels(ImageData &image, size_t size);
 };
 
 #endif // VALYRIA_IMAGELOADER_H
@@ -20,6 +20,7 @@
 #ifndef VALYRIA_LOGGER_H
 #define VALYRIA_LOGGER_H
 
+#include <cstdint>
 #include <iostream>
 #include <string>
 
@@ -34,6 +35,17 @@ enum class LogLevel {
     ERROR   ///< Error messages indicating serious issues.
 };
 
+/**
+ * The lowest level compiled into the binary, as the numeric value of a LogLevel. Messages below it
+ * are removed at compile time by the `LOG_*` macros. Set through the VALYRIA_MIN_LOG_LEVEL CMake cache
+ * variable.
+ */
+#ifndef VALYRIA_MIN_LOG_LEVEL
+#define VALYRIA_MIN_LOG_LEVEL 0
+#endif
+
+constexpr LogLevel MIN_LOG_LEVEL = static_cast<LogLevel>(VALYRIA_MIN_LOG_LEVEL);
+
 /**
  * Contains configuration settings for the logger.
  */
@@ -41,6 +53,32 @@ namespace LoggerConfig {
     extern LogLevel currentLevel;
 
     void setLogLevel(LogLevel level);
+
+    /**
+     * Writes log messages to a file, appending to it, instead of the console.
+     *
+     * @param path The path of the log file.
+     * @return False if the file could not be opened.
+     */
+    bool setLogFile(const std::string &path);
+
+    /**
+     * Starts a background writer thread. Messages are then queued without locks or I/O on the logging
+     * thread; when the queue is full they are dropped and counted.
+     */
+    void startAsyncLogging();
+
+    /**
+     * Writes all queued messages and stops the background writer. Called automatically at exit.
+     */
+    void stopAsyncLogging();
+
+    /**
+     * Gets the number of messages dropped because the queue was full.
+     *
+     * @return The number of dropped messages since the start of the run.
+     */
+    uint64_t getDroppedMessages();
 } // namespace LoggerConfig
 
 LogLevel stringToLogLevel(const std::string &levelStr);
@@ -53,4 +91,29 @@ inline void logInfo(const std::string &message) { logMessage(LogLevel::INFO, mes
 inline void logWarn(const std::string &message) { logMessage(LogLevel::WARN, message); }
 inline void logError(const std::string &message) { logMessage(LogLevel::ERROR, message); }
 
+/**
+ * Checks whether messages of a level are written, before any message is built.
+ *
+ * @param level The level of the message.
+ * @return True if the level is compiled in and enabled at runtime.
+ */
+inline bool isLogEnabled(LogLevel level) { return level >= MIN_LOG_LEVEL && level >= LoggerConfig::currentLevel; }
+
+/**
+ * Logs a message that is only evaluated if its level is enabled. Use these on per-frame and
+ * per-sample paths, where the `logX` functions would build and discard a string on every call.
+ */
+#define VALYRIA_LOG(level, message)                                                                                    \
+    do {                                                                                                               \
+        if (isLogEnabled(level)) {                                                                                     \
+            logMessage(level, message);                                                                                \
+        }                                                                                                              \
+    } while (0)
+
+#define LOG_TRACE(message) VALYRIA_LOG(LogLevel::TRACE, message)
+#define LOG_DEBUG(message) VALYRIA_LOG(LogLevel::DEBUG, message)
+#define LOG_INFO(message) VALYRIA_LOG(LogLevel::INFO, message)
+#define LOG_WARN(message) VALYRIA_LOG(LogLevel::WARN, message)
+#define LOG_ERROR(message) VALYRIA_LOG(LogLevel::ERROR, message)
+
 #endif // VALYRIA_LOGGER_H
@@ -20,7 +20,13 @@
 #ifndef VALYRIA_METRICSCOLLECTOR_H
 #define VALYRIA_METRICSCOLLECTOR_H
 
+#include "FlightRecorder.h"
+
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -28,26 +34,58 @@
 #include <thread>
 #include <vector>
 
+class BinaryReportWriter;
 class cJSON;
 
 /**
  * Enum representing types of metrics that can be collected.
  */
 enum class MetricType {
-    GAUGE,  ///< Value sampled at a single point in time.
-    COUNTER ///< Cumulative value that increments over time.
+    GAUGE,       ///< Value sampled at a single point in time.
+    COUNTER,     ///< Cumulative value that increments over time.
+    DISTRIBUTION ///< Independent measurements, such as latencies, reported with percentiles.
 };
 
 /**
  * Struct representing a single metric entry that holds multiple values for tracking over time.
  */
 struct MetricData {
-    MetricType type;            ///< Type of metric (GAUGE or COUNTER).
+    MetricType type;            ///< Type of metric (GAUGE, COUNTER or DISTRIBUTION).
     std::vector<double> values; ///< Collection of recorded values.
 
     void addValue(double value) { values.push_back(value); }
 };
 
+/**
+ * Per-frame durations of the phases of the render loop, in milliseconds.
+ */
+struct FramePhaseSamples {
+    std::vector<double> update;  ///< `RenderTask::update`.
+    std::vector<double> render;  ///< `RenderTask::render`, i.e. command submission.
+    std::vector<double> display; ///< `updateDisplay`, i.e. the buffer swap and the event loop.
+    std::vector<double> sleep;   ///< Frame pacing sleep.
+
+    void clear() {
+        update.clear();
+        render.clear();
+        display.clear();
+        sleep.clear();
+    }
+};
+
+/**
+ * The samples of a finished task, swapped out of the collector so that the report can be
+ * finalized in the background while the next task runs.
+ */
+struct TaskSamples {
+    std::string taskName;                        ///< Name of the finished task.
+    std::map<std::string, MetricData> metrics;   ///< Sampled metrics of the task.
+    std::vector<uint64_t> frameTimestamps;       ///< Per-frame timestamps, if recorded.
+    FramePhaseSamples framePhases;               ///< Per-frame durations of the loop phases.
+    std::vector<JankSpike> jankSpikes;           ///< Snapshots of frames over the jank threshold.
+    bool scored = true;                          ///< Whether the task's FPS contributes to the score.
+};
+
 /**
  * The `MetricsCollector` class collects, processes, and manages system and performance metrics
  * during a benchmarking session.
@@ -79,11 +117,47 @@ public:
      */
     void clearMetrics();
 
+    /**
+     * Hands the samples of a finished task to the background finalizer and returns immediately.
+     * The collector starts the next task with empty sample buffers.
+     *
+     * @param taskName The name of the finished task.
+     * @param scored Whether the task's FPS contributes to the overall score.
+     */
+    void finishTask(const std::string &taskName, bool scored = true);
+
     /**
      * Increments the internal frame counter for FPS calculations, typically called on each frame render.
+     * When the binary report is enabled, the frame's presentation timestamp is recorded as well.
      */
     void incrementFrameCount();
 
+    /**
+     * Records the durations of the loop phases of one frame for the frame budget breakdown.
+     * Called from the render loop only, like `incrementFrameCount`.
+     *
+     * @param updateMs Time spent in the task's update.
+     * @param renderMs Time spent submitting the task's render commands.
+     * @param displayMs Time spent in `updateDisplay`.
+     * @param sleepMs Time spent in the frame pacing sleep.
+     */
+    void recordFramePhases(double updateMs, double renderMs, double displayMs, double sleepMs);
+
+    /**
+     * Adds a jank spike snapshot to the current task, together with the latest sample of each
+     * metric collected in the background.
+     *
+     * @param spike The snapshot from the flight recorder.
+     */
+    void recordJankSpike(JankSpike &&spike);
+
+    /**
+     * Sets the frame time above which frames count as jank spikes, for the report.
+     *
+     * @param thresholdMs The threshold in milliseconds; 0 if spike detection is disabled.
+     */
+    void setJankThreshold(double thresholdMs) { jankThresholdMs = thresholdMs; }
+
     /**
      * Gathers static system information, such as OS version or build metadata, at the start of a benchmark.
      */
@@ -103,9 +177,10 @@ public:
     /**
      * Creates a report for the benchmark run from collected metrics.
      * 
-     * @param tasks The number of RenderTasks.
+     * @param tasks The number of RenderTasks that contribute to the score.
+     * @return False if a significant regression against the configured baselines was detected.
      */
-    void createReport(int tasks);
+    bool createReport(int tasks);
 
 protected:
     /**
@@ -141,17 +216,47 @@ protected:
     std::chrono::time_point<std::chrono::steady_clock> startBenchTime; ///< Start time of the benchmark.
     std::chrono::time_point<std::chrono::steady_clock> endBenchTime;   ///< End time of the benchmark.
     size_t frameCount; ///< Total number of frames rendered during the benchmark period.
+    std::vector<uint64_t> frameTimestamps; ///< Per-frame timestamps in microseconds since the start of the task.
+    bool recordFrameTimestamps;            ///< Whether per-frame timestamps are recorded.
+    FramePhaseSamples framePhases;         ///< Per-frame durations of the loop phases.
+    double swapBlockThresholdMs;           ///< A swap taking longer than this counts as blocked.
+    std::vector<JankSpike> jankSpikes;     ///< Jank spike snapshots of the current task.
+    double jankThresholdMs;                ///< Frame time above which frames count as jank spikes.
 
 private:
     friend class BenchmarkEngine;
     std::map<std::string, std::string> staticInfo;      ///< Stores static system metadata.
     std::map<std::string, std::string> toolInfo;        ///< Stores static system metadata.
     std::map<std::string, MetricData> collectedMetrics; ///< Maps each metric name to its data.
+    std::map<std::string, double> latestSamples;        ///< Latest value of each background-collected metric.
     std::atomic<bool> collecting;                       ///< Status of the collection process.
     std::thread collectionThread;                       ///< Background thread for metrics collection.
     mutable std::mutex metricsMutex;                    ///< Synchronizes access to metric data.
     cJSON *runtimeReport;                               ///< JSON object representing runtime metrics.
+    cJSON *frameBudgetReport;                           ///< Per-task breakdown of the loop phases.
+    cJSON *jankSpikeReport;                             ///< Per-task jank spike snapshots.
     double combinedScore;                               ///< Accumulated score across all benchmark tasks.
+    std::unique_ptr<BinaryReportWriter> binaryReport;   ///< Compact per-frame report writer, if enabled.
+    bool baselineRegression;                            ///< Whether the baseline comparison found a regression.
+    bool binaryReportFailed;                            ///< Set when the binary report could not be created.
+
+    std::thread finalizerThread;                        ///< Background thread finalizing task reports.
+    std::mutex finalizerMutex;                          ///< Protects the finalizer queue and state.
+    std::condition_variable finalizerCondition;         ///< Signals queued work and finished work.
+    std::deque<TaskSamples> pendingTasks;               ///< Finished tasks waiting to be finalized.
+    bool finalizerBusy;                                 ///< Whether a task is being finalized.
+    bool stopFinalizer;                                 ///< Requests the finalizer thread to exit.
+
+    /**
+     * Finalizer thread loop; builds the per-task reports of queued tasks.
+     */
+    void runFinalizer();
+
+    /**
+     * Blocks until all queued tasks have been finalized.
+     */
+    void waitForFinalizer();
+
     /**
      * Generates a JSON report from collected metrics and writes it to the specified file.
      *
@@ -159,14 +264,55 @@ private:
      * @param tasks The number of tasks.
      * @return A pointer to the created JSON structure.
      */
-    cJSON *createJSONReport(const std::string &filePath, int tasks) const;
+    cJSON *createJSONReport(const std::string &filePath, int tasks);
+
+    /**
+     * Compares the results against the baseline reports given by the `baseline` option and adds
+     * the comparison to the report.
+     *
+     * @param reportJson The JSON report being created.
+     * @return False if any task regressed significantly.
+     */
+    bool compareWithBaselines(cJSON *reportJson) const;
 
     /**
      * Compiles collected runtime metrics for a specific benchmark task into a report structure.
+     * Runs on the finalizer thread.
+     *
+     * @param samples The samples of the finished task.
+     */
+    void createBenchmarkReport(const TaskSamples &samples);
+
+    /**
+     * Adds the `Frame work (ms)` distribution of a finished task: the update, render submit and swap time of each
+     * frame, without the frame pacing sleep. Runs on the finalizer thread.
+     *
+     * @param samples The samples of the finished task.
+     */
+    void addFrameWorkMetric(TaskSamples &samples);
+
+    /**
+     * Adds the mean and p99 of each loop phase and the fraction of blocked swaps of a finished
+     * task to the frame budget report. Runs on the finalizer thread.
+     *
+     * @param samples The samples of the finished task.
+     */
+    void createFrameBudgetReport(const TaskSamples &samples);
+
+    /**
+     * Adds the jank spike snapshots of a finished task to the jank spike report. Runs on the
+     * finalizer thread.
+     *
+     * @param samples The samples of the finished task.
+     */
+    void createJankSpikeReport(const TaskSamples &samples);
+
+    /**
+     * Appends the per-frame and sampled data of a finished task to the binary report.
      *
-     * @param taskName The name of the benchmark task for which the report is generated.
+     * @param samples The samples of the finished task.
      */
-    void createBenchmarkReport(const std::string &taskName);
+    void writeBinaryTask(const TaskSamples &samples);
 };
 
 #endif // VALYRIA_METRICSCOLLECTOR_H
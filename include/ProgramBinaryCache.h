@@ -0,0 +1,104 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VALYRIA_PROGRAMBINARYCACHE_H
+#define VALYRIA_PROGRAMBINARYCACHE_H
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <cstdint>
+#include <string>
+
+/**
+ * An on-disk cache of linked program binaries, based on GL_OES_get_program_binary.
+ *
+ * Entries are stored as one file per program, named after the hash of the program sources.
+ * The cache directory also holds the identity of the driver (GL_RENDERER and GL_VERSION) that
+ * produced the binaries; all entries are discarded when the driver changes.
+ */
+class ProgramBinaryCache {
+public:
+    ProgramBinaryCache();
+
+    /**
+     * Enables the cache if the extension is available. Must be called with a current context.
+     *
+     * @param cacheDir The cache directory. An empty path or `none` disables the cache.
+     * @return True if the cache is enabled.
+     */
+    bool initialize(const std::string &cacheDir);
+
+    /**
+     * Checks whether program binaries can be loaded and stored.
+     *
+     * @return True if the cache is enabled.
+     */
+    bool isEnabled() const { return enabled; }
+
+    /**
+     * Loads a cached binary into a program object. A binary rejected by the driver is removed from the cache.
+     *
+     * @param programID The program object, without attached shaders.
+     * @param key The hash of the program sources.
+     * @return True if the program was loaded and is linked.
+     */
+    bool load(GLuint programID, uint64_t key);
+
+    /**
+     * Stores the binary of a linked program.
+     *
+     * @param programID The linked program object.
+     * @param key The hash of the program sources.
+     * @return True if the binary was written.
+     */
+    bool store(GLuint programID, uint64_t key);
+
+    /**
+     * Computes a 64-bit FNV-1a hash, which is stable across runs and builds.
+     *
+     * @param data The data to hash.
+     * @param seed The hash to continue from, for hashing several strings in sequence.
+     * @return The hash value.
+     */
+    static uint64_t hash(const std::string &data, uint64_t seed = 0xcbf29ce484222325ULL);
+
+private:
+    bool enabled;
+    std::string directory;
+    PFNGLGETPROGRAMBINARYOESPROC getProgramBinary;
+    PFNGLPROGRAMBINARYOESPROC programBinary;
+
+    /**
+     * Returns the path of the cache entry for a program.
+     *
+     * @param key The hash of the program sources.
+     * @return The entry file path.
+     */
+    std::string entryPath(uint64_t key) const;
+
+    /**
+     * Discards all entries if they were produced by a different driver, and records the current driver.
+     *
+     * @param driverIdentity The GL_RENDERER and GL_VERSION strings of the current driver.
+     * @return True if the cache directory is usable.
+     */
+    bool validateDriver(const std::string &driverIdentity);
+};
+
+#endif // VALYRIA_PROGRAMBINARYCACHE_H
@@ -0,0 +1,102 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VALYRIA_REGRESSIONANALYZER_H
+#define VALYRIA_REGRESSIONANALYZER_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <cjson/cJSON.h>
+
+/**
+ * The outcome of comparing one task against the baseline runs.
+ */
+struct TaskComparison {
+    std::string taskName;         ///< Name of the compared task.
+    size_t baselineSamples = 0;   ///< Number of pooled baseline samples.
+    size_t currentSamples = 0;    ///< Number of samples in the current run.
+    double baselineMedian = 0.0;  ///< Median frame work of the baseline runs in milliseconds.
+    double currentMedian = 0.0;   ///< Median frame work of the current run in milliseconds.
+    double changePercent = 0.0;   ///< Relative change of the median frame work.
+    double ciLowPercent = 0.0;    ///< Lower bound of the bootstrap confidence interval of the change.
+    double ciHighPercent = 0.0;   ///< Upper bound of the bootstrap confidence interval of the change.
+    double pValue = 1.0;          ///< Two-sided Mann-Whitney U test p-value.
+    bool regression = false;      ///< Significantly slower by more than the threshold.
+    bool improvement = false;     ///< Significantly faster by more than the threshold.
+};
+
+/**
+ * Compares the frame work distribution of each task against one or more baseline JSON reports.
+ *
+ * A task is flagged as a regression when its median frame work grew by more than the threshold,
+ * the Mann-Whitney U test rejects equal distributions at the configured significance level, and
+ * the bootstrap confidence interval of the median change lies entirely above zero.
+ */
+class RegressionAnalyzer {
+public:
+    /**
+     * Constructs an analyzer.
+     *
+     * @param thresholdPercent The minimum relative change of the median frame work that counts.
+     * @param significanceLevel The significance level of the statistical test, e.g. 0.05.
+     */
+    RegressionAnalyzer(double thresholdPercent, double significanceLevel);
+
+    /**
+     * Loads a baseline report and pools its frame work samples per task.
+     *
+     * @param filePath The path to a `valyria_report.json` file.
+     * @return True if the report was loaded.
+     */
+    bool loadBaseline(const std::string &filePath);
+
+    /**
+     * Compares the current results against the loaded baselines. Tasks without baseline data are skipped.
+     *
+     * @param benchmarkResults The "Benchmark Results" object of the current report.
+     * @return One comparison per task present in both.
+     */
+    std::vector<TaskComparison> compare(const cJSON *benchmarkResults) const;
+
+    /**
+     * Creates the "Baseline Comparison" section of the JSON report.
+     *
+     * @param comparisons The comparison results.
+     * @return A new cJSON object owned by the caller.
+     */
+    cJSON *createJSON(const std::vector<TaskComparison> &comparisons) const;
+
+    /**
+     * The per-frame work time. The sampled `Frame time (ms)` is derived from the frame rate, which is capped at the
+     * target frame rate, so it does not change until a task drops frames.
+     */
+    static constexpr const char *COMPARED_METRIC = "Frame work (ms)";
+
+private:
+    double thresholdPercent;
+    double significanceLevel;
+    std::vector<std::string> baselineFiles;
+    std::map<std::string, std::vector<double>> baselineSamples; ///< Pooled samples per task.
+
+    static std::vector<double> extractSamples(const cJSON *task);
+};
+
+#endif // VALYRIA_REGRESSIONANALYZER_H
@@ -20,8 +20,12 @@
 #ifndef VALYRIA_RENDERTASK_H
 #define VALYRIA_RENDERTASK_H
 
+#include "ShaderProgram.h"
+
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 /**
  * A base class for defining and managing individual rendering tasks within a benchmark.
@@ -81,8 +85,46 @@ public:
      */
     virtual void update(float elapsedTime, float deltaTime) = 0;
 
+    /**
+     * Indicates whether the task's frame rate contributes to the overall score. Tasks that
+     * measure latencies rather than sustained rendering opt out.
+     *
+     * @return True if the task is scored.
+     */
+    virtual bool isScored() const { return true; }
+
+    /**
+     * Lists the shader programs the task creates in `setup`, so they can be compiled ahead of time.
+     *
+     * @return The programs of the task.
+     */
+    virtual std::vector<ShaderProgramSource> getShaderPrograms() const { return {}; }
+
+    /**
+     * Retrieves the measurements recorded by the task itself during the last run.
+     *
+     * @return The measured values by metric name.
+     */
+    const std::map<std::string, std::vector<double>> &getTaskMetrics() const { return taskMetrics; }
+
+    /**
+     * Discards the measurements of the previous run.
+     */
+    void clearTaskMetrics() { taskMetrics.clear(); }
+
 protected:
+    /**
+     * Records a measurement, which is added to the task's report as a distribution with percentiles.
+     *
+     * @param metricName The name of the metric.
+     * @param value The measured value.
+     */
+    void recordTaskMetric(const std::string &metricName, double value) { taskMetrics[metricName].push_back(value); }
+
     std::string name; ///< Name of the render task.
+
+private:
+    std::map<std::string, std::vector<double>> taskMetrics; ///< Measurements recorded by the task.
 };
 
 #endif // VALYRIA_RENDERTASK_H
@@ -22,6 +22,7 @@
 
 #include <GLES2/gl2.h>
 #include <string>
+#include <vector>
 
 /**
  * A class that represents an individual OpenGL ES shader (vertex or fragment).
@@ -48,6 +49,51 @@ public:
      */
     bool compile();
 
+    /**
+     * Compiles the given shader source code, which was already loaded from the shader file.
+     *
+     * @param source The shader source code.
+     * @param wait Whether to wait for the compile status. Without waiting, the driver may compile
+     *             in the background and the status must be checked later with `checkCompileStatus`.
+     * @return True if the shader compiled successfully (or was submitted); false otherwise.
+     */
+    bool compile(const std::string &source, bool wait = true);
+
+    /**
+     * Checks the compile status of a shader submitted without waiting, releasing it on failure.
+     *
+     * @return True if the shader compiled successfully; false otherwise.
+     */
+    bool checkCompileStatus();
+
+    /**
+     * Loads the shader source code from a file.
+     *
+     * With the default `shader_dir` of "embedded", the shaders compiled into the binary are used, and
+     * files that were not embedded are read from `asset_dir`. Otherwise files are read from `shader_dir`.
+     *
+     * @param fileName The file name of the shader source code, relative to the asset base directory.
+     * @return The contents of the shader file as a string, or an empty string if the file failed to load.
+     */
+    static std::string loadShaderFromFile(const std::string &fileName);
+
+    /**
+     * Lists the shader files that `loadShaderFromFile` can load.
+     *
+     * @param extension The file extension, e.g. ".frag".
+     * @return The sorted file names.
+     */
+    static std::vector<std::string> listShaderFiles(const std::string &extension);
+
+    /**
+     * Inserts a `#define` into shader source code, after the `#version` directive if there is one.
+     *
+     * @param source The shader source code.
+     * @param define The macro definition without the `#define` keyword, e.g. "VALYRIA_NONCE 42".
+     * @return The modified source code.
+     */
+    static std::string injectDefine(const std::string &source, const std::string &define);
+
     /**
      * Gets the OpenGL shader ID.
      *
@@ -55,6 +101,13 @@ public:
      */
     GLuint getShaderID() const;
 
+    /**
+     * Gets the shader type.
+     *
+     * @return GL_VERTEX_SHADER or GL_FRAGMENT_SHADER.
+     */
+    GLenum getType() const { return type; }
+
     /**
      * Releases the OpenGL resources associated with the shader.
      */
@@ -69,14 +122,6 @@ private:
      * Logs any errors encountered during shader compilation.
      */
     void logShaderError() const;
-
-    /**
-     * Loads the shader source code from a file.
-     *
-     * @param fileName The file name of the shader source code.
-     * @return The contents of the shader file as a string, or an empty string if the file failed to load.
-     */
-    std::string loadShaderFromFile(const std::string &fileName);
 };
 
 #endif // VALYRIA_SHADER_H
@@ -20,11 +20,41 @@
 #ifndef VALYRIA_SHADERMANAGER_H
 #define VALYRIA_SHADERMANAGER_H
 
+#include "ProgramBinaryCache.h"
 #include "Shader.h"
 #include "ShaderProgram.h"
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+/**
+ * Counters of the compiled-shader cache, accumulated since the cache was last cleared.
+ */
+struct ShaderCacheStatistics {
+    unsigned int compiles = 0;        ///< Shaders compiled by the driver.
+    unsigned int compilesAvoided = 0; ///< Shader requests served from the cache.
+    double compileTimeMs = 0.0;       ///< Total time spent compiling shaders, without parallel compiles.
+    double timeSavedMs = 0.0;         ///< Compile time of the timed shaders served from the cache.
+    unsigned int programsLinked = 0;        ///< Programs linked from source.
+    unsigned int programBinariesLoaded = 0; ///< Programs loaded from the program binary cache.
+    unsigned int programBinariesStored = 0; ///< Programs written to the program binary cache.
+};
+
+/**
+ * An opaque reference to a shader program stored in the ShaderManager.
+ *
+ * A handle stays cheap to use on the per-frame path: it indexes a slot directly, and the generation
+ * detects handles whose program has been removed, even if the slot was reused since.
+ */
+struct ShaderProgramHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0; ///< 0 for a handle that never referred to a program.
+
+    bool isValid() const { return generation != 0; }
+};
 
 /**
  * A singleton class responsible for managing multiple shader programs in a centralized manner.
@@ -48,20 +78,67 @@ public:
      */
     ShaderManager &operator=(const ShaderManager &) = delete;
 
+    /**
+     * Detects the optional shader extensions and enables the on-disk program binary cache if the
+     * driver supports GL_OES_get_program_binary. Must be called with a current context.
+     *
+     * @param programBinaryCacheDir The program binary cache directory. An empty path disables the cache.
+     */
+    void initialize(const std::string &programBinaryCacheDir);
+
+    /**
+     * Checks whether the driver compiles shaders in the background (GL_KHR_parallel_shader_compile).
+     *
+     * @return True if parallel compilation is supported.
+     */
+    bool isParallelCompileSupported() const { return parallelCompileSupported; }
+
+    /**
+     * Submits the programs for parallel compilation without waiting for the results. A later
+     * `createShaderProgram` call with the same name and files completes the program, so other
+     * setup work can overlap with compilation. Does nothing without GL_KHR_parallel_shader_compile.
+     *
+     * @param programs The programs to build.
+     */
+    void preloadShaderPrograms(const std::vector<ShaderProgramSource> &programs);
+
+    /**
+     * Checks without blocking whether a program is ready to be used.
+     *
+     * @param programName The name of the program.
+     * @return True if the program has been created, or its preload has completed.
+     */
+    bool isShaderProgramReady(const std::string &programName) const;
+
+    /**
+     * Builds the programs twice, bypassing all caches: once serially, waiting for every compile and
+     * link, and once in parallel, polling GL_COMPLETION_STATUS_KHR. The programs are deleted afterwards.
+     *
+     * @param programs The programs to build.
+     * @param serialMs Receives the wall time of the serial build.
+     * @param parallelMs Receives the wall time of the parallel build.
+     * @return False if parallel compilation is not supported or there are no programs.
+     */
+    bool measureParallelCompile(const std::vector<ShaderProgramSource> &programs, double &serialMs,
+                                double &parallelMs);
+
     /**
      * Creates a new shader program and stores it by the specified name.
      *
-     * This method compiles the provided vertex and fragment shader sources,
-     * links them into a shader program, and stores the program using the
-     * provided name. If a program with the same name already exists, creation is skipped.
+     * This method completes a preloaded program, or loads the program from the program binary cache
+     * when possible; otherwise it preprocesses and compiles the provided vertex and fragment shader
+     * files, links them into a shader program, and stores the program using the provided name. If a
+     * program with the same name already exists, creation is skipped.
      *
      * @param programName The name used to store and retrieve the shader program.
-     * @param vertexSource The source code of the vertex shader.
-     * @param fragmentSource The source code of the fragment shader.
-     * @return True if the shader program was created and stored successfully, false otherwise.
+     * @param vertexSource The file name of the vertex shader.
+     * @param fragmentSource The file name of the fragment shader.
+     * @param defines Macros injected into both shaders to build a specialized permutation.
+     * @return A handle to the new shader program, or an invalid handle if creation failed or was skipped.
      */
-    bool createShaderProgram(const std::string &programName, const std::string &vertexSource,
-                             const std::string &fragmentSource);
+    ShaderProgramHandle createShaderProgram(const std::string &programName, const std::string &vertexSource,
+                                            const std::string &fragmentSource,
+                                            const std::vector<std::string> &defines = {});
 
     /**
      * Removes a shader program by its name.
@@ -79,13 +156,52 @@ public:
      */
     std::shared_ptr<ShaderProgram> getShaderProgram(const std::string &programName) const;
 
+    /**
+     * Retrieves a shader program by its handle.
+     *
+     * @param handle The handle returned by `createShaderProgram`.
+     * @return A shared pointer to the ShaderProgram, or nullptr if the handle is stale or invalid.
+     */
+    std::shared_ptr<ShaderProgram> getShaderProgram(ShaderProgramHandle handle) const;
+
     /**
      * Uses the specified shader program for rendering.
      *
+     * Looks the program up by name and logs at trace level; per-frame code should use `use(handle)`.
+     *
      * @param programName The name of the shader program to activate.
      */
     void useShaderProgram(const std::string &programName);
 
+    /**
+     * Uses the shader program referenced by the handle for rendering. Does not allocate.
+     *
+     * @param handle The handle returned by `createShaderProgram`.
+     * @return False if the handle is stale or invalid.
+     */
+    bool use(ShaderProgramHandle handle) {
+        if (handle.index < programSlots.size() && programSlots[handle.index].generation == handle.generation &&
+            handle.isValid()) {
+            programSlots[handle.index].program->use();
+            return true;
+        }
+        logStaleHandle(handle);
+        return false;
+    }
+
+    /**
+     * Returns the compiled-shader cache counters.
+     *
+     * @return The counters accumulated since the cache was last cleared.
+     */
+    const ShaderCacheStatistics &getCacheStatistics() const { return cacheStatistics; }
+
+    /**
+     * Releases all cached shader objects and resets the counters. Must be called while the
+     * graphics context is still current.
+     */
+    void clearShaderCache();
+
 private:
     /**
      * Private default constructor.
@@ -97,8 +213,142 @@ private:
      */
     ~ShaderManager();
 
-    std::unordered_map<std::string, std::shared_ptr<ShaderProgram>> shaderPrograms; ///< Stores shader programs by name.
-    std::string currentProgram; ///< Tracks the currently active shader program.
+    /**
+     * Identifies a compiled shader by its stage and source code.
+     */
+    struct ShaderCacheKey {
+        GLenum type;
+        std::string source;
+
+        bool operator==(const ShaderCacheKey &other) const { return type == other.type && source == other.source; }
+    };
+
+    struct ShaderCacheKeyHash {
+        size_t operator()(const ShaderCacheKey &key) const {
+            return std::hash<std::string>()(key.source) ^ (static_cast<size_t>(key.type) * 0x9e3779b97f4a7c15ULL);
+        }
+    };
+
+    /**
+     * A program whose build has been started but not completed.
+     */
+    struct PendingProgram {
+        std::string vertexFile;
+        std::string fragmentFile;
+        std::vector<std::string> defines;
+        std::shared_ptr<ShaderProgram> program;
+        std::shared_ptr<Shader> vertexShader;
+        std::shared_ptr<Shader> fragmentShader;
+        uint64_t binaryKey = 0;  ///< Program binary cache key, or 0 if the cache is disabled.
+        bool fromBinary = false; ///< Whether the program was loaded from the program binary cache.
+    };
+
+    /**
+     * A slot of the program table. The generation is bumped whenever the slot is freed.
+     */
+    struct ProgramSlot {
+        std::shared_ptr<ShaderProgram> program;
+        uint32_t generation = 1;
+    };
+
+    /**
+     * A compiled shader together with the time it took to compile. Only compiles that waited for
+     * their status are timed; the submission of a parallel compile says nothing about its cost.
+     */
+    struct CachedShader {
+        std::shared_ptr<Shader> shader;
+        double compileTimeMs;
+        bool timed;
+    };
+
+    /**
+     * Returns a compiled shader for the given source code, compiling it only if an identical shader
+     * is not already cached.
+     *
+     * @param type The shader type (GL_VERTEX_SHADER or GL_FRAGMENT_SHADER).
+     * @param fileName The file name of the shader source code, for logging.
+     * @param source The preprocessed source code.
+     * @param wait Whether to wait for the compile status of a newly compiled shader.
+     * @return The compiled shader, or nullptr if compilation failed.
+     */
+    std::shared_ptr<Shader> getCompiledShader(GLenum type, const std::string &fileName, const std::string &source,
+                                              bool wait = true);
+
+    /**
+     * Preprocesses a shader file, reading it and its includes through the source cache.
+     *
+     * @param fileName The file name of the shader source code.
+     * @param defines Macros injected into the shader.
+     * @param source Receives the preprocessed source code.
+     * @return False if the file or one of its includes could not be loaded.
+     */
+    bool preprocessShader(const std::string &fileName, const std::vector<std::string> &defines, std::string &source);
+
+    /**
+     * Starts building a program: loads it from the program binary cache, or compiles the shaders
+     * and submits the link.
+     *
+     * @param programName The name of the program, for logging.
+     * @param vertexFile The vertex shader file.
+     * @param fragmentFile The fragment shader file.
+     * @param defines Macros injected into both shaders.
+     * @param wait Whether to wait for the compile status of newly compiled shaders.
+     * @param pending Receives the started build.
+     * @return False if the build could not be started.
+     */
+    bool startProgram(const std::string &programName, const std::string &vertexFile, const std::string &fragmentFile,
+                      const std::vector<std::string> &defines, bool wait, PendingProgram &pending);
+
+    /**
+     * Waits for a started build, stores the program in the binary cache and under its name.
+     *
+     * @param programName The name to store the program under.
+     * @param pending The started build.
+     * @return A handle to the program, or an invalid handle if linking failed.
+     */
+    ShaderProgramHandle finishProgram(const std::string &programName, PendingProgram &pending);
+
+    /**
+     * Stores a program in a free slot of the program table and under its name.
+     *
+     * @param programName The name to store the program under.
+     * @param program The program.
+     * @return The handle of the slot.
+     */
+    ShaderProgramHandle storeProgram(const std::string &programName, std::shared_ptr<ShaderProgram> program);
+
+    /**
+     * Logs an attempt to use a stale or invalid handle. Kept out of line so that `use` stays small.
+     *
+     * @param handle The handle.
+     */
+    void logStaleHandle(ShaderProgramHandle handle) const;
+
+    /**
+     * Removes a shader that failed to compile from the cache.
+     *
+     * @param shader The shader to remove.
+     */
+    void evictShader(const std::shared_ptr<Shader> &shader);
+
+    /**
+     * Returns the source code of a shader file, loading it on first use.
+     *
+     * @param fileName The file name of the shader source code.
+     * @return The source code, or nullptr if the file could not be loaded.
+     */
+    const std::string *getShaderSource(const std::string &fileName);
+
+    std::vector<ProgramSlot> programSlots;  ///< Shader programs, indexed by handle.
+    std::vector<uint32_t> freeProgramSlots; ///< Indices of empty slots in `programSlots`.
+    std::unordered_map<std::string, ShaderProgramHandle> shaderPrograms; ///< Handles of shader programs by name.
+    std::unordered_map<std::string, std::string> shaderSources; ///< Unprocessed shader sources by file name.
+    std::unordered_map<ShaderCacheKey, CachedShader, ShaderCacheKeyHash> shaderCache; ///< Compiled shaders.
+    ShaderCacheStatistics cacheStatistics; ///< Cache counters.
+    ProgramBinaryCache programBinaryCache; ///< On-disk cache of linked programs.
+    std::unordered_map<std::string, PendingProgram> pendingPrograms; ///< Preloaded programs by name.
+    bool parallelCompileSupported;         ///< Whether GL_KHR_parallel_shader_compile is available.
+    unsigned int measureNonce;             ///< Counter for the unique defines of measurement builds.
 };
 
 #endif // VALYRIA_SHADERMANAGER_H
@@ -0,0 +1,77 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VALYRIA_SHADERPREPROCESSOR_H
+#define VALYRIA_SHADERPREPROCESSOR_H
+
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * Expands `#include "file"` directives and injects `#define`s into shader source code.
+ *
+ * GLSL ES has no include mechanism, so shared code lives in files under the asset directory that
+ * are pasted in before compilation. Each file is included at most once per shader, which also
+ * breaks include cycles. Injected defines select specialized permutations of a shader, e.g.
+ * "MAX_STEPS 64" turns a uniform loop bound into a constant the compiler can unroll.
+ */
+class ShaderPreprocessor {
+public:
+    /**
+     * Loads a file relative to the asset directory, returning an empty string on failure.
+     */
+    using FileLoader = std::function<std::string(const std::string &)>;
+
+    /**
+     * Constructs a preprocessor that reads files with the given loader.
+     *
+     * @param loader The file loader. Defaults to `Shader::loadShaderFromFile`.
+     */
+    explicit ShaderPreprocessor(FileLoader loader = nullptr);
+
+    /**
+     * Preprocesses a shader file.
+     *
+     * @param fileName The shader file, relative to the asset directory.
+     * @param defines Macro definitions without the `#define` keyword, e.g. "AA_SAMPLES 2".
+     * @param output Receives the preprocessed source code.
+     * @return False if the file or one of its includes could not be loaded.
+     */
+    bool process(const std::string &fileName, const std::vector<std::string> &defines, std::string &output) const;
+
+private:
+    static constexpr int MAX_INCLUDE_DEPTH = 16;
+
+    /**
+     * Appends a file to the output, expanding its includes recursively.
+     *
+     * @param fileName The file to expand.
+     * @param depth The current include depth.
+     * @param included The files expanded so far.
+     * @param output The source code being built.
+     * @return False on a missing file or when the include depth is exceeded.
+     */
+    bool expand(const std::string &fileName, int depth, std::set<std::string> &included, std::string &output) const;
+
+    FileLoader loader;
+};
+
+#endif // VALYRIA_SHADERPREPROCESSOR_H
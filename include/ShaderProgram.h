@@ -22,12 +22,41 @@
 
 #include "Shader.h"
 #include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+/**
+ * Names the shader files of a program, so that programs can be built ahead of the task that uses them.
+ */
+struct ShaderProgramSource {
+    std::string programName;  ///< The name the program is stored under in the ShaderManager.
+    std::string vertexFile;   ///< The vertex shader file, relative to the asset base directory.
+    std::string fragmentFile; ///< The fragment shader file, relative to the asset base directory.
+    std::vector<std::string> defines; ///< Macros injected into both shaders, e.g. "AA_SAMPLES 2".
+};
+
+/**
+ * Counts uniform updates across all shader programs.
+ */
+struct UniformStatistics {
+    uint64_t issued = 0;  ///< Updates passed on to the driver.
+    uint64_t skipped = 0; ///< Updates dropped because the uniform already had the value.
+};
+
 /**
  * A class that represents an OpenGL ES shader program, allowing the attachment of
  * shaders, linking, and usage in rendering.
+ *
+ * After linking, the active uniforms are reflected into a table. The typed `setUniform` setters
+ * remember the last value of each uniform and skip GL calls that would not change it.
  */
 class ShaderProgram {
 public:
@@ -56,6 +85,33 @@ public:
      */
     bool link();
 
+    /**
+     * Starts linking the attached shaders without waiting for the result.
+     */
+    void submitLink();
+
+    /**
+     * Checks whether a link started with `submitLink` has completed, without blocking.
+     * Requires GL_KHR_parallel_shader_compile.
+     *
+     * @return True if the link has completed.
+     */
+    bool isLinkComplete() const;
+
+    /**
+     * Waits for a link started with `submitLink` and checks the result.
+     *
+     * @return True if the program was linked successfully, false otherwise.
+     */
+    bool finishLink();
+
+    /**
+     * Gets the shaders attached to the program whose link has not been finished.
+     *
+     * @return The attached shaders.
+     */
+    const std::vector<std::shared_ptr<Shader>> &getAttachedShaders() const { return attachedShaders; }
+
     /**
      * Uses the shader program for subsequent rendering operations.
      */
@@ -73,9 +129,64 @@ public:
      */
     void release();
 
+    /**
+     * Rebuilds the uniform table from the active uniforms of the linked program. Called after
+     * linking; must also be called after loading a program binary.
+     */
+    void reflectUniforms();
+
+    /**
+     * Looks up a uniform in the reflected table, without a GL call.
+     *
+     * @param name The uniform name. Arrays are listed under their name without the "[0]" suffix.
+     * @return The uniform location, or -1 if the program has no such active uniform.
+     */
+    GLint getUniformLocation(const std::string &name) const;
+
+    /**
+     * Sets a uniform of the program, which must be in use. The call is skipped if the
+     * uniform already has the value.
+     *
+     * @param location The uniform location from `getUniformLocation`.
+     */
+    void setUniform(GLint location, GLfloat x);
+    void setUniform(GLint location, GLfloat x, GLfloat y);
+    void setUniform(GLint location, GLint x);
+    void setUniformMatrix4(GLint location, const GLfloat *matrix);
+
+    /**
+     * Gets the uniform update counters accumulated across all programs.
+     *
+     * @return The counters.
+     */
+    static const UniformStatistics &getUniformStatistics() { return uniformStatistics; }
+
 private:
+    /**
+     * An active uniform and the last value set through the program.
+     */
+    struct UniformInfo {
+        GLenum type = 0;
+        GLint size = 0;
+        bool hasValue = false;
+        GLfloat value[16] = {}; ///< Last value; integers are stored bit for bit.
+    };
+
     GLuint programID;                                     ///< The OpenGL ID of the shader program.
     std::vector<std::shared_ptr<Shader>> attachedShaders; ///< List of shaders attached to the program.
+    std::unordered_map<std::string, GLint> uniformLocations; ///< Active uniform locations by name.
+    std::unordered_map<GLint, UniformInfo> uniforms;         ///< Active uniforms by location.
+    static UniformStatistics uniformStatistics;              ///< Counters across all programs.
+
+    /**
+     * Compares a new uniform value with the last one and remembers it.
+     *
+     * @param location The uniform location.
+     * @param value The new value.
+     * @param size The size of the value in bytes.
+     * @return True if the GL call must be issued.
+     */
+    bool updateShadow(GLint location, const void *value, size_t size);
 
     /**
      * Logs any errors encountered during the linking of the shader program.
@@ -0,0 +1,129 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VALYRIA_STATISTICS_H
+#define VALYRIA_STATISTICS_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Summary statistics of a series of samples.
+ */
+struct SummaryStatistics {
+    double average = 0.0; ///< Arithmetic mean of the samples.
+    double minimum = 0.0; ///< Smallest sample.
+    double maximum = 0.0; ///< Largest sample.
+    double stdDev = 0.0;  ///< Population standard deviation of the samples.
+};
+
+/**
+ * Helpers shared by the benchmark engine and the offline report tools.
+ */
+namespace Statistics {
+
+/**
+ * Computes the summary statistics of a series.
+ *
+ * @param values The samples. An empty series yields all zeroes.
+ * @return The summary statistics.
+ */
+SummaryStatistics summarize(const std::vector<double> &values);
+
+/**
+ * Computes the score of a single task from its FPS samples.
+ *
+ * @param fps The summary statistics of the task's FPS metric.
+ * @return The task score in the range [0, 1000].
+ */
+double taskScore(const SummaryStatistics &fps);
+
+/**
+ * Computes the median of a series.
+ *
+ * @param values The samples, passed by value because they are partially reordered.
+ * @return The median, or zero for an empty series.
+ */
+double median(std::vector<double> values);
+
+/**
+ * Computes the value at the given percentile using linear interpolation between closest ranks.
+ *
+ * @param values The samples, passed by value because they are partially reordered.
+ * @param percentile The percentile in the range [0, 100].
+ * @return The percentile value, or zero for an empty series.
+ */
+double percentile(std::vector<double> values, double percentile);
+
+/**
+ * Runs a two-sided Mann-Whitney U test using the normal approximation with tie and continuity correction.
+ *
+ * @param a The first sample.
+ * @param b The second sample.
+ * @return The p-value for the hypothesis that both samples come from the same distribution.
+ */
+double mannWhitneyPValue(const std::vector<double> &a, const std::vector<double> &b);
+
+/**
+ * Computes a bootstrap confidence interval for the relative change of the median from `baseline`
+ * to `current`, in percent. The resampling is seeded, so results are reproducible.
+ *
+ * @param baseline The baseline samples.
+ * @param current The current samples.
+ * @param confidence The confidence level, e.g. 0.95.
+ * @param iterations The number of bootstrap resamples.
+ * @return The (lower, upper) bounds of the interval.
+ */
+std::pair<double, double> bootstrapMedianChangeCI(const std::vector<double> &baseline,
+                                                  const std::vector<double> &current, double confidence = 0.95,
+                                                  int iterations = 2000);
+
+/**
+ * Downsamples a series with the largest-triangle-three-buckets algorithm, which keeps the
+ * visually significant peaks and troughs of the series.
+ *
+ * @param values The samples, evenly spaced.
+ * @param threshold The maximum number of points to keep.
+ * @return The selected points as (index, value) pairs, in order.
+ */
+std::vector<std::pair<double, double>> downsampleLTTB(const std::vector<double> &values, size_t threshold);
+
+/**
+ * Formats a value with two decimal places, as used throughout the reports.
+ *
+ * @param value The value to format.
+ * @return The formatted string.
+ */
+std::string formatTwoDecimals(double value);
+
+/**
+ * Computes the time between two steady clock readings.
+ *
+ * @param start The earlier reading.
+ * @param end The later reading.
+ * @return The elapsed time in milliseconds.
+ */
+double elapsedMs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+} // namespace Statistics
+
+#endif // VALYRIA_STATISTICS_H
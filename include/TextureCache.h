@@ -0,0 +1,136 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VALYRIA_TEXTURECACHE_H
+#define VALYRIA_TEXTURECACHE_H
+
+#include "ImageLoader.h"
+
+#include <GLES2/gl2.h>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+/**
+ * Counters of the texture cache, accumulated since the start of the run.
+ */
+struct TextureCacheStatistics {
+    uint64_t hits = 0;        ///< Requests served from the cache.
+    uint64_t misses = 0;      ///< Requests that loaded the texture.
+    uint64_t evictions = 0;   ///< Textures deleted to stay within the budget.
+    uint64_t bytesLoaded = 0; ///< Estimated GPU memory of the loaded textures.
+};
+
+/**
+ * A singleton that owns the textures loaded from image files and keeps their estimated GPU memory
+ * within a budget, deleting the least recently used textures first.
+ *
+ * Textures are keyed by their path and decode parameters, so that a file shown at two sizes is
+ * cached twice. A texture returned by `acquire` stays valid until a later `acquire` evicts it, so
+ * callers acquire the textures they draw every frame instead of keeping them. The cache must only be
+ * used on the GL thread.
+ */
+class TextureCache {
+public:
+    /**
+     * Retrieves the singleton instance of the TextureCache.
+     *
+     * @return The singleton instance of TextureCache.
+     */
+    static TextureCache &getInstance();
+
+    TextureCache(const TextureCache &) = delete;
+    TextureCache &operator=(const TextureCache &) = delete;
+
+    /**
+     * Sets the memory budget, evicting textures if the cache exceeds it.
+     *
+     * @param bytes The budget in bytes, or 0 for no limit.
+     */
+    void setBudget(size_t bytes);
+
+    size_t getBudget() const { return budget; }
+
+    /**
+     * Gets a texture, loading it on a miss. KTX and KTX2 files are loaded with
+     * `ImageLoader::loadCompressedTexture`, other images are decoded.
+     *
+     * @param filePath The path to the image file.
+     * @param targetWidth The display width passed to `ImageLoader::decodeImage`, or 0.
+     * @param targetHeight The display height passed to `ImageLoader::decodeImage`, or 0.
+     * @param mipmaps How the mipmap levels of decoded images are created.
+     * @return The texture, or 0 if it could not be loaded.
+     */
+    GLuint acquire(const std::string &filePath, unsigned int targetWidth = 0, unsigned int targetHeight = 0,
+                   MipmapGeneration mipmaps = MipmapGeneration::NONE);
+
+    /**
+     * Deletes all textures. Must be called before the GL context is destroyed.
+     */
+    void clear();
+
+    size_t getUsedBytes() const { return usedBytes; }
+    size_t getTextureCount() const { return entries.size(); }
+
+    /**
+     * Gets the counters accumulated since the start of the run.
+     *
+     * @return The counters.
+     */
+    const TextureCacheStatistics &getStatistics() const { return statistics; }
+
+private:
+    TextureCache();
+
+    struct Entry {
+        std::string key;
+        GLuint texture;
+        size_t sizeBytes;
+    };
+
+    /**
+     * Loads a texture and estimates its GPU memory.
+     *
+     * @param filePath The path to the image file.
+     * @param targetWidth The display width, or 0.
+     * @param targetHeight The display height, or 0.
+     * @param mipmaps How mipmap levels are created.
+     * @param sizeBytes Receives the estimated memory.
+     * @return The texture, or 0 on failure.
+     */
+    GLuint load(const std::string &filePath, unsigned int targetWidth, unsigned int targetHeight,
+                MipmapGeneration mipmaps, size_t &sizeBytes);
+
+    /**
+     * Evicts least recently used textures until the cache is within the budget, keeping at least
+     * the most recently used one.
+     */
+    void evict();
+
+    size_t budget;
+    size_t usedBytes;
+    std::list<Entry> entries; ///< Most recently used first.
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    ImageData image;          ///< Decode destination, reused across loads.
+    TextureCacheStatistics statistics;
+};
+
+#endif // VALYRIA_TEXTURECACHE_H
@@ -0,0 +1,163 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VALYRIA_TRACER_H
+#define VALYRIA_TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * A completed span on one thread.
+ */
+struct TraceEvent {
+    const char *name;     ///< Static or interned name.
+    const char *category; ///< Static category, e.g. "frame".
+    uint64_t startNs;     ///< Start, relative to the tracer's epoch.
+    uint64_t durationNs;
+    uint32_t threadId;    ///< Small sequential id of the recording thread.
+};
+
+/**
+ * A singleton that records timed spans into a preallocated ring buffer and writes them as Chrome
+ * trace event JSON, which can be opened in Perfetto or chrome://tracing.
+ *
+ * Recording does not allocate or lock: a span claims a slot with an atomic increment, and the oldest
+ * spans are overwritten once the buffer is full. Names must outlive the tracer; use string literals,
+ * or `intern` for names built at runtime, outside of per-frame code.
+ */
+class Tracer {
+public:
+    /**
+     * Retrieves the singleton instance of the Tracer.
+     *
+     * @return The singleton instance of Tracer.
+     */
+    static Tracer &getInstance();
+
+    Tracer(const Tracer &) = delete;
+    Tracer &operator=(const Tracer &) = delete;
+
+    /**
+     * Allocates the ring buffer and starts recording.
+     *
+     * @param capacity The number of spans kept.
+     */
+    void enable(size_t capacity);
+
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * Returns a copy of a name that stays valid for the lifetime of the tracer.
+     *
+     * @param name The name.
+     * @return The interned name.
+     */
+    const char *intern(const std::string &name);
+
+    /**
+     * Names the calling thread in the trace.
+     *
+     * @param name A static or interned name.
+     */
+    void setThreadName(const char *name);
+
+    /**
+     * Gets the current time on the tracer's clock.
+     *
+     * @return Nanoseconds since the tracer was created.
+     */
+    uint64_t now() const {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    /**
+     * Records a completed span.
+     *
+     * @param name A static or interned name.
+     * @param category A static category.
+     * @param startNs The start time from `now`.
+     * @param endNs The end time from `now`.
+     */
+    void record(const char *name, const char *category, uint64_t startNs, uint64_t endNs);
+
+    /**
+     * Writes the recorded spans as Chrome trace event JSON.
+     *
+     * @param filePath The output file.
+     * @return True if the file was written.
+     */
+    bool writeChromeTrace(const std::string &filePath) const;
+
+private:
+    Tracer();
+
+    /**
+     * Gets the id of the calling thread, assigning one on first use.
+     */
+    uint32_t getThreadId();
+
+    std::chrono::steady_clock::time_point epoch;
+    std::atomic<bool> enabled;
+    std::vector<TraceEvent> events;      ///< The ring buffer.
+    std::atomic<uint64_t> nextEvent;     ///< Total number of spans recorded.
+    std::atomic<uint32_t> nextThreadId;
+
+    mutable std::mutex namesMutex;                            ///< Guards the members below.
+    std::deque<std::string> internedNames;                    ///< Stable storage for interned names.
+    std::vector<std::pair<uint32_t, const char *>> threadNames; ///< Thread names by id.
+};
+
+/**
+ * Records a span from construction to destruction, if the tracer is enabled.
+ */
+class TraceScope {
+public:
+    TraceScope(const char *name, const char *category) : name(name), category(category), startNs(0) {
+        Tracer &tracer = Tracer::getInstance();
+        if (tracer.isEnabled()) {
+            startNs = tracer.now();
+        } else {
+            this->name = nullptr;
+        }
+    }
+
+    ~TraceScope() {
+        if (name) {
+            Tracer &tracer = Tracer::getInstance();
+            tracer.record(name, category, startNs, tracer.now());
+        }
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *name;
+    const char *category;
+    uint64_t startNs;
+};
+
+#endif // VALYRIA_TRACER_H
@@ -0,0 +1,73 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VALYRIA_CATALOGSCROLL_H
+#define VALYRIA_CATALOGSCROLL_H
+
+#include "RenderTask.h"
+#include "ShaderManager.h"
+
+#include <GLES2/gl2.h>
+#include <string>
+#include <vector>
+
+/**
+ * A RenderTask that scrolls through a catalog of posters like an EPG, loading every visible poster
+ * through the TextureCache.
+ *
+ * The catalog is a grid of distinct poster files that scrolls down at a constant speed and wraps
+ * around, so that the posters of the first rows are requested again after each pass. Posters are
+ * loaded synchronously at the size they are drawn at, so each cache miss stalls the frame; the
+ * stalls and the cache's memory are reported per frame.
+ */
+class CatalogScroll : public RenderTask {
+public:
+    CatalogScroll(const std::string &taskName);
+
+    bool setup() override;
+    void teardown() override;
+
+    void render(int width, int height) override;
+    void update(float elapsedTime, float deltaTime) override;
+
+    bool isScored() const override { return false; }
+
+    std::vector<ShaderProgramSource> getShaderPrograms() const override;
+
+private:
+    std::vector<std::string> posters; ///< Poster files, row by row.
+    float scrollRows;                 ///< Rows scrolled since the start.
+
+    GLuint quadVBO;
+    ShaderProgramHandle programHandle;
+    std::shared_ptr<ShaderProgram> program;
+    GLint imageLocation;
+
+    /**
+     * Recreates the catalog directory with links to the images of the texture corpus, one per poster.
+     * Distinct paths make distinct cache entries.
+     *
+     * @param directory The catalog directory.
+     * @param corpus The images of the texture corpus.
+     * @return True if every poster exists.
+     */
+    bool createCatalog(const std::string &directory, const std::vector<std::string> &corpus);
+};
+
+#endif // VALYRIA_CATALOGSCROLL_H
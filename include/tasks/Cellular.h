@@ -22,6 +22,7 @@
 
 #include "GraphicsContext.h"
 #include "RenderTask.h"
+#include "ShaderManager.h"
 
 #include <GLES2/gl2.h>
 
@@ -41,10 +42,14 @@ public:
     void render(int width, int height) override;
     void update(float elapsedTime, float deltaTime) override;
 
+    std::vector<ShaderProgramSource> getShaderPrograms() const override;
+
 private:
     bool enableFBM;
     float elapsedTime;
     GLuint quadVBO;
+    ShaderProgramHandle programHandle;
+    std::shared_ptr<ShaderProgram> program;
 
     GLint iTimeLocation;
     GLint iResolutionLocation;
@@ -22,6 +22,7 @@
 
 #include "GraphicsContext.h"
 #include "RenderTask.h"
+#include "ShaderManager.h"
 
 #include <GLES2/gl2.h>
 
@@ -30,10 +31,21 @@
  * 
  * Original shader: Box Frame - Distance 3D
  * Source: https://www.shadertoy.com/view/3ljcRh
+ *
+ * By default, the anti-aliasing level and the raymarch step count are uniforms. A specialized task
+ * builds a permutation of the shader with both baked in as constants.
  */
 class Cube : public RenderTask {
 public:
-    explicit Cube(const std::string &taskName, int AA = 1, int maxSteps = 128);
+    /**
+     * @param taskName The name of the task.
+     * @param AA The anti-aliasing level; AA x AA samples are taken per pixel.
+     * @param maxSteps The maximum number of raymarch steps.
+     * @param specialized Whether to bake the parameters into the shader.
+     * @param scored Whether the task counts towards the score.
+     */
+    explicit Cube(const std::string &taskName, int AA = 1, int maxSteps = 128, bool specialized = false,
+                  bool scored = true);
     ~Cube() override = default;
 
     bool setup() override;
@@ -42,11 +54,19 @@ public:
     void render(int width, int height) override;
     void update(float elapsedTime, float deltaTime) override;
 
+    bool isScored() const override { return scored; }
+
+    std::vector<ShaderProgramSource> getShaderPrograms() const override;
+
 private:
     int AA;
     int maxSteps;
+    bool specialized;
+    bool scored;
     float elapsedTime;
     GLuint quadVBO;
+    ShaderProgramHandle programHandle;
+    std::shared_ptr<ShaderProgram> program;
 
     GLint iTimeLocation;
     GLint iResolutionLocation;
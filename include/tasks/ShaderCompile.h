@@ -0,0 +1,81 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VALYRIA_SHADERCOMPILE_H
+#define VALYRIA_SHADERCOMPILE_H
+
+#include "RenderTask.h"
+
+#include <GLES2/gl2.h>
+#include <string>
+#include <vector>
+
+/**
+ * A RenderTask that measures shader compile, link and first-draw latency.
+ *
+ * Every frame builds one program from scratch, cycling through all fragment shaders in the
+ * asset directory and a set of generated shaders of growing complexity. Each build gets a
+ * unique `#define`, so drivers cannot return a previously compiled shader.
+ */
+class ShaderCompile : public RenderTask {
+public:
+    ShaderCompile(const std::string &taskName);
+
+    bool setup() override;
+    void teardown() override;
+
+    void render(int width, int height) override;
+    void update(float elapsedTime, float deltaTime) override;
+
+    bool isScored() const override { return false; }
+
+private:
+    /**
+     * A vertex and fragment shader pair that is built repeatedly.
+     */
+    struct ProgramSource {
+        std::string name;
+        std::string vertexSource;
+        std::string fragmentSource;
+    };
+
+    std::vector<ProgramSource> programs;
+    size_t nextProgram;
+    unsigned int nonce;
+    GLuint quadVBO;
+
+    /**
+     * Generates a fragment shader with the given number of dependent arithmetic steps.
+     *
+     * @param steps The number of steps.
+     * @return The shader source.
+     */
+    static std::string generateFragmentShader(int steps);
+
+    /**
+     * Compiles a shader and waits for the result.
+     *
+     * @param type The shader type.
+     * @param source The shader source.
+     * @return The shader object, or 0 on failure.
+     */
+    static GLuint compileShader(GLenum type, const std::string &source);
+};
+
+#endif // VALYRIA_SHADERCOMPILE_H
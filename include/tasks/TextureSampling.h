@@ -0,0 +1,112 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VALYRIA_TEXTURESAMPLING_H
+#define VALYRIA_TEXTURESAMPLING_H
+
+#include "ImageLoader.h"
+#include "RenderTask.h"
+#include "ShaderManager.h"
+
+#include <GLES2/gl2.h>
+#include <string>
+#include <vector>
+
+/**
+ * A RenderTask that measures texture sampling cost by texture format.
+ *
+ * The same generated UI-like content is sampled as uncompressed RGBA8, as RGB565 or as ETC1, which
+ * is encoded once into a KTX file and loaded with `ImageLoader::loadCompressedTexture`. Every frame
+ * draws several full-screen layers that each sample a different region of the mipmapped texture at
+ * one texel per pixel, and waits for the GPU, so that the sampling time reflects the memory traffic
+ * of the format.
+ */
+class TextureSampling : public RenderTask {
+public:
+    enum class Format { RGBA8, RGB565, ETC1 };
+
+    /**
+     * @param taskName The name of the task.
+     * @param format The format the texture is sampled in.
+     */
+    TextureSampling(const std::string &taskName, Format format);
+
+    bool setup() override;
+    void teardown() override;
+
+    void render(int width, int height) override;
+    void update(float elapsedTime, float deltaTime) override;
+
+    bool isScored() const override { return false; }
+
+    std::vector<ShaderProgramSource> getShaderPrograms() const override;
+
+private:
+    /**
+     * An RGB image and its mipmap chain, largest first.
+     */
+    struct MipmapChain {
+        std::vector<ImageData> levels; ///< `GL_RGB` images.
+        unsigned int size = 0;
+    };
+
+    Format format;
+    double bitsPerTexel;
+    GLuint quadVBO;
+    GLuint texture;
+    ShaderProgramHandle programHandle;
+    std::shared_ptr<ShaderProgram> program;
+    GLint imageLocation;
+    GLint offsetLocation;
+    GLint scaleLocation;
+
+    /**
+     * Creates the texture in the task's format and records its size.
+     *
+     * @return True if the texture was created.
+     */
+    bool createTexture();
+
+    /**
+     * Loads the ETC1 texture from its KTX file, encoding the file first if it does not exist.
+     *
+     * @param chain The content, used if the file has to be encoded.
+     * @return True if the texture was created.
+     */
+    bool loadETC1Texture(const MipmapChain &chain);
+
+    /**
+     * Generates the square content of the texture with all its mipmap levels.
+     *
+     * @param size The size of the base level.
+     * @return The mipmap chain.
+     */
+    static MipmapChain generateContent(unsigned int size);
+
+    /**
+     * Writes a KTX file holding the ETC1 encoding of a mipmap chain.
+     *
+     * @param filePath The path of the file.
+     * @param chain The content.
+     * @return True if the file was written.
+     */
+    static bool writeETC1KTX(const std::string &filePath, const MipmapChain &chain);
+};
+
+#endif // VALYRIA_TEXTURESAMPLING_H
@@ -0,0 +1,117 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VALYRIA_TEXTUREUPLOAD_H
+#define VALYRIA_TEXTUREUPLOAD_H
+
+#include "AsyncTextureLoader.h"
+#include "ImageLoader.h"
+#include "RenderTask.h"
+#include "ShaderManager.h"
+
+#include <GLES2/gl2.h>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <string>
+#include <vector>
+
+/**
+ * A RenderTask that measures texture streaming: decoding PNG and JPG images with the ImageLoader
+ * and uploading them with `glTexImage2D`, as when a UI loads poster art.
+ *
+ * The last uploaded texture is drawn full screen. Synchronously, every other frame decodes and
+ * uploads the next image of the corpus, and the frame interval after frames with and without an
+ * upload is reported. Asynchronously, images are decoded by the AsyncTextureLoader's workers and
+ * uploaded within a per-frame budget, and the loader's queue depths and latencies are reported.
+ * Decode and upload throughput are reported per image in both modes.
+ */
+class TextureUpload : public RenderTask {
+public:
+    /**
+     * @param taskName The name of the task.
+     * @param async Whether images are loaded by the AsyncTextureLoader.
+     */
+    TextureUpload(const std::string &taskName, bool async = false);
+
+    bool setup() override;
+    void teardown() override;
+
+    void render(int width, int height) override;
+    void update(float elapsedTime, float deltaTime) override;
+
+    bool isScored() const override { return false; }
+
+    std::vector<ShaderProgramSource> getShaderPrograms() const override;
+
+    /**
+     * Lists the images in the corpus directory, generating a synthetic corpus if it has none.
+     *
+     * @param directory The corpus directory.
+     * @param files Receives the image files, sorted by name.
+     * @return True if the corpus is not empty.
+     */
+    static bool loadCorpus(const std::string &directory, std::vector<std::string> &files);
+
+private:
+    bool async;
+    std::vector<std::string> corpus; ///< Image files, cycled through in order.
+    ImageData image;                 ///< Decode destination, reused across images.
+    size_t nextImage;
+    unsigned int frame;
+    bool uploadedLastFrame;
+    std::chrono::steady_clock::time_point lastRenderTime;
+
+    AsyncTextureLoader loader;
+    std::deque<std::future<GLuint>> pendingLoads; ///< Requests of the async loader in flight.
+    size_t maxPendingLoads;
+    size_t uploadBudgetBytes;
+    unsigned int loadedInWindow;                  ///< Textures completed in the current second.
+    std::chrono::steady_clock::time_point windowStart;
+
+    GLuint quadVBO;
+    GLuint texture;
+    ShaderProgramHandle programHandle;
+    std::shared_ptr<ShaderProgram> program;
+    GLint imageLocation;
+
+    /**
+     * Decodes and uploads the next image of the corpus and records its throughput.
+     */
+    void uploadNextImage();
+
+    /**
+     * Keeps the async loader busy, uploads within the frame budget, shows completed textures and
+     * records the loader's statistics.
+     */
+    void streamImages();
+
+    /**
+     * Writes a synthetic corpus of PNG and JPG images at typical poster and screen sizes.
+     *
+     * @param directory The corpus directory.
+     * @return True if all images were written.
+     */
+    static bool generateCorpus(const std::string &directory);
+
+    static bool writePNG(const std::string &filePath, const ImageData &image);
+    static bool writeJPG(const std::string &filePath, const ImageData &image, int quality);
+};
+
+#endif // VALYRIA_TEXTUREUPLOAD_H
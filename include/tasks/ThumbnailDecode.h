@@ -0,0 +1,78 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VALYRIA_THUMBNAILDECODE_H
+#define VALYRIA_THUMBNAILDECODE_H
+
+#include "ImageLoader.h"
+#include "RenderTask.h"
+#include "ShaderManager.h"
+
+#include <GLES2/gl2.h>
+#include <string>
+#include <vector>
+
+/**
+ * A RenderTask that loads the JPG images of the texture corpus as thumbnails, as a UI does for a
+ * rail of posters drawn at a quarter of their size.
+ *
+ * Every frame decodes the next image, uploads it, creates its mipmap levels and draws the most
+ * recent thumbnails in a grid. The image is either decoded at full size and minified by the GPU,
+ * or decoded at a reduced scale by libjpeg, which saves decode time and texture memory.
+ */
+class ThumbnailDecode : public RenderTask {
+public:
+    /**
+     * @param taskName The name of the task.
+     * @param scaledDecode Whether images are decoded at the smallest JPG scale covering the thumbnail.
+     * @param mipmaps How the mipmap levels of the thumbnails are created.
+     */
+    ThumbnailDecode(const std::string &taskName, bool scaledDecode, MipmapGeneration mipmaps);
+
+    bool setup() override;
+    void teardown() override;
+
+    void render(int width, int height) override;
+    void update(float elapsedTime, float deltaTime) override;
+
+    bool isScored() const override { return false; }
+
+    std::vector<ShaderProgramSource> getShaderPrograms() const override;
+
+private:
+    bool scaledDecode;
+    MipmapGeneration mipmaps;
+    std::vector<std::string> corpus; ///< JPG files, cycled through in order.
+    ImageData image;                 ///< Decode destination, reused across images.
+    size_t nextImage;
+    std::vector<GLuint> thumbnails;  ///< The most recent thumbnails, drawn in a grid.
+    size_t nextThumbnail;
+
+    GLuint quadVBO;
+    ShaderProgramHandle programHandle;
+    std::shared_ptr<ShaderProgram> program;
+    GLint imageLocation;
+
+    /**
+     * Decodes, uploads and mipmaps the next image of the corpus and records the cost of each step.
+     */
+    void loadNextThumbnail();
+};
+
+#endif // VALYRIA_THUMBNAILDECODE_H
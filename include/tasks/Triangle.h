@@ -22,6 +22,7 @@
 
 #include "GraphicsContext.h"
 #include "RenderTask.h"
+#include "ShaderManager.h"
 
 #include <GLES2/gl2.h>
 
@@ -38,8 +39,12 @@ public:
     void render(int width, int height) override;
     void update(float elapsedTime, float deltaTime) override;
 
+    std::vector<ShaderProgramSource> getShaderPrograms() const override;
+
 private:
-    GLuint rotationUniform;
+    ShaderProgramHandle programHandle;
+    std::shared_ptr<ShaderProgram> program;
+    GLint rotationUniform;
     GLint posAttrib, colorAttrib;
     float rotationAngle;
 };
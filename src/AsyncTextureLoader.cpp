@@ -0,0 +1,230 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "AsyncTextureLoader.h"
+#include "GLStateCache.h"
+#include "Logger.h"
+#include "Statistics.h"
+#include "Tracer.h"
+
+#include <algorithm>
+
+AsyncTextureLoader::AsyncTextureLoader() : decoding(0), stopping(false) {}
+
+AsyncTextureLoader::~AsyncTextureLoader() { stop(); }
+
+void AsyncTextureLoader::start(unsigned int workerCount, size_t bufferCount) {
+    stop();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+        freeBuffers.resize(std::max<size_t>(bufferCount, 1));
+    }
+    for (unsigned int i = 0; i < std::max(workerCount, 1u); ++i) {
+        workers.emplace_back(&AsyncTextureLoader::runWorker, this);
+    }
+    logDebug("Async texture loader started with " + std::to_string(workers.size()) + " workers and " +
+             std::to_string(freeBuffers.size()) + " buffers.");
+}
+
+void AsyncTextureLoader::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    // Outstanding requests are failed, so that no future waits forever.
+    std::deque<std::unique_ptr<Request>> outstanding;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        outstanding.swap(decodeQueue);
+        for (auto &request : uploadQueue) {
+            outstanding.push_back(std::move(request));
+        }
+        uploadQueue.clear();
+    }
+    if (uploading) {
+        GLStateCache::getInstance().deleteTexture(uploading->texture);
+        outstanding.push_back(std::move(uploading));
+    }
+    for (auto &request : outstanding) {
+        request->promise.set_value(0);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    freeBuffers.clear();
+    timings.clear();
+}
+
+std::future<GLuint> AsyncTextureLoader::load(const std::string &filePath) {
+    auto request = std::make_unique<Request>();
+    request->filePath = filePath;
+    request->requestTime = Clock::now();
+    std::future<GLuint> future = request->promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        decodeQueue.push_back(std::move(request));
+    }
+    workAvailable.notify_one();
+    return future;
+}
+
+void AsyncTextureLoader::runWorker() {
+    Tracer::getInstance().setThreadName("Texture decoder");
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        workAvailable.wait(lock, [this]() { return stopping || (!decodeQueue.empty() && !freeBuffers.empty()); });
+        if (stopping) {
+            break;
+        }
+
+        std::unique_ptr<Request> request = std::move(decodeQueue.front());
+        decodeQueue.pop_front();
+        request->image = std::move(freeBuffers.back());
+        freeBuffers.pop_back();
+        ++decoding;
+        lock.unlock();
+
+        {
+            TraceScope decodeScope("decode", "texture");
+            request->decodeStartTime = Clock::now();
+            request->decoded = ImageLoader::decodeImage(request->filePath, request->image);
+            request->decodeEndTime = Clock::now();
+        }
+
+        lock.lock();
+        --decoding;
+        uploadQueue.push_back(std::move(request));
+    }
+}
+
+void AsyncTextureLoader::processUploads(size_t budgetBytes) {
+    TraceScope uploadScope("texture uploads", "texture");
+    GLStateCache &stateCache = GLStateCache::getInstance();
+    size_t uploadedBytes = 0;
+    while (true) {
+        if (!uploading) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (uploadQueue.empty()) {
+                break;
+            }
+            uploading = std::move(uploadQueue.front());
+            uploadQueue.pop_front();
+        }
+
+        Request &request = *uploading;
+        if (!request.decoded) {
+            logError("Async texture loader: failed to decode '" + request.filePath + "'.");
+            complete(std::move(uploading), 0);
+            continue;
+        }
+        if (uploadedBytes > 0 && uploadedBytes >= budgetBytes) {
+            break;
+        }
+
+        const ImageData &image = request.image;
+        size_t rowBytes = image.getSizeBytes() / image.height;
+        size_t budgetRows = (budgetBytes - std::min(budgetBytes, uploadedBytes)) / rowBytes;
+        unsigned int rows =
+            static_cast<unsigned int>(std::clamp<size_t>(budgetRows, 1, image.height - request.nextRow));
+
+        auto callStart = Clock::now();
+        bool firstStrip = request.nextRow == 0;
+        if (firstStrip) {
+            request.uploadStartTime = callStart;
+            glGenTextures(1, &request.texture);
+        }
+        stateCache.bindTexture(GL_TEXTURE_2D, request.texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, image.format == GL_RGBA ? 4 : 1);
+        if (firstStrip && rows == image.height) {
+            // The whole image fits in the budget.
+            glTexImage2D(GL_TEXTURE_2D, 0, image.format, image.width, image.height, 0, image.format,
+                         GL_UNSIGNED_BYTE, image.pixels.data());
+        } else {
+            if (firstStrip) {
+                glTexImage2D(GL_TEXTURE_2D, 0, image.format, image.width, image.height, 0, image.format,
+                             GL_UNSIGNED_BYTE, nullptr);
+            }
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, request.nextRow, image.width, rows, image.format, GL_UNSIGNED_BYTE,
+                            image.pixels.data() + request.nextRow * rowBytes);
+        }
+        request.nextRow += rows;
+        uploadedBytes += rows * rowBytes;
+
+        if (request.nextRow == image.height) {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+        request.uploadCallMs += Statistics::elapsedMs(callStart, Clock::now());
+
+        if (request.nextRow == image.height) {
+            GLuint texture = request.texture;
+            complete(std::move(uploading), texture);
+        }
+    }
+    stateCache.bindTexture(GL_TEXTURE_2D, 0);
+}
+
+void AsyncTextureLoader::complete(std::unique_ptr<Request> request, GLuint texture) {
+    auto now = Clock::now();
+    if (texture != 0) {
+        TextureLoadTiming timing;
+        timing.filePath = request->filePath;
+        timing.width = request->image.width;
+        timing.height = request->image.height;
+        timing.bytes = request->image.getSizeBytes();
+        timing.decodeWaitMs = Statistics::elapsedMs(request->requestTime, request->decodeStartTime);
+        timing.decodeMs = Statistics::elapsedMs(request->decodeStartTime, request->decodeEndTime);
+        timing.uploadWaitMs = Statistics::elapsedMs(request->decodeEndTime, request->uploadStartTime);
+        timing.uploadMs = Statistics::elapsedMs(request->uploadStartTime, now);
+        timing.uploadCallMs = request->uploadCallMs;
+        timing.totalMs = Statistics::elapsedMs(request->requestTime, now);
+        timings.push_back(std::move(timing));
+    }
+    request->promise.set_value(texture);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeBuffers.push_back(std::move(request->image));
+    }
+    workAvailable.notify_one();
+}
+
+size_t AsyncTextureLoader::getDecodeQueueDepth() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return decodeQueue.size() + decoding;
+}
+
+size_t AsyncTextureLoader::getUploadQueueDepth() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return uploadQueue.size() + (uploading ? 1 : 0);
+}
+
+std::vector<TextureLoadTiming> AsyncTextureLoader::takeTimings() {
+    std::vector<TextureLoadTiming> completed;
+    completed.swap(timings);
+    return completed;
+}
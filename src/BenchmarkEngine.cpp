@@ -19,8 +19,12 @@
 
 #include "BenchmarkEngine.h"
 #include "ConfigurationManager.h"
+#include "GLStateCache.h"
 #include "Logger.h"
 #include "ShaderManager.h"
+#include "Statistics.h"
+#include "TextureCache.h"
+#include "Tracer.h"
 
 #ifdef PLATFORM_AMLOGIC
 #include "collectors/AmlogicMetricsCollector.h"
@@ -30,19 +34,78 @@
 #include "collectors/RealtekMetricsCollector.h"
 #endif
 
+#include "tasks/CatalogScroll.h"
 #include "tasks/Cellular.h"
 #include "tasks/Clear.h"
 #include "tasks/Cube.h"
+#include "tasks/ShaderCompile.h"
+#include "tasks/TextureSampling.h"
+#include "tasks/TextureUpload.h"
+#include "tasks/ThumbnailDecode.h"
 #include "tasks/Triangle.h"
 
 #include <chrono>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
 #include <thread>
 
+namespace {
+
+/**
+ * Number of spans kept by the tracer: about 30 s of every task at 60 fps.
+ */
+constexpr size_t TRACE_BUFFER_SPANS = 1 << 17;
+
+/**
+ * Frame rate the jank threshold refers to when the frame rate is not limited.
+ */
+constexpr double UNLIMITED_JANK_REFERENCE_RATE = 60.0;
+
+/**
+ * Parses a texture cache budget given in megabytes.
+ *
+ * @param value The option value, "none" for no limit.
+ * @param bytes Receives the budget in bytes, or 0 for no limit.
+ * @return True if the value is "none" or a whole number of megabytes that fits in a size_t once converted to bytes.
+ */
+bool parseTextureCacheBudget(const std::string &value, size_t &bytes) {
+    if (value == "none") {
+        bytes = 0;
+        return true;
+    }
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    constexpr uint64_t BYTES_PER_MB = 1024 * 1024;
+    uint64_t megabytes = 0;
+    try {
+        megabytes = std::stoull(value);
+    } catch (const std::out_of_range &) {
+        return false;
+    }
+    if (megabytes > std::numeric_limits<size_t>::max() / BYTES_PER_MB) {
+        return false;
+    }
+    bytes = static_cast<size_t>(megabytes * BYTES_PER_MB);
+    return true;
+}
+
+} // namespace
+
 BenchmarkEngine::BenchmarkEngine() : graphicsContext(std::make_unique<GraphicsContext>()), metricsCollector(nullptr) {}
 
 BenchmarkEngine::~BenchmarkEngine() { cleanup(); }
 
 bool BenchmarkEngine::initialize() {
+    Tracer &tracer = Tracer::getInstance();
+    if (ConfigurationManager::getInstance().getValue("trace_file") != "none") {
+        tracer.enable(TRACE_BUFFER_SPANS);
+    }
+    tracer.setThreadName("Render");
+    TraceScope initializeScope("initialize", "engine");
+
     if (!graphicsContext->initialize()) {
         logError("Failed to initialize graphics context.");
         return false;
@@ -69,6 +132,27 @@ bool BenchmarkEngine::initialize() {
 
     metricsCollector->collectStaticSystemInfo();
 
+    ConfigurationManager &configManager = ConfigurationManager::getInstance();
+    std::string jankThreshold = configManager.getValue("jank_threshold");
+    double jankThresholdMs = 0.0;
+    if (jankThreshold != "none") {
+        int targetFrameRate = std::stoi(configManager.getValue("target_frame_rate"));
+        double referenceRate = targetFrameRate > 0 ? targetFrameRate : UNLIMITED_JANK_REFERENCE_RATE;
+        jankThresholdMs = std::stod(jankThreshold) * 1000.0 / referenceRate;
+    }
+    flightRecorder.configure(std::stoul(configManager.getValue("jank_history")), jankThresholdMs);
+    metricsCollector->setJankThreshold(jankThresholdMs);
+
+    ShaderManager::getInstance().initialize(configManager.getValue("program_binary_cache"));
+
+    std::string textureCacheBudget = configManager.getValue("texture_cache_budget");
+    size_t textureCacheBudgetBytes = 0;
+    if (!parseTextureCacheBudget(textureCacheBudget, textureCacheBudgetBytes)) {
+        logError("Invalid texture_cache_budget '" + textureCacheBudget + "'. Expected 'none' or a number of MB.");
+        return false;
+    }
+    TextureCache::getInstance().setBudget(textureCacheBudgetBytes);
+
     createRenderTasks();
 
     logDebug("BenchmarkEngine initialized successfully.");
@@ -96,7 +180,8 @@ void BenchmarkEngine::listAvailableTasks() const {
     }
 }
 
-void BenchmarkEngine::runBenchmark(std::shared_ptr<RenderTask> task, int durationInSeconds) {
+void BenchmarkEngine::runBenchmark(std::shared_ptr<RenderTask> task, int durationInSeconds,
+                                   const std::string &reportName, bool scored) {
     if (!graphicsContext || !metricsCollector) {
         logError("BenchmarkEngine is not properly initialized.");
         return;
@@ -105,13 +190,74 @@ void BenchmarkEngine::runBenchmark(std::shared_ptr<RenderTask> task, int duratio
     ConfigurationManager &configManager = ConfigurationManager::getInstance();
     int targetFrameRate = std::stoi(configManager.getValue("target_frame_rate"));
 
-    if (!task->setup()) {
-        logError("Failed to setup RenderTask: " + task->getName());
-        task->teardown();
-        return;
+    metricsCollector->clearMetrics();
+    task->clearTaskMetrics();
+
+    ShaderManager &shaderManager = ShaderManager::getInstance();
+    std::string asyncShaderCompile = configManager.getValue("async_shader_compile");
+    double serialCompileMs = 0.0;
+    double parallelCompileMs = 0.0;
+    if (asyncShaderCompile == "compare" &&
+        shaderManager.measureParallelCompile(task->getShaderPrograms(), serialCompileMs, parallelCompileMs)) {
+        metricsCollector->recordMetric("Serial shader compile (ms)", serialCompileMs, MetricType::GAUGE);
+        metricsCollector->recordMetric("Parallel shader compile (ms)", parallelCompileMs, MetricType::GAUGE);
+        metricsCollector->recordMetric("Parallel compile time saved (ms)", serialCompileMs - parallelCompileMs,
+                                       MetricType::GAUGE);
     }
 
-    metricsCollector->clearMetrics();
+    Tracer &tracer = Tracer::getInstance();
+    const char *traceName = tracer.isEnabled() ? tracer.intern(reportName) : nullptr;
+    uint64_t taskTraceStart = tracer.now();
+
+    ShaderCacheStatistics cacheBefore = shaderManager.getCacheStatistics();
+    auto setupStart = std::chrono::steady_clock::now();
+    {
+        TraceScope setupScope("setup", "task");
+        if (asyncShaderCompile != "off") {
+            // Compilation continues in the driver while the task creates its other resources.
+            shaderManager.preloadShaderPrograms(task->getShaderPrograms());
+        }
+        if (!task->setup()) {
+            logError("Failed to setup RenderTask: " + task->getName());
+            task->teardown();
+            return;
+        }
+    }
+    auto setupEnd = std::chrono::steady_clock::now();
+    double setupTimeMs = std::chrono::duration<double, std::milli>(setupEnd - setupStart).count();
+    const ShaderCacheStatistics &cacheAfter = shaderManager.getCacheStatistics();
+    // Setup is cold when any program was built from source, and warm when all were loaded from binaries.
+    std::string setupMetric = "Setup time (ms)";
+    if (cacheAfter.programsLinked > cacheBefore.programsLinked) {
+        setupMetric = "Cold setup time (ms)";
+    } else if (cacheAfter.programBinariesLoaded > cacheBefore.programBinariesLoaded) {
+        setupMetric = "Warm setup time (ms)";
+    }
+    metricsCollector->recordMetric(setupMetric, setupTimeMs, MetricType::GAUGE);
+    metricsCollector->recordMetric("Program binaries loaded",
+                                   cacheAfter.programBinariesLoaded - cacheBefore.programBinariesLoaded,
+                                   MetricType::GAUGE);
+    metricsCollector->recordMetric("Shader compiles", cacheAfter.compiles - cacheBefore.compiles, MetricType::GAUGE);
+    metricsCollector->recordMetric("Shader compiles avoided", cacheAfter.compilesAvoided - cacheBefore.compilesAvoided,
+                                   MetricType::GAUGE);
+    metricsCollector->recordMetric("Shader compile time saved (ms)", cacheAfter.timeSavedMs - cacheBefore.timeSavedMs,
+                                   MetricType::GAUGE);
+
+    // Start every task after the same idle time. The gap follows setup, so a slow setup does not shorten it.
+    if (previousTaskEnd != std::chrono::steady_clock::time_point()) {
+        TraceScope gapScope("inter-task gap", "task");
+        int interTaskGapMs = std::stoi(configManager.getValue("inter_task_gap"));
+        std::this_thread::sleep_until(setupEnd + std::chrono::milliseconds(interTaskGapMs));
+        double gapMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - setupEnd).count();
+        metricsCollector->recordMetric("Inter-task gap (ms)", gapMs, MetricType::GAUGE);
+    }
+
+    UniformStatistics uniformsBefore = ShaderProgram::getUniformStatistics();
+    GLStateStatistics stateBefore = GLStateCache::getInstance().getStatistics();
+    TextureCacheStatistics textureCacheBefore = TextureCache::getInstance().getStatistics();
+    uint64_t droppedLogMessagesBefore = LoggerConfig::getDroppedMessages();
+    unsigned int frames = 0;
+    flightRecorder.beginTask();
     metricsCollector->startCollection();
 
     auto startTime = std::chrono::steady_clock::now();
@@ -126,53 +272,145 @@ void BenchmarkEngine::runBenchmark(std::shared_ptr<RenderTask> task, int duratio
     int elapsedTimeMs = 0;
     int sleepTimeMs = 0;
 
-    logInfo("Running '" + task->getName() + "' for " + std::to_string(durationInSeconds) + " seconds.");
+    logInfo("Running '" + reportName + "' for " + std::to_string(durationInSeconds) + " seconds.");
 
     // main loop
     while (std::chrono::steady_clock::now() < endTime) {
+        TraceScope frameScope("frame", "frame");
         frameStartTime = std::chrono::steady_clock::now();
 
         elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(frameStartTime - startTime).count();
         deltaTime = std::chrono::duration_cast<std::chrono::milliseconds>(frameStartTime - previousFrameTime).count();
         previousFrameTime = frameStartTime;
 
-        task->update(elapsedTime, deltaTime);
-        task->render(graphicsContext->getWidth(), graphicsContext->getHeight());
-
-        graphicsContext->updateDisplay();
+        {
+            TraceScope updateScope("update", "frame");
+            task->update(elapsedTime, deltaTime);
+        }
+        auto updateEndTime = std::chrono::steady_clock::now();
+        {
+            TraceScope renderScope("render", "frame");
+            task->render(graphicsContext->getWidth(), graphicsContext->getHeight());
+        }
+        auto renderEndTime = std::chrono::steady_clock::now();
+        {
+            TraceScope displayScope("updateDisplay", "frame");
+            graphicsContext->updateDisplay();
+        }
+        frameEndTime = std::chrono::steady_clock::now();
         metricsCollector->incrementFrameCount();
+        ++frames;
 
+        double sleepMs = 0.0;
         if (targetFrameRate > 0) {
-            frameEndTime = std::chrono::steady_clock::now();
             elapsedTimeMs =
                 std::chrono::duration_cast<std::chrono::milliseconds>(frameEndTime - frameStartTime).count();
             sleepTimeMs = frameTimeMs - elapsedTimeMs;
 
             if (sleepTimeMs > 0) {
+                TraceScope sleepScope("sleep", "frame");
                 std::this_thread::sleep_for(std::chrono::milliseconds(sleepTimeMs));
+                sleepMs = Statistics::elapsedMs(frameEndTime, std::chrono::steady_clock::now());
             }
         }
+        FrameRecord record{frames - 1,
+                           static_cast<float>(Statistics::elapsedMs(startTime, frameStartTime)),
+                           static_cast<float>(Statistics::elapsedMs(frameStartTime, updateEndTime)),
+                           static_cast<float>(Statistics::elapsedMs(updateEndTime, renderEndTime)),
+                           static_cast<float>(Statistics::elapsedMs(renderEndTime, frameEndTime)),
+                           static_cast<float>(sleepMs)};
+        metricsCollector->recordFramePhases(record.updateMs, record.renderMs, record.displayMs, record.sleepMs);
+        if (flightRecorder.recordFrame(record)) {
+            metricsCollector->recordJankSpike(flightRecorder.snapshot());
+        }
     }
 
     metricsCollector->stopCollection();
-    task->teardown();
+    previousTaskEnd = std::chrono::steady_clock::now();
+    const UniformStatistics &uniformsAfter = ShaderProgram::getUniformStatistics();
+    metricsCollector->recordMetric("Uniform calls issued", uniformsAfter.issued - uniformsBefore.issued,
+                                   MetricType::GAUGE);
+    metricsCollector->recordMetric("Uniform calls skipped", uniformsAfter.skipped - uniformsBefore.skipped,
+                                   MetricType::GAUGE);
+    if (frames > 0) {
+        const GLStateStatistics &stateAfter = GLStateCache::getInstance().getStatistics();
+        metricsCollector->recordMetric("GL state calls issued per frame",
+                                       static_cast<double>(stateAfter.issued - stateBefore.issued) / frames,
+                                       MetricType::GAUGE);
+        metricsCollector->recordMetric("GL state calls filtered per frame",
+                                       static_cast<double>(stateAfter.filtered - stateBefore.filtered) / frames,
+                                       MetricType::GAUGE);
+    }
+    const TextureCacheStatistics &textureCacheAfter = TextureCache::getInstance().getStatistics();
+    uint64_t textureCacheHits = textureCacheAfter.hits - textureCacheBefore.hits;
+    uint64_t textureCacheMisses = textureCacheAfter.misses - textureCacheBefore.misses;
+    if (textureCacheHits + textureCacheMisses > 0) {
+        // Only tasks that load textures through the cache report it.
+        metricsCollector->recordMetric("Texture cache hits", textureCacheHits, MetricType::GAUGE);
+        metricsCollector->recordMetric("Texture cache misses", textureCacheMisses, MetricType::GAUGE);
+        metricsCollector->recordMetric("Texture cache evictions",
+                                       textureCacheAfter.evictions - textureCacheBefore.evictions, MetricType::GAUGE);
+        metricsCollector->recordMetric("Texture cache hit rate (%)",
+                                       100.0 * textureCacheHits / (textureCacheHits + textureCacheMisses),
+                                       MetricType::GAUGE);
+        metricsCollector->recordMetric("Texture cache loaded (MB)",
+                                       (textureCacheAfter.bytesLoaded - textureCacheBefore.bytesLoaded) /
+                                           (1024.0 * 1024.0),
+                                       MetricType::GAUGE);
+    }
+    metricsCollector->recordMetric("Jank spikes", flightRecorder.getSpikeCount(), MetricType::GAUGE);
+    metricsCollector->recordMetric("Log messages dropped",
+                                   LoggerConfig::getDroppedMessages() - droppedLogMessagesBefore, MetricType::GAUGE);
+    for (const auto &taskMetric : task->getTaskMetrics()) {
+        for (double value : taskMetric.second) {
+            metricsCollector->recordMetric(taskMetric.first, value, MetricType::DISTRIBUTION);
+        }
+    }
+    metricsCollector->finishTask(reportName, scored);
+    {
+        TraceScope teardownScope("teardown", "task");
+        task->teardown();
+    }
+    if (traceName) {
+        tracer.record(traceName, "task", taskTraceStart, tracer.now());
+    }
     logInfo("Benchmark run completed.");
-    metricsCollector->createBenchmarkReport(task->getName());
 }
 
-void BenchmarkEngine::runBenchmarks() {
+bool BenchmarkEngine::runBenchmarks() {
     ConfigurationManager &configManager = ConfigurationManager::getInstance();
     int benchmarkDuration = std::stoi(configManager.getValue("benchmark_duration"));
+    std::string stateCacheMode = configManager.getValue("state_cache");
+    GLStateCache &stateCache = GLStateCache::getInstance();
+    int scoredTasks = 0;
     for (const auto &task : tasks) {
         if (task) {
-            runBenchmark(task, benchmarkDuration);
+            stateCache.setEnabled(stateCacheMode != "off");
+            runBenchmark(task, benchmarkDuration, task->getName(), task->isScored());
+            if (task->isScored()) {
+                ++scoredTasks;
+            }
+            if (stateCacheMode == "compare") {
+                // The unfiltered rerun is reported separately and does not count towards the score.
+                stateCache.setEnabled(false);
+                runBenchmark(task, benchmarkDuration, task->getName() + " (state cache off)", false);
+            }
         }
     }
 
-    metricsCollector->createReport(tasks.size());
+    // The report waits for the finalizer thread, so the trace is written once no span is still being recorded.
+    bool reportCreated = metricsCollector->createReport(scoredTasks);
+
+    std::string traceFile = configManager.getValue("trace_file");
+    if (traceFile != "none") {
+        Tracer::getInstance().writeChromeTrace(traceFile);
+    }
+    return reportCreated;
 }
 
 void BenchmarkEngine::cleanup() {
+    ShaderManager::getInstance().clearShaderCache();
+    TextureCache::getInstance().clear();
     if (graphicsContext) {
         graphicsContext->cleanup();
     }
@@ -183,6 +421,8 @@ void BenchmarkEngine::cleanup() {
 
 void BenchmarkEngine::createRenderTasks() {
     logTrace("Creating RenderTasks.");
+    std::string specializationMode = ConfigurationManager::getInstance().getValue("shader_specialization");
+    bool specialized = specializationMode == "on";
 
     std::shared_ptr<RenderTask> clearTask = std::make_shared<ClearTask>("Clear");
     addTask(clearTask);
@@ -193,9 +433,44 @@ void BenchmarkEngine::createRenderTasks() {
     std::shared_ptr<RenderTask> cellularTask = std::make_shared<Cellular>("Cellular");
     addTask(cellularTask);
 
-    std::shared_ptr<RenderTask> cubeTask3 = std::make_shared<Cube>("Cube-AA1", 1);
+    std::shared_ptr<RenderTask> cubeTask3 = std::make_shared<Cube>("Cube-AA1", 1, 128, specialized);
     addTask(cubeTask3);
 
-    std::shared_ptr<RenderTask> cubeTask4 = std::make_shared<Cube>("Cube-AA2", 2);
+    std::shared_ptr<RenderTask> cubeTask4 = std::make_shared<Cube>("Cube-AA2", 2, 128, specialized);
     addTask(cubeTask4);
+
+    if (specializationMode == "compare") {
+        // Same parameters baked into the shader, reported next to the uniform-driven tasks.
+        addTask(std::make_shared<Cube>("Cube-AA1 (specialized)", 1, 128, true, false));
+        addTask(std::make_shared<Cube>("Cube-AA2 (specialized)", 2, 128, true, false));
+    }
+
+    std::shared_ptr<RenderTask> shaderCompileTask = std::make_shared<ShaderCompile>("ShaderCompile");
+    addTask(shaderCompileTask);
+
+    std::string asyncLoadingMode = ConfigurationManager::getInstance().getValue("async_texture_loading");
+    std::shared_ptr<RenderTask> textureUploadTask =
+        std::make_shared<TextureUpload>("TextureUpload", asyncLoadingMode == "on");
+    addTask(textureUploadTask);
+
+    if (asyncLoadingMode == "compare") {
+        addTask(std::make_shared<TextureUpload>("TextureUpload (async)", true));
+    }
+
+    std::string mipmapMode = ConfigurationManager::getInstance().getValue("mipmap_generation");
+    MipmapGeneration mipmaps = MipmapGeneration::NONE;
+    if (mipmapMode == "cpu") {
+        mipmaps = MipmapGeneration::CPU;
+    } else if (mipmapMode == "gpu") {
+        mipmaps = MipmapGeneration::GPU;
+    }
+    addTask(std::make_shared<ThumbnailDecode>("ThumbnailDecode", true, mipmaps));
+    addTask(std::make_shared<ThumbnailDecode>("ThumbnailDecode (full size)", false, mipmaps));
+
+    std::shared_ptr<RenderTask> catalogScrollTask = std::make_shared<CatalogScroll>("CatalogScroll");
+    addTask(catalogScrollTask);
+
+    addTask(std::make_shared<TextureSampling>("TextureSampling-RGBA8", TextureSampling::Format::RGBA8));
+    addTask(std::make_shared<TextureSampling>("TextureSampling-RGB565", TextureSampling::Format::RGB565));
+    addTask(std::make_shared<TextureSampling>("TextureSampling-ETC1", TextureSampling::Format::ETC1));
 }
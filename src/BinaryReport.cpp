@@ -0,0 +1,399 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "BinaryReport.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace BinaryReport;
+
+namespace {
+
+void appendVarint(std::vector<uint8_t> &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t zigzagEncode(int64_t value) { return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); }
+
+int64_t zigzagDecode(uint64_t value) { return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1); }
+
+/**
+ * Bounds-checked cursor over the mapped file.
+ */
+struct Cursor {
+    const uint8_t *pos;
+    const uint8_t *end;
+
+    bool readByte(uint8_t &value) {
+        if (pos >= end) {
+            return false;
+        }
+        value = *pos++;
+        return true;
+    }
+
+    bool readVarint(uint64_t &value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte;
+            if (!readByte(byte)) {
+                return false;
+            }
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool readString(std::string &value) {
+        uint64_t length;
+        if (!readVarint(length) || length > static_cast<uint64_t>(end - pos)) {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char *>(pos), length);
+        pos += length;
+        return true;
+    }
+
+    bool readEntries(std::map<std::string, std::string> &entries) {
+        uint64_t count;
+        if (!readVarint(count)) {
+            return false;
+        }
+        for (uint64_t i = 0; i < count; ++i) {
+            std::string key, value;
+            if (!readString(key) || !readString(value)) {
+                return false;
+            }
+            entries[key] = value;
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+BufferedFileWriter::BufferedFileWriter(size_t capacity) : fd(-1), buffer(capacity), used(0), failed(false) {}
+
+BufferedFileWriter::~BufferedFileWriter() { close(); }
+
+bool BufferedFileWriter::open(const std::string &filePath) {
+    close();
+    fd = ::open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        logError("Failed to open file for writing: " + filePath);
+        return false;
+    }
+    used = 0;
+    failed = false;
+    return true;
+}
+
+void BufferedFileWriter::close() {
+    if (fd >= 0) {
+        flush();
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+bool BufferedFileWriter::flush() {
+    size_t offset = 0;
+    while (fd >= 0 && offset < used) {
+        ssize_t written = ::write(fd, buffer.data() + offset, used - offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            failed = true;
+            break;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    used = 0;
+    return !failed;
+}
+
+void BufferedFileWriter::write(const void *data, size_t size) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    while (size > 0) {
+        if (used == buffer.size()) {
+            flush();
+        }
+        size_t chunk = std::min(size, buffer.size() - used);
+        std::memcpy(buffer.data() + used, bytes, chunk);
+        used += chunk;
+        bytes += chunk;
+        size -= chunk;
+    }
+}
+
+void BufferedFileWriter::writeByte(uint8_t value) {
+    if (used == buffer.size()) {
+        flush();
+    }
+    buffer[used++] = value;
+}
+
+void BufferedFileWriter::writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+        writeByte(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    writeByte(static_cast<uint8_t>(value));
+}
+
+void BufferedFileWriter::writeString(const std::string &value) {
+    writeVarint(value.size());
+    write(value.data(), value.size());
+}
+
+bool BinaryReportWriter::open(const std::string &filePath, const std::map<std::string, std::string> &environment,
+                              const std::map<std::string, std::string> &configuration) {
+    if (!writer.open(filePath)) {
+        return false;
+    }
+    writer.write(MAGIC, sizeof(MAGIC));
+    writer.writeByte(VERSION);
+    writeSection(SectionTag::ENVIRONMENT, environment);
+    writeSection(SectionTag::CONFIGURATION, configuration);
+    logDebug("Binary report opened: " + filePath);
+    return writer.flush();
+}
+
+void BinaryReportWriter::writeSection(SectionTag tag, const std::map<std::string, std::string> &entries) {
+    writer.writeByte(static_cast<uint8_t>(tag));
+    writer.writeVarint(entries.size());
+    for (const auto &entry : entries) {
+        writer.writeString(entry.first);
+        writer.writeString(entry.second);
+    }
+}
+
+void BinaryReportWriter::beginTask(const std::string &taskName, bool scored, size_t columnCount) {
+    writer.writeByte(static_cast<uint8_t>(SectionTag::TASK));
+    writer.writeString(taskName);
+    writer.writeByte(scored ? 1 : 0);
+    writer.writeVarint(columnCount);
+}
+
+void BinaryReportWriter::writeColumn(const std::string &name, ColumnEncoding encoding, uint8_t metricType,
+                                     size_t count) {
+    writer.writeString(name);
+    writer.writeByte(static_cast<uint8_t>(encoding));
+    writer.writeByte(metricType);
+    writer.writeVarint(count);
+    writer.writeVarint(scratch.size());
+    writer.write(scratch.data(), scratch.size());
+}
+
+void BinaryReportWriter::writeTimestampColumn(const std::string &name, const std::vector<uint64_t> &values) {
+    scratch.clear();
+    uint64_t previous = 0;
+    for (uint64_t value : values) {
+        appendVarint(scratch, zigzagEncode(static_cast<int64_t>(value - previous)));
+        previous = value;
+    }
+    writeColumn(name, ColumnEncoding::DELTA_VARINT, 0, values.size());
+}
+
+void BinaryReportWriter::writeFloatColumn(const std::string &name, uint8_t metricType,
+                                          const std::vector<double> &values) {
+    scratch.resize(values.size() * sizeof(uint32_t));
+    uint8_t *out = scratch.data();
+    for (double value : values) {
+        float f = static_cast<float>(value);
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        *out++ = static_cast<uint8_t>(bits);
+        *out++ = static_cast<uint8_t>(bits >> 8);
+        *out++ = static_cast<uint8_t>(bits >> 16);
+        *out++ = static_cast<uint8_t>(bits >> 24);
+    }
+    writeColumn(name, ColumnEncoding::FLOAT32, metricType, values.size());
+}
+
+bool BinaryReportWriter::endTask() { return writer.flush(); }
+
+bool BinaryReportWriter::close() {
+    if (!writer.isOpen()) {
+        return false;
+    }
+    writer.writeByte(static_cast<uint8_t>(SectionTag::END));
+    bool ok = writer.flush();
+    writer.close();
+    return ok;
+}
+
+BinaryReportReader::BinaryReportReader() : data(nullptr), size(0) {}
+
+BinaryReportReader::~BinaryReportReader() { close(); }
+
+bool BinaryReportReader::open(const std::string &filePath) {
+    close();
+
+    int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        logError("Failed to open binary report: " + filePath);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(MAGIC) + 1)) {
+        logError("Binary report is empty or unreadable: " + filePath);
+        ::close(fd);
+        return false;
+    }
+
+    void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        logError("Failed to map binary report: " + filePath);
+        return false;
+    }
+    data = static_cast<const uint8_t *>(mapping);
+    size = static_cast<size_t>(st.st_size);
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    uint8_t version = data[sizeof(MAGIC)];
+    if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || version < 1 || version > VERSION) {
+        logError("Not a Valyria binary report or unsupported version: " + filePath);
+        close();
+        return false;
+    }
+
+    Cursor cursor{data + sizeof(MAGIC) + 1, data + size};
+    uint8_t tag;
+    while (cursor.readByte(tag)) {
+        if (tag == static_cast<uint8_t>(SectionTag::END)) {
+            return true;
+        }
+
+        bool ok = true;
+        if (tag == static_cast<uint8_t>(SectionTag::ENVIRONMENT)) {
+            ok = cursor.readEntries(environment);
+        } else if (tag == static_cast<uint8_t>(SectionTag::CONFIGURATION)) {
+            ok = cursor.readEntries(configuration);
+        } else if (tag == static_cast<uint8_t>(SectionTag::TASK)) {
+            BinaryTaskView task;
+            uint64_t columnCount = 0;
+            uint8_t scored = 1;
+            ok = cursor.readString(task.name) && (version < 2 || cursor.readByte(scored)) &&
+                 cursor.readVarint(columnCount);
+            task.scored = scored != 0;
+            for (uint64_t i = 0; ok && i < columnCount; ++i) {
+                BinaryColumnView column;
+                uint8_t encoding = 0;
+                uint64_t payloadSize = 0;
+                ok = cursor.readString(column.name) && cursor.readByte(encoding) &&
+                     cursor.readByte(column.metricType) && cursor.readVarint(column.count) &&
+                     cursor.readVarint(payloadSize) && payloadSize <= static_cast<uint64_t>(cursor.end - cursor.pos);
+                if (ok) {
+                    column.encoding = static_cast<ColumnEncoding>(encoding);
+                    column.payload = cursor.pos;
+                    column.payloadSize = static_cast<size_t>(payloadSize);
+                    cursor.pos += payloadSize;
+                    task.columns.push_back(column);
+                }
+            }
+            if (ok) {
+                tasks.push_back(std::move(task));
+            }
+        } else {
+            logError("Unknown section tag in binary report: " + std::to_string(tag));
+            ok = false;
+        }
+
+        if (!ok) {
+            logWarn("Binary report is truncated; ignoring the incomplete trailing section.");
+            return true;
+        }
+    }
+
+    logWarn("Binary report has no end marker; the run may have been interrupted.");
+    return true;
+}
+
+void BinaryReportReader::close() {
+    if (data) {
+        munmap(const_cast<uint8_t *>(data), size);
+        data = nullptr;
+        size = 0;
+    }
+    environment.clear();
+    configuration.clear();
+    tasks.clear();
+}
+
+bool BinaryReportReader::decodeColumn(const BinaryColumnView &column, std::vector<double> &values) {
+    values.clear();
+
+    if (column.encoding == ColumnEncoding::FLOAT32) {
+        // Validate the count against the payload before reserving, so a corrupt count cannot
+        // trigger a huge allocation.
+        if (column.count > column.payloadSize / sizeof(uint32_t) ||
+            column.payloadSize != column.count * sizeof(uint32_t)) {
+            return false;
+        }
+        values.reserve(column.count);
+        const uint8_t *in = column.payload;
+        for (uint64_t i = 0; i < column.count; ++i, in += 4) {
+            uint32_t bits = static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+                            (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            values.push_back(value);
+        }
+        return true;
+    }
+
+    if (column.encoding == ColumnEncoding::DELTA_VARINT) {
+        // Every varint takes at least one byte.
+        if (column.count > column.payloadSize) {
+            return false;
+        }
+        values.reserve(column.count);
+        Cursor cursor{column.payload, column.payload + column.payloadSize};
+        int64_t current = 0;
+        for (uint64_t i = 0; i < column.count; ++i) {
+            uint64_t delta;
+            if (!cursor.readVarint(delta)) {
+                return false;
+            }
+            current += zigzagDecode(delta);
+            values.push_back(static_cast<double>(current));
+        }
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,394 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "FleetAggregator.h"
+#include "HTMLReportGenerator.h"
+#include "Logger.h"
+#include "Statistics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include <cjson/cJSON.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/**
+ * Matches the JSON reports written by a run, `valyria_report*.json`. The `valyria_report.vbr.json` files written
+ * next to binary reports by `valyria-convert` repeat the run's own JSON report and are skipped.
+ */
+bool isRunReport(const fs::path &path) {
+    const std::string fileName = path.filename().string();
+    const std::string prefix = "valyria_report";
+    const std::string converted = ".vbr.json";
+    return path.extension() == ".json" && fileName.compare(0, prefix.size(), prefix) == 0 &&
+           !(fileName.size() >= converted.size() &&
+             fileName.compare(fileName.size() - converted.size(), converted.size(), converted) == 0);
+}
+
+bool readFile(const std::string &filePath, std::string &contents) {
+    int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0;
+    if (ok) {
+        contents.resize(static_cast<size_t>(st.st_size));
+        size_t offset = 0;
+        while (offset < contents.size()) {
+            ssize_t bytes = ::read(fd, &contents[offset], contents.size() - offset);
+            if (bytes <= 0) {
+                ok = false;
+                break;
+            }
+            offset += static_cast<size_t>(bytes);
+        }
+    }
+    ::close(fd);
+    return ok;
+}
+
+std::string stringField(const cJSON *object, const char *name) {
+    cJSON *item = cJSON_GetObjectItem(object, name);
+    return item && cJSON_IsString(item) ? item->valuestring : "Unknown";
+}
+
+double numberField(const cJSON *object, const char *name) {
+    cJSON *item = cJSON_GetObjectItem(object, name);
+    if (!item) {
+        return 0.0;
+    }
+    return cJSON_IsString(item) ? std::strtod(item->valuestring, nullptr) : item->valuedouble;
+}
+
+std::string csvField(const std::string &value) {
+    std::string quoted = "\"";
+    for (char c : value) {
+        quoted += c;
+        if (c == '"') {
+            quoted += '"';
+        }
+    }
+    return quoted + "\"";
+}
+
+} // namespace
+
+bool FleetAggregator::parseReport(const std::string &filePath, ReportSummary &summary) {
+    std::string contents;
+    if (!readFile(filePath, contents)) {
+        return false;
+    }
+
+    cJSON *report = cJSON_ParseWithLength(contents.data(), contents.size());
+    if (!report) {
+        return false;
+    }
+
+    cJSON *environment = cJSON_GetObjectItem(report, "Environment");
+    cJSON *results = cJSON_GetObjectItem(report, "Benchmark Results");
+    if (!environment || !results) {
+        cJSON_Delete(report);
+        return false;
+    }
+
+    summary.filePath = filePath;
+    summary.deviceName = stringField(environment, "Device Name");
+    summary.imageName = stringField(environment, "Image Name");
+    summary.renderer = stringField(environment, "OpenGL Renderer");
+    summary.timestamp = stringField(environment, "Timestamp");
+    summary.score = numberField(report, "Score");
+
+    cJSON *task = nullptr;
+    cJSON_ArrayForEach(task, results) {
+        cJSON *fps = cJSON_GetObjectItem(task, "FPS");
+        if (fps) {
+            summary.taskFPS[task->string] = numberField(fps, "average");
+        }
+    }
+
+    cJSON_Delete(report);
+    return true;
+}
+
+size_t FleetAggregator::ingest(const std::string &rootDir, unsigned threads) {
+    std::vector<std::string> files;
+    std::error_code error;
+    for (fs::recursive_directory_iterator it(rootDir, fs::directory_options::skip_permission_denied, error), end;
+         !error && it != end; it.increment(error)) {
+        if (it->is_regular_file(error) && isRunReport(it->path())) {
+            files.push_back(it->path().string());
+        }
+    }
+    if (error) {
+        logWarn("Error while scanning " + rootDir + ": " + error.message());
+    }
+    std::sort(files.begin(), files.end());
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min<unsigned>(threads, std::max<size_t>(files.size(), 1));
+    logInfo("Parsing " + std::to_string(files.size()) + " reports with " + std::to_string(threads) + " threads.");
+
+    // Each worker claims the next file index; results land in per-file slots to keep the output deterministic.
+    std::vector<ReportSummary> parsed(files.size());
+    std::vector<char> valid(files.size(), 0);
+    std::atomic<size_t> nextFile(0);
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back([&]() {
+            for (size_t index = nextFile++; index < files.size(); index = nextFile++) {
+                valid[index] = parseReport(files[index], parsed[index]);
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    size_t before = reports.size();
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (valid[i]) {
+            reports.push_back(std::move(parsed[i]));
+        } else {
+            logWarn("Skipping unreadable or non-Valyria report: " + files[i]);
+        }
+    }
+
+    groups.clear();
+    for (const auto &report : reports) {
+        groups[GroupKey(report.deviceName, report.imageName, report.renderer)].push_back(&report);
+    }
+    return reports.size() - before;
+}
+
+Distribution FleetAggregator::distribution(std::vector<double> values) {
+    Distribution result;
+    if (values.empty()) {
+        return result;
+    }
+
+    SummaryStatistics stats = Statistics::summarize(values);
+    result.count = values.size();
+    result.mean = stats.average;
+    result.stdDev = stats.stdDev;
+    result.minimum = stats.minimum;
+    result.maximum = stats.maximum;
+    result.p5 = Statistics::percentile(values, 5.0);
+    result.median = Statistics::percentile(values, 50.0);
+    result.p95 = Statistics::percentile(std::move(values), 95.0);
+    return result;
+}
+
+std::vector<std::string> FleetAggregator::taskNames() const {
+    std::vector<std::string> names;
+    for (const auto &report : reports) {
+        for (const auto &task : report.taskFPS) {
+            if (std::find(names.begin(), names.end(), task.first) == names.end()) {
+                names.push_back(task.first);
+            }
+        }
+    }
+    return names;
+}
+
+std::vector<FleetAggregator::TrendRow> FleetAggregator::trends() const {
+    std::vector<TrendRow> rows;
+
+    for (const auto &group : groups) {
+        TrendRow row;
+        row.device = std::get<0>(group.first);
+        row.imageName = std::get<1>(group.first);
+        row.renderer = std::get<2>(group.first);
+        row.reports = group.second.size();
+        row.firstSeen = group.second.front()->timestamp;
+
+        std::vector<double> scores;
+        std::map<std::string, std::vector<double>> fps;
+        for (const ReportSummary *report : group.second) {
+            row.firstSeen = std::min(row.firstSeen, report->timestamp);
+            scores.push_back(report->score);
+            for (const auto &task : report->taskFPS) {
+                fps[task.first].push_back(task.second);
+            }
+        }
+        row.medianScore = Statistics::median(std::move(scores));
+        for (auto &task : fps) {
+            row.medianTaskFPS[task.first] = Statistics::median(std::move(task.second));
+        }
+        rows.push_back(std::move(row));
+    }
+
+    // Group rows per device and renderer, then order firmware images chronologically.
+    std::sort(rows.begin(), rows.end(), [](const TrendRow &a, const TrendRow &b) {
+        return std::tie(a.device, a.renderer, a.firstSeen, a.imageName) <
+               std::tie(b.device, b.renderer, b.firstSeen, b.imageName);
+    });
+    return rows;
+}
+
+bool FleetAggregator::writeDistributionsCSV(const std::string &filePath) const {
+    std::ofstream out(filePath);
+    if (!out.is_open()) {
+        logError("Failed to open output file: " + filePath);
+        return false;
+    }
+
+    out << "device,image,renderer,metric,count,mean,std_dev,min,p5,median,p95,max\n";
+    std::vector<std::string> tasks = taskNames();
+    for (const auto &group : groups) {
+        std::vector<std::pair<std::string, std::vector<double>>> series;
+        series.emplace_back("Score", std::vector<double>());
+        for (const auto &task : tasks) {
+            series.emplace_back(task + " FPS", std::vector<double>());
+        }
+        for (const ReportSummary *report : group.second) {
+            series[0].second.push_back(report->score);
+            for (size_t i = 0; i < tasks.size(); ++i) {
+                auto it = report->taskFPS.find(tasks[i]);
+                if (it != report->taskFPS.end()) {
+                    series[i + 1].second.push_back(it->second);
+                }
+            }
+        }
+
+        for (auto &entry : series) {
+            if (entry.second.empty()) {
+                continue;
+            }
+            Distribution d = distribution(std::move(entry.second));
+            out << csvField(std::get<0>(group.first)) << ',' << csvField(std::get<1>(group.first)) << ','
+                << csvField(std::get<2>(group.first)) << ',' << csvField(entry.first) << ',' << d.count << ','
+                << d.mean << ',' << d.stdDev << ',' << d.minimum << ',' << d.p5 << ',' << d.median << ',' << d.p95
+                << ',' << d.maximum << '\n';
+        }
+    }
+    return out.good();
+}
+
+bool FleetAggregator::writeTrendsCSV(const std::string &filePath) const {
+    std::ofstream out(filePath);
+    if (!out.is_open()) {
+        logError("Failed to open output file: " + filePath);
+        return false;
+    }
+
+    std::vector<std::string> tasks = taskNames();
+    out << "device,renderer,image,first_seen,reports,median_score";
+    for (const auto &task : tasks) {
+        out << ',' << csvField(task + " median FPS");
+    }
+    out << '\n';
+
+    for (const auto &row : trends()) {
+        out << csvField(row.device) << ',' << csvField(row.renderer) << ',' << csvField(row.imageName) << ','
+            << csvField(row.firstSeen) << ',' << row.reports << ',' << row.medianScore;
+        for (const auto &task : tasks) {
+            auto it = row.medianTaskFPS.find(task);
+            out << ',';
+            if (it != row.medianTaskFPS.end()) {
+                out << it->second;
+            }
+        }
+        out << '\n';
+    }
+    return out.good();
+}
+
+bool FleetAggregator::writeHTML(const std::string &filePath) const {
+    std::ofstream out(filePath);
+    if (!out.is_open()) {
+        logError("Failed to open output file: " + filePath);
+        return false;
+    }
+
+    out << R"(<!DOCTYPE html>
+<html lang="en">
+<head>
+    <meta charset="UTF-8">
+    <title>Valyria Fleet Report</title>
+    <style>
+        body { font-family: Arial, sans-serif; font-size: 14px; padding: 20px; background-color: #f4f4f9; color: #333; }
+        table { border-collapse: collapse; background: #fff; margin-bottom: 24px; }
+        th, td { padding: 6px 10px; border: 1px solid #dee2e6; }
+        th { text-align: left; background: #e9ecef; }
+        td.num { text-align: right; }
+        tbody tr:nth-of-type(odd) { background-color: rgba(0,0,0,.05); }
+    </style>
+</head>
+<body>
+<h1>Valyria Fleet Report</h1>
+<p>)" << reports.size()
+        << " reports in " << groups.size() << R"( device/firmware/renderer groups.</p>
+<h2>Score Distribution</h2>
+<table><thead><tr><th>Device</th><th>Image</th><th>Renderer</th><th>Reports</th><th>Mean</th><th>StdDev</th><th>Min</th><th>P5</th><th>Median</th><th>P95</th><th>Max</th></tr></thead><tbody>
+)";
+
+    for (const auto &group : groups) {
+        std::vector<double> scores;
+        for (const ReportSummary *report : group.second) {
+            scores.push_back(report->score);
+        }
+        Distribution d = distribution(std::move(scores));
+        out << "<tr><td>" << HTMLReportGenerator::escapeHTML(std::get<0>(group.first)) << "</td><td>"
+            << HTMLReportGenerator::escapeHTML(std::get<1>(group.first)) << "</td><td>"
+            << HTMLReportGenerator::escapeHTML(std::get<2>(group.first)) << "</td><td class='num'>" << d.count
+            << "</td>";
+        for (double value : {d.mean, d.stdDev, d.minimum, d.p5, d.median, d.p95, d.maximum}) {
+            out << "<td class='num'>" << Statistics::formatTwoDecimals(value) << "</td>";
+        }
+        out << "</tr>\n";
+    }
+    out << "</tbody></table>\n";
+
+    std::vector<std::string> tasks = taskNames();
+    out << "<h2>Firmware Trends</h2>\n<table><thead><tr><th>Device</th><th>Renderer</th><th>Image</th>"
+           "<th>First seen</th><th>Reports</th><th>Median score</th>";
+    for (const auto &task : tasks) {
+        out << "<th>" << HTMLReportGenerator::escapeHTML(task) << " FPS</th>";
+    }
+    out << "</tr></thead><tbody>\n";
+    for (const auto &row : trends()) {
+        out << "<tr><td>" << HTMLReportGenerator::escapeHTML(row.device) << "</td><td>"
+            << HTMLReportGenerator::escapeHTML(row.renderer) << "</td><td>"
+            << HTMLReportGenerator::escapeHTML(row.imageName) << "</td><td>"
+            << HTMLReportGenerator::escapeHTML(row.firstSeen) << "</td><td class='num'>" << row.reports
+            << "</td><td class='num'>" << Statistics::formatTwoDecimals(row.medianScore) << "</td>";
+        for (const auto &task : tasks) {
+            auto it = row.medianTaskFPS.find(task);
+            out << "<td class='num'>"
+                << (it != row.medianTaskFPS.end() ? Statistics::formatTwoDecimals(it->second) : "") << "</td>";
+        }
+        out << "</tr>\n";
+    }
+    out << "</tbody></table>\n</body>\n</html>\n";
+    return out.good();
+}
@@ -0,0 +1,101 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "FlightRecorder.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+FlightRecorder::FlightRecorder()
+    : nextRecord(0), lastSnapshotRecord(0), spikes(0), snapshots(0), thresholdMs(0.0), renderThreadId(0),
+      voluntarySwitches(0), involuntarySwitches(0) {}
+
+void FlightRecorder::configure(size_t historyFrames, double threshold) {
+    history.assign(historyFrames, FrameRecord{});
+    thresholdMs = threshold;
+    logDebug("Flight recorder: " + std::to_string(historyFrames) + " frames, jank threshold " +
+             std::to_string(thresholdMs) + " ms.");
+}
+
+void FlightRecorder::beginTask() {
+    nextRecord = 0;
+    lastSnapshotRecord = 0;
+    spikes = 0;
+    snapshots = 0;
+    renderThreadId = syscall(SYS_gettid);
+    if (!readContextSwitches(voluntarySwitches, involuntarySwitches)) {
+        voluntarySwitches = 0;
+        involuntarySwitches = 0;
+    }
+}
+
+JankSpike FlightRecorder::snapshot() {
+    JankSpike spike;
+    size_t count = static_cast<size_t>(std::min<uint64_t>(nextRecord, history.size()));
+    if (count == 0) {
+        return spike;
+    }
+
+    spike.history.reserve(count);
+    for (uint64_t record = nextRecord - count; record < nextRecord; ++record) {
+        spike.history.push_back(history[record % history.size()]);
+    }
+    spike.spikeFrame = spike.history.back();
+
+    uint64_t voluntary = 0;
+    uint64_t involuntary = 0;
+    if (readContextSwitches(voluntary, involuntary)) {
+        spike.voluntaryContextSwitches = voluntary - voluntarySwitches;
+        spike.involuntaryContextSwitches = involuntary - involuntarySwitches;
+        voluntarySwitches = voluntary;
+        involuntarySwitches = involuntary;
+    }
+
+    std::ifstream loadAverageFile("/proc/loadavg");
+    if (!std::getline(loadAverageFile, spike.loadAverage)) {
+        spike.loadAverage = "Unknown";
+    }
+
+    lastSnapshotRecord = nextRecord;
+    ++snapshots;
+    return spike;
+}
+
+bool FlightRecorder::readContextSwitches(uint64_t &voluntary, uint64_t &involuntary) const {
+    std::ifstream statusFile("/proc/self/task/" + std::to_string(renderThreadId) + "/status");
+    if (!statusFile.is_open()) {
+        return false;
+    }
+
+    int found = 0;
+    std::string key;
+    while (statusFile >> key) {
+        if (key == "voluntary_ctxt_switches:") {
+            statusFile >> voluntary;
+            ++found;
+        } else if (key == "nonvoluntary_ctxt_switches:") {
+            statusFile >> involuntary;
+            ++found;
+        }
+    }
+    return found == 2;
+}
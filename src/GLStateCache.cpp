@@ -0,0 +1,206 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "GLStateCache.h"
+#include "Logger.h"
+
+GLStateCache &GLStateCache::getInstance() {
+    static GLStateCache instance;
+    return instance;
+}
+
+GLStateCache::GLStateCache() : enabled(true), attribKnownMask(0), attribEnabledMask(0) { invalidate(); }
+
+void GLStateCache::setEnabled(bool enable) {
+    enabled = enable;
+    invalidate();
+    logDebug(std::string("GL state cache ") + (enabled ? "enabled." : "disabled."));
+}
+
+void GLStateCache::invalidate() {
+    programKnown = false;
+    program = 0;
+    arrayBufferKnown = false;
+    arrayBuffer = 0;
+    activeTextureKnown = false;
+    activeTextureUnit = GL_TEXTURE0;
+    for (int i = 0; i < MAX_TEXTURE_UNITS; ++i) {
+        textureKnown[i] = false;
+        boundTextures[i] = 0;
+    }
+    // Arrays enabled through the cache are disabled rather than forgotten: a task that does not use an
+    // attribute must not inherit another task's array, which may point at client memory it has freed.
+    for (int index = 0; index < MAX_VERTEX_ATTRIBS; ++index) {
+        if (attribEnabledMask & (1u << index)) {
+            glDisableVertexAttribArray(index);
+            ++statistics.issued;
+        }
+    }
+    attribKnownMask = attribEnabledMask;
+    attribEnabledMask = 0;
+    viewportKnown = false;
+    blendKnown = false;
+    blendEnabled = false;
+    blendFuncKnown = false;
+    clearColorKnown = false;
+}
+
+bool GLStateCache::shouldIssue(bool changed) {
+    if (enabled && !changed) {
+        ++statistics.filtered;
+        return false;
+    }
+    ++statistics.issued;
+    return true;
+}
+
+void GLStateCache::useProgram(GLuint newProgram) {
+    if (shouldIssue(!programKnown || program != newProgram)) {
+        glUseProgram(newProgram);
+        programKnown = true;
+        program = newProgram;
+    }
+}
+
+void GLStateCache::bindArrayBuffer(GLuint buffer) {
+    if (shouldIssue(!arrayBufferKnown || arrayBuffer != buffer)) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        arrayBufferKnown = true;
+        arrayBuffer = buffer;
+    }
+}
+
+void GLStateCache::activeTexture(GLenum unit) {
+    if (shouldIssue(!activeTextureKnown || activeTextureUnit != unit)) {
+        glActiveTexture(unit);
+        activeTextureKnown = true;
+        activeTextureUnit = unit;
+    }
+}
+
+void GLStateCache::bindTexture(GLenum target, GLuint texture) {
+    int unit = static_cast<int>(activeTextureUnit - GL_TEXTURE0);
+    if (target != GL_TEXTURE_2D || !activeTextureKnown || unit < 0 || unit >= MAX_TEXTURE_UNITS) {
+        // Only 2D textures on units selected through the cache are tracked.
+        ++statistics.issued;
+        glBindTexture(target, texture);
+        return;
+    }
+
+    if (shouldIssue(!textureKnown[unit] || boundTextures[unit] != texture)) {
+        glBindTexture(target, texture);
+        textureKnown[unit] = true;
+        boundTextures[unit] = texture;
+    }
+}
+
+void GLStateCache::setVertexAttribArrays(uint32_t mask) {
+    for (int index = 0; index < MAX_VERTEX_ATTRIBS; ++index) {
+        uint32_t bit = 1u << index;
+        bool enable = (mask & bit) != 0;
+        bool known = (attribKnownMask & bit) != 0;
+        bool current = (attribEnabledMask & bit) != 0;
+        // Attributes that were never enabled through the cache are still disabled, as `invalidate`
+        // disables the ones that were.
+        if (!known && !enable) {
+            continue;
+        }
+        if (shouldIssue(!known || current != enable)) {
+            if (enable) {
+                glEnableVertexAttribArray(index);
+                attribEnabledMask |= bit;
+            } else {
+                glDisableVertexAttribArray(index);
+                attribEnabledMask &= ~bit;
+            }
+            attribKnownMask |= bit;
+        }
+    }
+}
+
+void GLStateCache::viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    bool changed = !viewportKnown || viewportRect[0] != x || viewportRect[1] != y || viewportRect[2] != width ||
+                   viewportRect[3] != height;
+    if (shouldIssue(changed)) {
+        glViewport(x, y, width, height);
+        viewportKnown = true;
+        viewportRect[0] = x;
+        viewportRect[1] = y;
+        viewportRect[2] = width;
+        viewportRect[3] = height;
+    }
+}
+
+void GLStateCache::setBlendEnabled(bool blend) {
+    if (shouldIssue(!blendKnown || blendEnabled != blend)) {
+        if (blend) {
+            glEnable(GL_BLEND);
+        } else {
+            glDisable(GL_BLEND);
+        }
+        blendKnown = true;
+        blendEnabled = blend;
+    }
+}
+
+void GLStateCache::blendFunc(GLenum sourceFactor, GLenum destinationFactor) {
+    bool changed = !blendFuncKnown || blendFactors[0] != sourceFactor || blendFactors[1] != destinationFactor;
+    if (shouldIssue(changed)) {
+        glBlendFunc(sourceFactor, destinationFactor);
+        blendFuncKnown = true;
+        blendFactors[0] = sourceFactor;
+        blendFactors[1] = destinationFactor;
+    }
+}
+
+void GLStateCache::clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+    bool changed = !clearColorKnown || clearColorValue[0] != red || clearColorValue[1] != green ||
+                   clearColorValue[2] != blue || clearColorValue[3] != alpha;
+    if (shouldIssue(changed)) {
+        glClearColor(red, green, blue, alpha);
+        clearColorKnown = true;
+        clearColorValue[0] = red;
+        clearColorValue[1] = green;
+        clearColorValue[2] = blue;
+        clearColorValue[3] = alpha;
+    }
+}
+
+void GLStateCache::deleteProgram(GLuint programID) {
+    glDeleteProgram(programID);
+    if (program == programID) {
+        programKnown = false;
+    }
+}
+
+void GLStateCache::deleteBuffer(GLuint buffer) {
+    glDeleteBuffers(1, &buffer);
+    if (arrayBuffer == buffer) {
+        arrayBuffer = 0;
+    }
+}
+
+void GLStateCache::deleteTexture(GLuint texture) {
+    glDeleteTextures(1, &texture);
+    for (int i = 0; i < MAX_TEXTURE_UNITS; ++i) {
+        if (boundTextures[i] == texture) {
+            boundTextures[i] = 0;
+        }
+    }
+}
@@ -21,6 +21,9 @@
 #include "ConfigurationManager.h"
 #include "Logger.h"
 
+#include <GLES2/gl2.h>
+#include <sstream>
+
 GraphicsContext::GraphicsContext() : context(nullptr), displayWidth(0), displayHeight(0) {}
 
 GraphicsContext::~GraphicsContext() { cleanup(); }
@@ -116,5 +119,20 @@ void GraphicsContext::logEssosError() {
 void GraphicsContext::updateDisplay() {
     EssContextUpdateDisplay(context);
     EssContextRunEventLoopOnce(context);
-    logTrace("Display updated and event loop run once.");
+    LOG_TRACE("Display updated and event loop run once.");
+}
+
+bool GraphicsContext::isExtensionSupported(const std::string &extension) {
+    const char *extensions = reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS));
+    if (!extensions) {
+        return false;
+    }
+    std::istringstream stream(extensions);
+    std::string name;
+    while (stream >> name) {
+        if (name == extension) {
+            return true;
+        }
+    }
+    return false;
 }
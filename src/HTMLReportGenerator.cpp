@@ -19,12 +19,31 @@
 
 #include "HTMLReportGenerator.h"
 #include "Logger.h"
+#include "Statistics.h"
 
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr int CHART_WIDTH = 240;
+constexpr int CHART_HEIGHT = 32;
+constexpr int BUDGET_BAR_WIDTH = 320;
+constexpr int BUDGET_BAR_HEIGHT = 16;
 
-HTMLReportGenerator::HTMLReportGenerator(const cJSON *jsonData, const std::string &filePath)
-    : jsonData(jsonData), filePath(filePath) {}
+/**
+ * The loop phases of the frame budget, in the order they are stacked, with their CSS classes.
+ */
+const std::pair<const char *, const char *> BUDGET_PHASES[] = {
+    {"Update", "phase-update"}, {"Render submit", "phase-render"}, {"Swap", "phase-swap"}, {"Sleep", "phase-sleep"}};
+} // namespace
+
+HTMLReportGenerator::HTMLReportGenerator(const cJSON *jsonData, const std::string &filePath, size_t maxChartPoints)
+    : jsonData(jsonData), filePath(filePath), maxChartPoints(maxChartPoints) {}
 
 void HTMLReportGenerator::generateReport() {
     logDebug("Generating the HTML report");
@@ -43,8 +62,10 @@ void HTMLReportGenerator::generateReport() {
     file << generateHeader(deviceName);
     file << generateEnvironmentSection(cJSON_GetObjectItem(jsonData, "Environment"));
     file << generateToolConfigSection(cJSON_GetObjectItem(jsonData, "Configuration"));
+    file << generateComparisonSection(cJSON_GetObjectItem(jsonData, "Baseline Comparison"));
+    file << generateFrameBudgetSection(cJSON_GetObjectItem(jsonData, "Frame Budget"));
+    file << generateJankSpikeSection(cJSON_GetObjectItem(jsonData, "Jank Spikes"));
     file << generateMetricsTabs(cJSON_GetObjectItem(jsonData, "Benchmark Results"));
-    file << generateSparklineJS();
     file << generateFooter();
     file.close();
     logDebug("HTML report is ready.");
@@ -58,18 +79,45 @@ std::string HTMLReportGenerator::generateHeader(const std::string &deviceName) c
 <head>
     <meta charset="UTF-8">
     <title>)" +
-           deviceName + R"( - Valyria Benchmark Report</title>
-    <link href="https://maxcdn.bootstrapcdn.com/bootstrap/4.5.2/css/bootstrap.min.css" rel="stylesheet">
+           escapeHTML(deviceName) + R"( - Valyria Benchmark Report</title>
     <style>
-        body { font-family: Arial, sans-serif; padding: 20px; background-color: #f4f4f9; color: #333; }
-        h1, h2 { color: #333; }
-        .table-striped tbody tr:nth-of-type(odd) { background-color: rgba(0,0,0,.05); }
-        .sparkline { width: 200px; height: 20px; }
-        .tooltip-custom{position:absolute;left:0;top:0;visibility:hidden;background:transparent;color:black;font:10px Arial,sans-serif;text-align:left;white-space:nowrap;padding:0;border:none;z-index:10000}
-        .tooltip-custom .jqsfield{color:black;font:10px Arial,sans-serif;text-align:left}
+        * { box-sizing: border-box; }
+        body { font-family: Arial, sans-serif; font-size: 14px; margin: 0; padding: 20px; background-color: #f4f4f9; color: #333; }
+        h1, h2, h3 { color: #333; margin: 0; }
+        .container-fluid { width: 100%; }
+        .row { display: flex; flex-wrap: wrap; margin: 0 -10px; }
+        .col-md-6 { flex: 1 1 480px; padding: 0 10px; }
+        .list-group { list-style: none; margin: 0; padding: 0; border: 1px solid #ddd; border-radius: 4px; background: #fff; }
+        .list-group-item { padding: 8px 12px; border-bottom: 1px solid #ddd; }
+        .list-group-item:last-child { border-bottom: none; }
+        .alert { margin-top: 16px; padding: 12px 16px; border-radius: 4px; background: #cce5ff; border: 1px solid #b8daff; color: #004085; }
+        details summary { cursor: pointer; color: #007bff; }
+        .extensions { font-size: 0.9em; margin-top: 6px; }
+        .extensions span { display: inline-block; margin-right: 5px; }
+        .mt-4 { margin-top: 24px; }
+        .tabs { display: flex; flex-wrap: wrap; border-bottom: 1px solid #ddd; }
+        .tabs label { padding: 8px 14px; cursor: pointer; border: 1px solid transparent; border-radius: 4px 4px 0 0; margin-bottom: -1px; color: #007bff; }
+        .tabs input { display: none; }
+        .tabs input:checked + label { color: #495057; background: #fff; border-color: #ddd #ddd #fff; }
+        .tab-pane { display: none; background: #fff; }
+        .tab-pane.active { display: block; }
+        table { width: 100%; border-collapse: collapse; }
+        th, td { padding: 6px 10px; border-top: 1px solid #dee2e6; vertical-align: middle; }
+        th { text-align: left; border-bottom: 2px solid #dee2e6; }
+        tbody tr:nth-of-type(odd) { background-color: rgba(0,0,0,.05); }
+        tbody tr:hover { background-color: rgba(0,0,0,.075); }
+        .text-right { text-align: right; }
+        .regression { color: #721c24; background-color: #f8d7da !important; font-weight: bold; }
+        .improvement { color: #155724; background-color: #d4edda !important; }
+        .sparkline { display: block; }
+        .sparkline polyline { fill: none; stroke: #0056b3; stroke-width: 1; }
+        .legend span { display: inline-block; margin-right: 12px; }
+        .legend i { display: inline-block; width: 10px; height: 10px; margin-right: 4px; }
+        .phase-update { fill: #6f42c1; background: #6f42c1; }
+        .phase-render { fill: #0056b3; background: #0056b3; }
+        .phase-swap { fill: #e8590c; background: #e8590c; }
+        .phase-sleep { fill: #adb5bd; background: #adb5bd; }
     </style>
-    <script src="https://cdnjs.cloudflare.com/ajax/libs/jquery/3.6.0/jquery.min.js"></script>
-    <script src="https://cdnjs.cloudflare.com/ajax/libs/jquery-sparklines/2.1.2/jquery.sparkline.min.js"></script>
 </head>
 <body>
     <div class="container-fluid">
@@ -77,8 +125,6 @@ std::string HTMLReportGenerator::generateHeader(const std::string &deviceName) c
 )";
 }
 
-#include <sstream>
-
 std::string HTMLReportGenerator::generateEnvironmentSection(const cJSON *envData) const {
     logDebug("Generating HTML environment section");
     std::string html = "<div class='col-md-6'><ul class='list-group'>";
@@ -91,25 +137,26 @@ std::string HTMLReportGenerator::generateEnvironmentSection(const cJSON *envData
             html += R"(
                 <li class='list-group-item'>
                     <strong>OpenGL Extensions:</strong>
-                    <button class="btn btn-link" type="button" data-toggle="collapse" data-target="#openglExtensions" aria-expanded="false" aria-controls="openglExtensions">
-                        Show Extensions
-                    </button>
-                    <div class="collapse" id="openglExtensions" style="font-size: 0.9em;">
+                    <details>
+                        <summary>Show Extensions</summary>
+                        <div class="extensions">
             )";
 
             // Display extensions in a compact format
             std::istringstream extensionsStream(item->valuestring);
             std::string extension;
             while (extensionsStream >> extension) {
-                html += "<span style='display: inline-block; margin-right: 5px;'>" + extension + "</span>";
+                html += "<span>" + escapeHTML(extension) + "</span>";
             }
 
             html += R"(
-                    </div>
+                        </div>
+                    </details>
                 </li>
             )";
         } else {
-            html += "<li class='list-group-item'><strong>" + key + ":</strong> " + item->valuestring + "</li>";
+            html += "<li class='list-group-item'><strong>" + escapeHTML(key) + ":</strong> " +
+                    escapeHTML(item->valuestring) + "</li>";
         }
     }
 
@@ -122,17 +169,17 @@ std::string HTMLReportGenerator::generateToolConfigSection(const cJSON *toolData
     std::string html = "<div class='col-md-6'><ul class='list-group'>";
     cJSON *item = nullptr;
     cJSON_ArrayForEach(item, toolData) {
-        html += "<li class='list-group-item'><strong>" + std::string(item->string) + ":</strong> " + item->valuestring +
-                "</li>";
+        html += "<li class='list-group-item'><strong>" + escapeHTML(item->string) + ":</strong> " +
+                escapeHTML(item->valuestring) + "</li>";
     }
     html += "</ul>";
 
     cJSON *scoreItem = cJSON_GetObjectItem(jsonData, "Score");
     if (scoreItem && cJSON_IsString(scoreItem)) {
         html += R"(
-                <div class="alert alert-primary mt-3" role="alert">
-                    <h3 class="alert-heading">Score: )" +
-                std::string(scoreItem->valuestring) + R"(</h3>
+                <div class="alert" role="alert">
+                    <h3>Score: )" +
+                escapeHTML(scoreItem->valuestring) + R"(</h3>
                 </div>
         )";
     } else {
@@ -143,99 +190,274 @@ std::string HTMLReportGenerator::generateToolConfigSection(const cJSON *toolData
     return html;
 }
 
+std::string HTMLReportGenerator::generateComparisonSection(const cJSON *comparisonData) const {
+    if (!comparisonData) {
+        return "";
+    }
+
+    logDebug("Generating HTML baseline comparison section");
+    cJSON *baselines = cJSON_GetObjectItem(comparisonData, "Baselines");
+    cJSON *threshold = cJSON_GetObjectItem(comparisonData, "Threshold (%)");
+    std::string html = "<div class='mt-4'><h2>Baseline Comparison</h2><p>Median frame work against " +
+                       escapeHTML(baselines ? baselines->valuestring : "N/A") + " (threshold " +
+                       escapeHTML(threshold ? threshold->valuestring : "N/A") + "%)</p>";
+    html += "<table><thead><tr>"
+            "<th style='width:300px'>Task</th>"
+            "<th class='text-right'>Baseline (ms)</th>"
+            "<th class='text-right'>Current (ms)</th>"
+            "<th class='text-right'>Change</th>"
+            "<th class='text-right'>95% CI</th>"
+            "<th class='text-right'>p-value</th>"
+            "<th>Status</th>"
+            "</tr></thead><tbody>";
+
+    auto field = [](const cJSON *task, const char *name) {
+        cJSON *item = cJSON_GetObjectItem(task, name);
+        return std::string(item && cJSON_IsString(item) ? item->valuestring : "N/A");
+    };
+
+    cJSON *task = nullptr;
+    cJSON_ArrayForEach(task, cJSON_GetObjectItem(comparisonData, "Tasks")) {
+        std::string status = field(task, "status");
+        html += "<tr class='" + escapeHTML(status) + "'><td>" + escapeHTML(task->string) + "</td>";
+        html += "<td class='text-right'>" + field(task, "baseline_median") + "</td>";
+        html += "<td class='text-right'>" + field(task, "current_median") + "</td>";
+        html += "<td class='text-right'>" + field(task, "change_percent") + "%</td>";
+        html += "<td class='text-right'>[" + field(task, "ci_low_percent") + "%, " + field(task, "ci_high_percent") +
+                "%]</td>";
+        html += "<td class='text-right'>" + field(task, "p_value") + "</td>";
+        html += "<td>" + escapeHTML(status) + "</td></tr>";
+    }
+    html += "</tbody></table></div>";
+    return html;
+}
+
+std::string HTMLReportGenerator::generateFrameBudgetSection(const cJSON *frameBudgetData) const {
+    if (!frameBudgetData) {
+        return "";
+    }
+
+    logDebug("Generating HTML frame budget section");
+    cJSON *threshold = cJSON_GetObjectItem(frameBudgetData, "Swap block threshold (ms)");
+    cJSON *tasks = cJSON_GetObjectItem(frameBudgetData, "Tasks");
+
+    auto phaseValue = [](const cJSON *task, const char *phase, const char *stat) {
+        cJSON *item = cJSON_GetObjectItem(cJSON_GetObjectItem(task, phase), stat);
+        return item && cJSON_IsString(item) ? std::strtod(item->valuestring, nullptr) : 0.0;
+    };
+
+    // All bars share one scale, so that the tasks can be compared at a glance.
+    double maxTotal = 0.0;
+    cJSON *task = nullptr;
+    cJSON_ArrayForEach(task, tasks) {
+        double total = 0.0;
+        for (const auto &phase : BUDGET_PHASES) {
+            total += phaseValue(task, phase.first, "mean");
+        }
+        maxTotal = std::max(maxTotal, total);
+    }
+    double scale = maxTotal > 0.0 ? BUDGET_BAR_WIDTH / maxTotal : 0.0;
+
+    std::string html = "<div class='mt-4'><h2>Frame Budget</h2><p>Mean time per frame in each phase of the render "
+                       "loop; a swap is blocked when it takes more than " +
+                       escapeHTML(threshold ? threshold->valuestring : "N/A") + " ms.</p><p class='legend'>";
+    for (const auto &phase : BUDGET_PHASES) {
+        html += "<span><i class='" + std::string(phase.second) + "'></i>" + phase.first + "</span>";
+    }
+    html += "</p><table><thead><tr>"
+            "<th style='width:300px'>Task</th>"
+            "<th>Breakdown</th>";
+    for (const auto &phase : BUDGET_PHASES) {
+        html += "<th class='text-right'>" + std::string(phase.first) + " mean / p99 (ms)</th>";
+    }
+    html += "<th class='text-right'>Swap blocked</th></tr></thead><tbody>";
+
+    char rect[160];
+    cJSON_ArrayForEach(task, tasks) {
+        html += "<tr><td>" + escapeHTML(task->string) + "</td><td><svg width='" + std::to_string(BUDGET_BAR_WIDTH) +
+                "' height='" + std::to_string(BUDGET_BAR_HEIGHT) + "'>";
+        double x = 0.0;
+        for (const auto &phase : BUDGET_PHASES) {
+            double mean = phaseValue(task, phase.first, "mean");
+            std::snprintf(rect, sizeof(rect),
+                          "<rect class='%s' x='%.1f' y='0' width='%.1f' height='%d'><title>%s %.2f ms</title></rect>",
+                          phase.second, x, mean * scale, BUDGET_BAR_HEIGHT, phase.first, mean);
+            html += rect;
+            x += mean * scale;
+        }
+        html += "</svg></td>";
+        for (const auto &phase : BUDGET_PHASES) {
+            html += "<td class='text-right'>" + Statistics::formatTwoDecimals(phaseValue(task, phase.first, "mean")) +
+                    " / " + Statistics::formatTwoDecimals(phaseValue(task, phase.first, "p99")) + "</td>";
+        }
+        cJSON *blocked = cJSON_GetObjectItem(task, "Swap blocked frames (%)");
+        html += "<td class='text-right'>" +
+                std::string(blocked && cJSON_IsString(blocked) ? blocked->valuestring : "N/A") + "%</td></tr>";
+    }
+    html += "</tbody></table></div>";
+    return html;
+}
+
+std::string HTMLReportGenerator::generateJankSpikeSection(const cJSON *jankSpikeData) const {
+    if (!jankSpikeData) {
+        return "";
+    }
+
+    logDebug("Generating HTML jank spike section");
+    cJSON *threshold = cJSON_GetObjectItem(jankSpikeData, "Threshold (ms)");
+    std::string html = "<div class='mt-4'><h2>Jank Spikes</h2><p>Frames that took longer than " +
+                       escapeHTML(threshold ? threshold->valuestring : "N/A") +
+                       " ms, with the frame times leading up to them.</p>";
+    html += "<table><thead><tr>"
+            "<th style='width:300px'>Task</th>"
+            "<th class='text-right'>Time (s)</th>"
+            "<th class='text-right'>Frame (ms)</th>"
+            "<th class='text-right'>Update / Render submit / Swap / Sleep (ms)</th>"
+            "<th class='text-right'>Context switches</th>"
+            "<th>Load average</th>"
+            "<th>Preceding frames</th>"
+            "<th>Collector samples</th>"
+            "</tr></thead><tbody>";
+
+    auto field = [](const cJSON *spike, const char *name) {
+        cJSON *item = cJSON_GetObjectItem(spike, name);
+        return std::string(item && cJSON_IsString(item) ? item->valuestring : "N/A");
+    };
+
+    cJSON *task = nullptr;
+    cJSON_ArrayForEach(task, cJSON_GetObjectItem(jankSpikeData, "Tasks")) {
+        cJSON *spike = nullptr;
+        cJSON_ArrayForEach(spike, task) {
+            html += "<tr><td>" + escapeHTML(task->string) + "</td>";
+            html += "<td class='text-right'>" + field(spike, "Time (s)") + "</td>";
+            html += "<td class='text-right'>" + field(spike, "Frame time (ms)") + "</td>";
+            html += "<td class='text-right'>" + field(spike, "Update (ms)") + " / " +
+                    field(spike, "Render submit (ms)") + " / " + field(spike, "Swap (ms)") + " / " +
+                    field(spike, "Sleep (ms)") + "</td>";
+            html += "<td class='text-right'>" + field(spike, "Voluntary context switches") + " voluntary, " +
+                    field(spike, "Involuntary context switches") + " involuntary</td>";
+            html += "<td>" + escapeHTML(field(spike, "Load average")) + "</td>";
+            cJSON *history = cJSON_GetObjectItem(spike, "History");
+            html += "<td>" + generateChart(cJSON_GetObjectItem(history, "Frame time (ms)")) +
+                    "</td><td><details><summary>Show</summary><ul>";
+            cJSON *sample = nullptr;
+            cJSON_ArrayForEach(sample, cJSON_GetObjectItem(spike, "Collector samples")) {
+                html += "<li>" + escapeHTML(sample->string) + ": " +
+                        escapeHTML(cJSON_IsString(sample) ? sample->valuestring : "N/A") + "</li>";
+            }
+            html += "</ul></details></td></tr>";
+        }
+    }
+    html += "</tbody></table></div>";
+    return html;
+}
+
 std::string HTMLReportGenerator::generateMetricsTabs(const cJSON *metricsData) const {
     logDebug("Generating HTML metrics tabs section");
     std::string html;
     int tabIndex = 0;
     cJSON *benchmark = nullptr;
 
-    html += R"(<div class="mt-4"><ul class="nav nav-tabs" id="benchmarkTabs" role="tablist">)";
+    html += R"(<div class="mt-4"><div class="tabs" id="benchmarkTabs" role="tablist">)";
     cJSON_ArrayForEach(benchmark, metricsData) {
         std::string benchmarkName = benchmark->string;
         std::string tabID = "tab_" + formatName(benchmarkName);
 
-        html += "<li class='nav-item'>"
-                "<a class='nav-link " +
-                std::string(tabIndex == 0 ? "active" : "") + "' id='" + tabID + "-tab' data-toggle='tab' href='#" +
-                tabID + "' role='tab'>" + benchmarkName + "</a></li>";
+        html += "<input type='radio' name='benchmarkTab' id='" + tabID + "-tab' data-pane='" + tabID + "'" +
+                std::string(tabIndex == 0 ? " checked" : "") + "><label for='" + tabID + "-tab' role='tab'>" +
+                escapeHTML(benchmarkName) + "</label>";
         tabIndex++;
     }
-    html += "</ul><div class='tab-content' id='benchmarkTabContent'>";
+    html += "</div><div class='tab-content' id='benchmarkTabContent'>";
 
     tabIndex = 0;
     cJSON_ArrayForEach(benchmark, metricsData) {
         std::string benchmarkName = benchmark->string;
         std::string tabID = "tab_" + formatName(benchmarkName);
 
-        html += "<div class='tab-pane fade " + std::string(tabIndex == 0 ? "show active" : "") + "' id='" + tabID +
+        html += "<div class='tab-pane" + std::string(tabIndex == 0 ? " active" : "") + "' id='" + tabID +
                 "' role='tabpanel' aria-labelledby='" + tabID + "-tab'>";
-        html += "<table class='table table-striped table-hover'><thead><tr>"
+        html += "<table><thead><tr>"
                 "<th style='width:300px'>Metric Name</th>"
                 "<th class='text-right' style='width:80px;'>Min</th>"
                 "<th class='text-right' style='width:80px;'>Max</th>"
                 "<th class='text-right' style='width:80px;'>Avg</th>"
                 "<th class='text-right' style='width:80px;'>StdDev</th>"
+                "<th class='text-right' style='width:80px;'>P50</th>"
+                "<th class='text-right' style='width:80px;'>P90</th>"
+                "<th class='text-right' style='width:80px;'>P99</th>"
                 "<th>Chart</th>"
                 "</tr></thead><tbody>";
 
         cJSON *metric = nullptr;
         cJSON_ArrayForEach(metric, benchmark) {
-            html += "<tr><td>" + std::string(metric->string) + "</td>";
-            for (const auto &stat : {"minimum", "maximum", "average", "std_dev"}) {
+            html += "<tr><td>" + escapeHTML(metric->string) + "</td>";
+            for (const auto &stat : {"minimum", "maximum", "average", "std_dev", "p50", "p90", "p99"}) {
                 cJSON *value = cJSON_GetObjectItem(metric, stat);
                 html += "<td class='text-right' style='width:80px;'>" +
                         std::string(value ? value->valuestring : "N/A") + "</td>";
             }
-            html += "<td><span class='sparkline' id='sl_" + formatName(benchmarkName) + "_" +
-                    formatName(metric->string) + "'></span></td></tr>";
+            html += "<td>" + generateChart(cJSON_GetObjectItem(metric, "values")) + "</td></tr>";
         }
         html += "</tbody></table></div>";
         tabIndex++;
     }
     html += "</div></div>";
+
+    // Tab switching is the only script in the report; everything else is static.
+    html += R"(
+<script>
+    document.querySelectorAll('#benchmarkTabs input').forEach(function(tab) {
+        tab.addEventListener('change', function() {
+            document.querySelectorAll('.tab-pane').forEach(function(pane) { pane.classList.remove('active'); });
+            document.getElementById(tab.dataset.pane).classList.add('active');
+        });
+    });
+</script>)";
     return html;
 }
 
-std::string HTMLReportGenerator::generateSparklineJS() const {
-    logDebug("Generating HTML sparkline JS section");
-    std::string script = R"(
-<script>
-    $(document).ready(function() {)";
-
-    cJSON *benchmarks = cJSON_GetObjectItem(jsonData, "Benchmark Results");
-    if (benchmarks) {
-        cJSON *benchmark = nullptr;
-        cJSON_ArrayForEach(benchmark, benchmarks) {
-            cJSON *metric = nullptr;
-            cJSON_ArrayForEach(metric, benchmark) {
-                cJSON *values = cJSON_GetObjectItem(metric, "values");
-                if (values && cJSON_GetArraySize(values) > 0) {
-                    std::string valuesArray = "[";
-                    for (int i = 0; i < cJSON_GetArraySize(values); ++i) {
-                        if (i > 0)
-                            valuesArray += ", ";
-                        valuesArray += cJSON_GetArrayItem(values, i)->valuestring;
-                    }
-                    valuesArray += "]";
-                    std::string elementId = "sl_" + formatName(benchmark->string) + "_" + formatName(metric->string);
-                    script += "$('#" + elementId + "').sparkline(" + valuesArray +
-                              ", {type: 'line', width: '200px', height: '20px', tooltipFormat: '<span style=\"color: #000;\">{{y}}</span>', tooltipClassname: 'tooltip-custom'});\n";
-                }
-            }
-        }
+std::string HTMLReportGenerator::generateChart(const cJSON *values) const {
+    int count = values ? cJSON_GetArraySize(values) : 0;
+    if (count == 0) {
+        return "";
     }
 
-    script += R"(
-    });
-</script>)";
-    return script;
+    std::vector<double> series;
+    series.reserve(count);
+    cJSON *value = nullptr;
+    cJSON_ArrayForEach(value, values) {
+        series.push_back(cJSON_IsString(value) ? std::strtod(value->valuestring, nullptr) : value->valuedouble);
+    }
+
+    std::vector<std::pair<double, double>> points = Statistics::downsampleLTTB(series, maxChartPoints);
+    auto range = std::minmax_element(series.begin(), series.end());
+    double minValue = *range.first;
+    double maxValue = *range.second;
+    double xScale = count > 1 ? static_cast<double>(CHART_WIDTH - 2) / (count - 1) : 0.0;
+    double yScale = maxValue > minValue ? (CHART_HEIGHT - 2) / (maxValue - minValue) : 0.0;
+
+    std::string svg = "<svg class='sparkline' width='" + std::to_string(CHART_WIDTH) + "' height='" +
+                      std::to_string(CHART_HEIGHT) + "' viewBox='0 0 " + std::to_string(CHART_WIDTH) + " " +
+                      std::to_string(CHART_HEIGHT) + "'><title>" + std::to_string(count) + " samples, min " +
+                      Statistics::formatTwoDecimals(minValue) + ", max " + Statistics::formatTwoDecimals(maxValue) +
+                      "</title><polyline points='";
+
+    char point[48];
+    for (const auto &p : points) {
+        double x = 1.0 + p.first * xScale;
+        double y = yScale > 0.0 ? CHART_HEIGHT - 1.0 - (p.second - minValue) * yScale : CHART_HEIGHT / 2.0;
+        std::snprintf(point, sizeof(point), "%.1f,%.1f ", x, y);
+        svg += point;
+    }
+    svg += "'/></svg>";
+    return svg;
 }
 
 std::string HTMLReportGenerator::generateFooter() const {
     logDebug("Generating HTML footer section");
     return R"(
     </div> <!-- container -->
-    <script src="https://maxcdn.bootstrapcdn.com/bootstrap/4.5.2/js/bootstrap.bundle.min.js"></script>
 </body>
 </html>)";
 }
@@ -248,4 +470,31 @@ std::string HTMLReportGenerator::formatName(const std::string &name) const {
     formattedName.erase(std::remove(formattedName.begin(), formattedName.end(), ')'), formattedName.end());
     formattedName.erase(std::remove(formattedName.begin(), formattedName.end(), '.'), formattedName.end());
     return formattedName;
-}
\ No newline at end of file
+}
+
+std::string HTMLReportGenerator::escapeHTML(const std::string &text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+        case '&':
+            escaped += "&amp;";
+            break;
+        case '<':
+            escaped += "&lt;";
+            break;
+        case '>':
+            escaped += "&gt;";
+            break;
+        case '"':
+            escaped += "&quot;";
+            break;
+        case '\'':
+            escaped += "&#39;";
+            break;
+        default:
+            escaped += c;
+        }
+    }
+    return escaped;
+}
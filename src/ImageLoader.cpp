@@ -18,183 +18,742 @@
 */
 
 #include "ImageLoader.h"
+#include "GLStateCache.h"
+#include "GraphicsContext.h"
 #include "Logger.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <csetjmp>
+#include <cstdio>
 #include <cstring>
+#include <fcntl.h>
 #include <fstream>
 #include <stdexcept>
-#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <jpeglib.h>
 #include <png.h>
 
-GLuint ImageLoader::loadTextureFromFile(const std::string &filePath) {
-    logDebug("Attempting to load texture from file: " + filePath);
-    if (isPNG(filePath)) {
-        logDebug("Detected PNG format for file: " + filePath);
-        return loadPNGTexture(filePath);
-    } else if (isJPG(filePath)) {
-        logDebug("Detected JPG format for file: " + filePath);
-        return loadJPGTexture(filePath);
-    } else {
-        logError("Unsupported image format: " + filePath);
-        throw std::runtime_error("Unsupported image format");
+namespace {
+
+constexpr unsigned char JPG_SIGNATURE[] = {0xFF, 0xD8};
+constexpr size_t PNG_SIGNATURE_SIZE = 8;
+constexpr int MAX_JPG_ROWS_PER_READ = 16;
+constexpr unsigned int JPG_SCALE_DENOMINATORS[] = {8, 4, 2};
+constexpr unsigned char KTX_SIGNATURE[] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+constexpr unsigned char KTX2_SIGNATURE[] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+// KTX: the signature, then 13 32-bit fields starting with the byte order mark.
+constexpr size_t KTX_HEADER_SIZE = 64;
+constexpr uint32_t KTX_BYTE_ORDER = 0x04030201;
+// KTX2: the signature, 9 32-bit fields, the data format, key/value and supercompression index, then
+// one (offset, length, uncompressed length) triple of 64-bit values per level.
+constexpr size_t KTX2_HEADER_SIZE = 80;
+constexpr size_t KTX2_LEVEL_INDEX_ENTRY_SIZE = 24;
+
+/**
+ * A compressed texture format with the extension that adds it to OpenGL ES 2.0, if any.
+ */
+struct CompressedFormat {
+    GLenum internalFormat;
+    unsigned int blockWidth;
+    unsigned int blockHeight;
+    unsigned int blockBytes;
+    const char *extension;
+};
+
+const CompressedFormat ETC_FORMATS[] = {
+    {0x8D64, 4, 4, 8, "GL_OES_compressed_ETC1_RGB8_texture"}, // GL_ETC1_RGB8_OES
+    // ETC2 and EAC are core in OpenGL ES 3.0, which lists them in GL_COMPRESSED_TEXTURE_FORMATS.
+    {0x9270, 4, 4, 8, nullptr},  // GL_COMPRESSED_R11_EAC
+    {0x9271, 4, 4, 8, nullptr},  // GL_COMPRESSED_SIGNED_R11_EAC
+    {0x9272, 4, 4, 16, nullptr}, // GL_COMPRESSED_RG11_EAC
+    {0x9273, 4, 4, 16, nullptr}, // GL_COMPRESSED_SIGNED_RG11_EAC
+    {0x9274, 4, 4, 8, nullptr},  // GL_COMPRESSED_RGB8_ETC2
+    {0x9275, 4, 4, 8, nullptr},  // GL_COMPRESSED_SRGB8_ETC2
+    {0x9276, 4, 4, 8, nullptr},  // GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2
+    {0x9277, 4, 4, 8, nullptr},  // GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2
+    {0x9278, 4, 4, 16, nullptr}, // GL_COMPRESSED_RGBA8_ETC2_EAC
+    {0x9279, 4, 4, 16, nullptr}, // GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC
+};
+
+// ASTC formats come in the same block size order in GL (RGBA and SRGB8_ALPHA8) and Vulkan (UNORM and SRGB).
+constexpr GLenum GL_ASTC_RGBA_FIRST = 0x93B0;  // GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+constexpr GLenum GL_ASTC_SRGB_FIRST = 0x93D0;  // GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR
+constexpr uint32_t VK_ETC2_FIRST = 147;        // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+constexpr uint32_t VK_ASTC_FIRST = 157;        // VK_FORMAT_ASTC_4x4_UNORM_BLOCK
+const std::pair<unsigned int, unsigned int> ASTC_BLOCK_SIZES[] = {{4, 4},  {5, 4},  {5, 5},   {6, 5},   {6, 6},
+                                                                   {8, 5},  {8, 6},  {8, 8},   {10, 5},  {10, 6},
+                                                                   {10, 8}, {10, 10}, {12, 10}, {12, 12}};
+constexpr size_t ASTC_FORMAT_COUNT = sizeof(ASTC_BLOCK_SIZES) / sizeof(ASTC_BLOCK_SIZES[0]);
+
+// The Vulkan ETC2 and EAC formats from VK_ETC2_FIRST on, in GL.
+const GLenum VK_ETC2_TO_GL[] = {0x9274, 0x9275, 0x9276, 0x9277, 0x9278, 0x9279, 0x9270, 0x9271, 0x9272, 0x9273};
+constexpr uint32_t VK_ETC2_FORMAT_COUNT = sizeof(VK_ETC2_TO_GL) / sizeof(VK_ETC2_TO_GL[0]);
+
+bool findCompressedFormat(GLenum internalFormat, CompressedFormat &format) {
+    for (const auto &etcFormat : ETC_FORMATS) {
+        if (etcFormat.internalFormat == internalFormat) {
+            format = etcFormat;
+            return true;
+        }
+    }
+    for (GLenum first : {GL_ASTC_RGBA_FIRST, GL_ASTC_SRGB_FIRST}) {
+        if (internalFormat >= first && internalFormat < first + ASTC_FORMAT_COUNT) {
+            const auto &blockSize = ASTC_BLOCK_SIZES[internalFormat - first];
+            format = {internalFormat, blockSize.first, blockSize.second, 16, "GL_KHR_texture_compression_astc_ldr"};
+            return true;
+        }
     }
+    return false;
 }
 
-bool ImageLoader::isPNG(const std::string &filePath) {
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file.is_open()) {
-        logWarn("Failed to open file for PNG check: " + filePath);
-        return false;
+GLenum vulkanToGLFormat(uint32_t vkFormat) {
+    if (vkFormat >= VK_ETC2_FIRST && vkFormat < VK_ETC2_FIRST + VK_ETC2_FORMAT_COUNT) {
+        return VK_ETC2_TO_GL[vkFormat - VK_ETC2_FIRST];
     }
+    if (vkFormat >= VK_ASTC_FIRST && vkFormat < VK_ASTC_FIRST + 2 * ASTC_FORMAT_COUNT) {
+        uint32_t index = vkFormat - VK_ASTC_FIRST;
+        return (index % 2 == 0 ? GL_ASTC_RGBA_FIRST : GL_ASTC_SRGB_FIRST) + index / 2;
+    }
+    return 0;
+}
 
-    png_byte header[8];
-    file.read(reinterpret_cast<char *>(header), 8);
-    return !png_sig_cmp(header, 0, 8);
+std::string formatName(GLenum internalFormat) {
+    char name[11];
+    std::snprintf(name, sizeof(name), "0x%04X", internalFormat);
+    return name;
 }
 
-bool ImageLoader::isJPG(const std::string &filePath) {
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file.is_open()) {
-        logWarn("Failed to open file for JPG check: " + filePath);
-        return false;
+uint64_t readInteger(const unsigned char *data, size_t bytes, bool bigEndian) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(data[bigEndian ? bytes - 1 - i : i]) << (8 * i);
     }
+    return value;
+}
 
-    unsigned char header[2];
-    file.read(reinterpret_cast<char *>(header), 2);
-    return (header[0] == 0xFF && header[1] == 0xD8);
+uint32_t readU32(const unsigned char *data, bool bigEndian = false) {
+    return static_cast<uint32_t>(readInteger(data, 4, bigEndian));
 }
 
-GLuint ImageLoader::loadPNGTexture(const std::string &filePath) {
-    logDebug("Loading PNG texture from file: " + filePath);
+uint64_t readU64(const unsigned char *data) { return readInteger(data, 8, false); }
 
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file) {
+unsigned int mipmapLevelCount(unsigned int width, unsigned int height) {
+    unsigned int levels = 1;
+    for (unsigned int size = std::max(width, height); size > 1; size /= 2) {
+        ++levels;
+    }
+    return levels;
+}
+
+std::atomic<uint64_t> decodedImages(0);
+std::atomic<uint64_t> fileOpens(0);
+std::atomic<uint64_t> bufferAllocations(0);
+std::atomic<uint64_t> bytesCopied(0);
+
+/**
+ * A read-only view of a whole file, memory-mapped where possible and read otherwise.
+ */
+class MappedFile {
+public:
+    MappedFile() : mapping(nullptr), mappedSize(0) {}
+    ~MappedFile() {
+        if (mapping) {
+            munmap(mapping, mappedSize);
+        }
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &filePath) {
+        int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        ++fileOpens;
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        size_t fileSize = static_cast<size_t>(fileStat.st_size);
+
+        void *address = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            madvise(address, fileSize, MADV_SEQUENTIAL);
+            mapping = address;
+            mappedSize = fileSize;
+        } else {
+            // Some file systems cannot be mapped; fall back to a single read.
+            buffer.resize(fileSize);
+            ++bufferAllocations;
+            size_t offset = 0;
+            while (offset < fileSize) {
+                ssize_t bytesRead = ::read(fd, buffer.data() + offset, fileSize - offset);
+                if (bytesRead <= 0) {
+                    ::close(fd);
+                    return false;
+                }
+                offset += static_cast<size_t>(bytesRead);
+            }
+            bytesCopied += fileSize;
+        }
+        ::close(fd);
+        return true;
+    }
+
+    const unsigned char *data() const {
+        return mapping ? static_cast<const unsigned char *>(mapping) : buffer.data();
+    }
+    size_t size() const { return mapping ? mappedSize : buffer.size(); }
+
+private:
+    void *mapping;
+    size_t mappedSize;
+    std::vector<unsigned char> buffer;
+};
+
+/**
+ * A libjpeg error manager that returns control to the decoder instead of exiting the process.
+ */
+struct JPGErrorManager {
+    jpeg_error_mgr base;
+    jmp_buf jump;
+};
+
+void jpgErrorExit(j_common_ptr cinfo) {
+    char message[JMSG_LENGTH_MAX];
+    (*cinfo->err->format_message)(cinfo, message);
+    logError(std::string("Failed to decode JPG image: ") + message);
+    longjmp(reinterpret_cast<JPGErrorManager *>(cinfo->err)->jump, 1);
+}
+
+} // namespace
+
+GLuint ImageLoader::loadTextureFromFile(const std::string &filePath) {
+    logDebug("Attempting to load texture from file: " + filePath);
+    MappedFile file;
+    if (!file.open(filePath)) {
         logError("Could not open image file: " + filePath);
         return 0;
     }
 
-    png_byte header[8];
-    file.read(reinterpret_cast<char *>(header), 8);
-    if (!file.good() || png_sig_cmp(header, 0, 8)) {
-        logError("File is not recognized as a PNG file: " + filePath);
+    ImageFormat format = detectFormat(file.data(), file.size());
+    if (format == ImageFormat::KTX || format == ImageFormat::KTX2) {
+        return createCompressedTexture(file.data(), file.size(), format, filePath, nullptr);
+    }
+    if (format == ImageFormat::UNKNOWN) {
+        logError("Unsupported image format: " + filePath);
+        throw std::runtime_error("Unsupported image format");
+    }
+
+    ImageData image;
+    if (!decodeData(file.data(), file.size(), format, image)) {
         return 0;
     }
+    return createTexture(image);
+}
 
-    png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
-    if (!png_ptr) {
-        logError("Failed to create PNG read structure");
+GLuint ImageLoader::loadCompressedTexture(const std::string &filePath, CompressedTextureInfo *info) {
+    MappedFile file;
+    if (!file.open(filePath)) {
+        logError("Could not open texture file: " + filePath);
         return 0;
     }
 
-    png_infop info_ptr = png_create_info_struct(png_ptr);
-    if (!info_ptr) {
-        png_destroy_read_struct(&png_ptr, nullptr, nullptr);
-        logError("Failed to create PNG info structure");
+    ImageFormat format = detectFormat(file.data(), file.size());
+    if (format != ImageFormat::KTX && format != ImageFormat::KTX2) {
+        logError("Not a KTX or KTX2 texture: " + filePath);
         return 0;
     }
+    return createCompressedTexture(file.data(), file.size(), format, filePath, info);
+}
 
-    if (setjmp(png_jmpbuf(png_ptr))) {
-        png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
-        logError("Failed to set PNG error handling");
+bool ImageLoader::decodeImage(const std::string &filePath, ImageData &image, unsigned int targetWidth,
+                              unsigned int targetHeight) {
+    ImageFormat format = ImageFormat::UNKNOWN;
+    if (decodeFile(filePath, image, format, targetWidth, targetHeight)) {
+        return true;
+    }
+    if (format == ImageFormat::UNKNOWN) {
+        logError("Unsupported image format: " + filePath);
+    }
+    return false;
+}
+
+bool ImageLoader::decodeFile(const std::string &filePath, ImageData &image, ImageFormat &format,
+                             unsigned int targetWidth, unsigned int targetHeight) {
+    format = ImageFormat::UNKNOWN;
+    MappedFile file;
+    if (!file.open(filePath)) {
+        logError("Could not open image file: " + filePath);
+        return false;
+    }
+
+    format = detectFormat(file.data(), file.size());
+    LOG_DEBUG("Decoding image from file: " + filePath);
+    return decodeData(file.data(), file.size(), format, image, targetWidth, targetHeight);
+}
+
+bool ImageLoader::decodeData(const unsigned char *data, size_t size, ImageFormat format, ImageData &image,
+                             unsigned int targetWidth, unsigned int targetHeight) {
+    bool decoded = false;
+    if (format == ImageFormat::PNG) {
+        decoded = decodePNG(data, size, image);
+    } else if (format == ImageFormat::JPG) {
+        decoded = decodeJPG(data, size, image, targetWidth, targetHeight);
+    }
+    if (decoded) {
+        ++decodedImages;
+    }
+    return decoded;
+}
+
+GLuint ImageLoader::createTexture(const ImageData &image) {
+    if (image.pixels.empty()) {
         return 0;
     }
 
-    png_set_read_fn(png_ptr, (png_voidp)&file, [](png_structp pngPtr, png_bytep data, png_size_t length) {
-        std::ifstream *stream = reinterpret_cast<std::ifstream *>(png_get_io_ptr(pngPtr));
-        stream->read(reinterpret_cast<char *>(data), length);
-    });
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+    GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, textureID);
+    // RGB rows are tightly packed and need not be a multiple of the default 4-byte alignment.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, image.format == GL_RGBA ? 4 : 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, image.format, image.width, image.height, 0, image.format, GL_UNSIGNED_BYTE,
+                 image.pixels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // Without GL_OES_texture_npot, a non-power-of-two texture is only complete with CLAMP_TO_EDGE wrapping.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, 0);
 
-    png_set_sig_bytes(png_ptr, 8);
-    png_read_info(png_ptr, info_ptr);
+    LOG_DEBUG("Created texture " + std::to_string(textureID) + " (" + std::to_string(image.width) + "x" +
+              std::to_string(image.height) + ")");
+    return textureID;
+}
 
-    png_uint_32 imgWidth, imgHeight;
-    int bitDepth, colorType;
-    png_get_IHDR(png_ptr, info_ptr, &imgWidth, &imgHeight, &bitDepth, &colorType, nullptr, nullptr, nullptr);
+bool ImageLoader::generateMipmaps(GLuint texture, const ImageData &image, MipmapGeneration mode) {
+    if (mode == MipmapGeneration::NONE || image.pixels.empty() || !supportsMipmaps(image.width, image.height)) {
+        return false;
+    }
 
-    if (colorType == PNG_COLOR_TYPE_PALETTE)
-        png_set_palette_to_rgb(png_ptr);
-    if (colorType == PNG_COLOR_TYPE_GRAY && bitDepth < 8)
-        png_set_expand_gray_1_2_4_to_8(png_ptr);
-    if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS))
-        png_set_tRNS_to_alpha(png_ptr);
-    if (bitDepth == 16)
-        png_set_strip_16(png_ptr);
-    if (colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_GRAY_ALPHA)
-        png_set_gray_to_rgb(png_ptr);
+    GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, texture);
+    if (mode == MipmapGeneration::GPU) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    } else {
+        // Two buffers take turns as the source and destination of each level.
+        ImageData levels[2];
+        const ImageData *source = &image;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, image.format == GL_RGBA ? 4 : 1);
+        for (GLint level = 1; source->width > 1 || source->height > 1; ++level) {
+            ImageData &destination = levels[level % 2];
+            downsample(*source, destination);
+            glTexImage2D(GL_TEXTURE_2D, level, destination.format, destination.width, destination.height, 0,
+                         destination.format, GL_UNSIGNED_BYTE, destination.pixels.data());
+            source = &destination;
+        }
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
 
-    png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
+bool ImageLoader::supportsMipmaps(unsigned int width, unsigned int height) {
+    auto isPowerOfTwo = [](unsigned int value) { return value != 0 && (value & (value - 1)) == 0; };
+    return (isPowerOfTwo(width) && isPowerOfTwo(height)) ||
+           GraphicsContext::isExtensionSupported("GL_OES_texture_npot");
+}
 
-    png_read_update_info(png_ptr, info_ptr);
+void ImageLoader::downsample(const ImageData &source, ImageData &level) {
+    level.width = std::max(source.width / 2, 1u);
+    level.height = std::max(source.height / 2, 1u);
+    level.sourceWidth = level.width;
+    level.sourceHeight = level.height;
+    level.format = source.format;
+    size_t channels = source.format == GL_RGBA ? 4 : 3;
+    size_t sourceStride = source.width * channels;
+    resizePixels(level, static_cast<size_t>(level.width) * level.height * channels);
+
+    // A source row or column of one pixel is paired with itself.
+    size_t columnStep = source.width > 1 ? channels : 0;
+    size_t rowStep = source.height > 1 ? sourceStride : 0;
+    unsigned char *output = level.pixels.data();
+    for (unsigned int y = 0; y < level.height; ++y) {
+        const unsigned char *top = source.pixels.data() + 2 * y * sourceStride;
+        const unsigned char *bottom = top + rowStep;
+        if (channels == 4 && columnStep == 4) {
+            // The even and odd bytes of two horizontally adjacent pixels are summed in 16-bit lanes, so that
+            // each word yields one output pixel; the byte order of the words does not matter.
+            constexpr uint64_t EVEN_BYTES = 0x00FF00FF00FF00FFULL;
+            constexpr uint32_t ROUNDING = 0x00020002;
+            for (unsigned int x = 0; x < level.width; ++x) {
+                uint64_t topPair;
+                uint64_t bottomPair;
+                std::memcpy(&topPair, top + 8 * x, sizeof(topPair));
+                std::memcpy(&bottomPair, bottom + 8 * x, sizeof(bottomPair));
+                uint64_t even = (topPair & EVEN_BYTES) + (bottomPair & EVEN_BYTES);
+                uint64_t odd = ((topPair >> 8) & EVEN_BYTES) + ((bottomPair >> 8) & EVEN_BYTES);
+                uint32_t evenSum = static_cast<uint32_t>(even) + static_cast<uint32_t>(even >> 32) + ROUNDING;
+                uint32_t oddSum = static_cast<uint32_t>(odd) + static_cast<uint32_t>(odd >> 32) + ROUNDING;
+                uint32_t pixel = ((evenSum >> 2) & 0x00FF00FF) | ((oddSum >> 2) & 0x00FF00FF) << 8;
+                std::memcpy(output, &pixel, sizeof(pixel));
+                output += 4;
+            }
+            continue;
+        }
+        for (unsigned int x = 0; x < level.width; ++x) {
+            const unsigned char *topLeft = top + 2 * x * channels;
+            const unsigned char *bottomLeft = bottom + 2 * x * channels;
+            for (size_t c = 0; c < channels; ++c) {
+                *output++ = static_cast<unsigned char>(
+                    (topLeft[c] + topLeft[c + columnStep] + bottomLeft[c] + bottomLeft[c + columnStep] + 2) / 4);
+            }
+        }
+    }
+}
 
-    std::vector<png_bytep> row_pointers(imgHeight);
-    for (size_t i = 0; i < imgHeight; i++) {
-        row_pointers[i] = new png_byte[png_get_rowbytes(png_ptr, info_ptr)];
+size_t ImageLoader::getTextureSizeBytes(unsigned int width, unsigned int height, size_t bytesPerPixel,
+                                        bool mipmapped) {
+    size_t sizeBytes = static_cast<size_t>(width) * height * bytesPerPixel;
+    while (mipmapped && (width > 1 || height > 1)) {
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+        sizeBytes += static_cast<size_t>(width) * height * bytesPerPixel;
     }
+    return sizeBytes;
+}
 
-    png_read_image(png_ptr, row_pointers.data());
+GLuint ImageLoader::createCompressedTexture(const unsigned char *data, size_t size, ImageFormat format,
+                                            const std::string &filePath, CompressedTextureInfo *info) {
+    CompressedLevels texture;
+    bool parsed = format == ImageFormat::KTX ? parseKTX(data, size, texture) : parseKTX2(data, size, texture);
+    if (!parsed) {
+        logError("Invalid or unsupported KTX texture: " + filePath);
+        return 0;
+    }
 
-    std::vector<png_byte> imageData(imgWidth * imgHeight * 4);
-    for (png_uint_32 i = 0; i < imgHeight; ++i) {
-        std::memcpy(&imageData[i * imgWidth * 4], row_pointers[i], png_get_rowbytes(png_ptr, info_ptr));
-        delete[] row_pointers[i]; // Free each row after copying
+    CompressedFormat compressedFormat;
+    if (!findCompressedFormat(texture.internalFormat, compressedFormat)) {
+        logError("Unsupported compressed format " + formatName(texture.internalFormat) + " in: " + filePath);
+        return 0;
+    }
+    if (!isCompressedFormatSupported(texture.internalFormat)) {
+        logError("The driver does not support compressed format " + formatName(texture.internalFormat) +
+                 " of: " + filePath);
+        return 0;
     }
 
-    png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+    size_t sizeBytes = 0;
+    for (size_t level = 0; level < texture.levels.size(); ++level) {
+        unsigned int width = std::max(texture.width >> level, 1u);
+        unsigned int height = std::max(texture.height >> level, 1u);
+        size_t blocks = static_cast<size_t>((width + compressedFormat.blockWidth - 1) / compressedFormat.blockWidth) *
+                        ((height + compressedFormat.blockHeight - 1) / compressedFormat.blockHeight);
+        if (texture.levels[level].second != blocks * compressedFormat.blockBytes) {
+            logError("Mipmap level " + std::to_string(level) + " has an unexpected size in: " + filePath);
+            return 0;
+        }
+        sizeBytes += texture.levels[level].second;
+    }
 
     GLuint textureID;
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, imgWidth, imgHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, imageData.data());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, textureID);
+    for (size_t level = 0; level < texture.levels.size(); ++level) {
+        glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), texture.internalFormat,
+                               std::max(texture.width >> level, 1u), std::max(texture.height >> level, 1u), 0,
+                               static_cast<GLsizei>(texture.levels[level].second), texture.levels[level].first);
+    }
+    // An incomplete mipmap chain can only be sampled from the base level in OpenGL ES 2.0.
+    bool mipmapped = texture.levels.size() == mipmapLevelCount(texture.width, texture.height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    logDebug("Successfully loaded PNG texture with ID: " + std::to_string(textureID));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, 0);
+
+    if (info) {
+        info->internalFormat = texture.internalFormat;
+        info->width = texture.width;
+        info->height = texture.height;
+        info->levels = static_cast<unsigned int>(texture.levels.size());
+        info->sizeBytes = sizeBytes;
+    }
+    LOG_DEBUG("Created compressed texture " + std::to_string(textureID) + " (" + std::to_string(texture.width) +
+              "x" + std::to_string(texture.height) + ", " + formatName(texture.internalFormat) + ", " +
+              std::to_string(texture.levels.size()) + " levels)");
     return textureID;
 }
 
-GLuint ImageLoader::loadJPGTexture(const std::string &filePath) {
-    logDebug("Loading JPG texture from file: " + filePath);
+bool ImageLoader::parseKTX(const unsigned char *data, size_t size, CompressedLevels &texture) {
+    if (size < KTX_HEADER_SIZE) {
+        return false;
+    }
+    const unsigned char *header = data + sizeof(KTX_SIGNATURE);
+    bool bigEndian = readU32(header) != KTX_BYTE_ORDER;
+    if (readU32(header, bigEndian) != KTX_BYTE_ORDER) {
+        return false;
+    }
+
+    auto field = [&](int index) { return readU32(header + 4 * index, bigEndian); };
+    uint32_t glType = field(1);
+    uint32_t glFormat = field(3);
+    texture.internalFormat = field(4);
+    texture.width = field(6);
+    texture.height = field(7);
+    uint32_t depth = field(8);
+    uint32_t arrayElements = field(9);
+    uint32_t faces = field(10);
+    uint32_t levelCount = std::max(field(11), 1u);
+    uint32_t keyValueBytes = field(12);
+    // Compressed textures have neither a pixel type nor a pixel format.
+    if (glType != 0 || glFormat != 0 || texture.width == 0 || texture.height == 0 || depth > 1 || arrayElements != 0 ||
+        faces != 1 || levelCount > mipmapLevelCount(texture.width, texture.height)) {
+        return false;
+    }
+
+    size_t offset = KTX_HEADER_SIZE + static_cast<size_t>(keyValueBytes);
+    texture.levels.clear();
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        if (offset > size || size - offset < 4) {
+            return false;
+        }
+        size_t imageSize = readU32(data + offset, bigEndian);
+        offset += 4;
+        if (size - offset < imageSize) {
+            return false;
+        }
+        texture.levels.emplace_back(data + offset, imageSize);
+        // Levels are padded to a multiple of four bytes.
+        offset += (imageSize + 3) & ~static_cast<size_t>(3);
+    }
+    return true;
+}
+
+bool ImageLoader::parseKTX2(const unsigned char *data, size_t size, CompressedLevels &texture) {
+    if (size < KTX2_HEADER_SIZE) {
+        return false;
+    }
+    const unsigned char *header = data + sizeof(KTX2_SIGNATURE);
+    auto field = [&](int index) { return readU32(header + 4 * index); };
+    uint32_t vkFormat = field(0);
+    texture.width = field(2);
+    texture.height = field(3);
+    uint32_t depth = field(4);
+    uint32_t layers = field(5);
+    uint32_t faces = field(6);
+    uint32_t levelCount = std::max(field(7), 1u);
+    uint32_t supercompression = field(8);
+    texture.internalFormat = vulkanToGLFormat(vkFormat);
+    if (texture.internalFormat == 0) {
+        logError("Unsupported KTX2 Vulkan format " + std::to_string(vkFormat) + ".");
+        return false;
+    }
+    if (supercompression != 0) {
+        logError("Supercompressed KTX2 textures are not supported.");
+        return false;
+    }
+    if (texture.width == 0 || texture.height == 0 || depth != 0 || layers != 0 || faces != 1 ||
+        levelCount > mipmapLevelCount(texture.width, texture.height) ||
+        (size - KTX2_HEADER_SIZE) / KTX2_LEVEL_INDEX_ENTRY_SIZE < levelCount) {
+        return false;
+    }
+
+    texture.levels.clear();
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        const unsigned char *entry = data + KTX2_HEADER_SIZE + level * KTX2_LEVEL_INDEX_ENTRY_SIZE;
+        uint64_t levelOffset = readU64(entry);
+        uint64_t levelLength = readU64(entry + 8);
+        if (levelOffset > size || size - levelOffset < levelLength) {
+            return false;
+        }
+        texture.levels.emplace_back(data + levelOffset, static_cast<size_t>(levelLength));
+    }
+    return true;
+}
+
+bool ImageLoader::isCompressedFormatSupported(GLenum internalFormat) {
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &formatCount);
+    if (formatCount > 0) {
+        std::vector<GLint> formats(formatCount);
+        glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+        if (std::find(formats.begin(), formats.end(), static_cast<GLint>(internalFormat)) != formats.end()) {
+            return true;
+        }
+    }
+
+    // Some drivers only advertise the extension.
+    CompressedFormat format;
+    return findCompressedFormat(internalFormat, format) && format.extension &&
+           GraphicsContext::isExtensionSupported(format.extension);
+}
+
+bool ImageLoader::isPNG(const std::string &filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        logWarn("Failed to open file for PNG check: " + filePath);
+        return false;
+    }
+
+    unsigned char header[PNG_SIGNATURE_SIZE];
+    file.read(reinterpret_cast<char *>(header), sizeof(header));
+    return detectFormat(header, static_cast<size_t>(file.gcount())) == ImageFormat::PNG;
+}
+
+bool ImageLoader::isJPG(const std::string &filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        logWarn("Failed to open file for JPG check: " + filePath);
+        return false;
+    }
+
+    unsigned char header[sizeof(JPG_SIGNATURE)];
+    file.read(reinterpret_cast<char *>(header), sizeof(header));
+    return detectFormat(header, static_cast<size_t>(file.gcount())) == ImageFormat::JPG;
+}
+
+bool ImageLoader::isKTX(const std::string &filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        logWarn("Failed to open file for KTX check: " + filePath);
+        return false;
+    }
+
+    unsigned char header[sizeof(KTX_SIGNATURE)];
+    file.read(reinterpret_cast<char *>(header), sizeof(header));
+    ImageFormat format = detectFormat(header, static_cast<size_t>(file.gcount()));
+    return format == ImageFormat::KTX || format == ImageFormat::KTX2;
+}
+
+bool ImageLoader::hasExtension(const std::string &filePath, std::initializer_list<const char *> extensions) {
+    size_t dot = filePath.find_last_of("./");
+    if (dot == std::string::npos || filePath[dot] != '.') {
+        return false;
+    }
+    std::string extension = filePath.substr(dot);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return std::find(extensions.begin(), extensions.end(), extension) != extensions.end();
+}
+
+ImageDecodeStatistics ImageLoader::getDecodeStatistics() {
+    ImageDecodeStatistics statistics;
+    statistics.images = decodedImages.load();
+    statistics.fileOpens = fileOpens.load();
+    statistics.bufferAllocations = bufferAllocations.load();
+    statistics.bytesCopied = bytesCopied.load();
+    return statistics;
+}
+
+ImageLoader::ImageFormat ImageLoader::detectFormat(const unsigned char *data, size_t size) {
+    if (size >= PNG_SIGNATURE_SIZE && !png_sig_cmp(data, 0, PNG_SIGNATURE_SIZE)) {
+        return ImageFormat::PNG;
+    }
+    if (size >= sizeof(JPG_SIGNATURE) && std::memcmp(data, JPG_SIGNATURE, sizeof(JPG_SIGNATURE)) == 0) {
+        return ImageFormat::JPG;
+    }
+    if (size >= sizeof(KTX_SIGNATURE) && std::memcmp(data, KTX_SIGNATURE, sizeof(KTX_SIGNATURE)) == 0) {
+        return ImageFormat::KTX;
+    }
+    if (size >= sizeof(KTX2_SIGNATURE) && std::memcmp(data, KTX2_SIGNATURE, sizeof(KTX2_SIGNATURE)) == 0) {
+        return ImageFormat::KTX2;
+    }
+    return ImageFormat::UNKNOWN;
+}
+
+void ImageLoader::resizePixels(ImageData &image, size_t size) {
+    if (image.pixels.capacity() < size) {
+        ++bufferAllocations;
+    }
+    image.pixels.resize(size);
+}
 
-    FILE *infile = fopen(filePath.c_str(), "rb");
-    if (!infile) {
-        logError("Error: Failed to open image " + filePath);
+bool ImageLoader::decodePNG(const unsigned char *data, size_t size, ImageData &image) {
+    // The simplified API applies all conversions to 8-bit RGBA while decoding into the destination.
+    png_image png;
+    std::memset(&png, 0, sizeof(png));
+    png.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_memory(&png, data, size)) {
+        logError(std::string("Failed to read the PNG header: ") + png.message);
         return false;
     }
 
+    png.format = PNG_FORMAT_RGBA;
+    image.width = png.width;
+    image.height = png.height;
+    image.sourceWidth = png.width;
+    image.sourceHeight = png.height;
+    image.format = GL_RGBA;
+    resizePixels(image, PNG_IMAGE_SIZE(png));
+    if (!png_image_finish_read(&png, nullptr, image.pixels.data(), 0, nullptr)) {
+        logError(std::string("Failed to decode PNG image: ") + png.message);
+        png_image_free(&png);
+        return false;
+    }
+    return true;
+}
+
+bool ImageLoader::decodeJPG(const unsigned char *data, size_t size, ImageData &image, unsigned int targetWidth,
+                            unsigned int targetHeight) {
     struct jpeg_decompress_struct cinfo;
-    struct jpeg_error_mgr jerr;
-    cinfo.err = jpeg_std_error(&jerr);
+    JPGErrorManager errorManager;
+    cinfo.err = jpeg_std_error(&errorManager.base);
+    errorManager.base.error_exit = jpgErrorExit;
+    if (setjmp(errorManager.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
     jpeg_create_decompress(&cinfo);
-    jpeg_stdio_src(&cinfo, infile);
+    jpeg_mem_src(&cinfo, const_cast<unsigned char *>(data), static_cast<unsigned long>(size));
     jpeg_read_header(&cinfo, TRUE);
+    image.sourceWidth = cinfo.image_width;
+    image.sourceHeight = cinfo.image_height;
+    if (targetWidth > 0 || targetHeight > 0) {
+        for (unsigned int denominator : JPG_SCALE_DENOMINATORS) {
+            if ((cinfo.image_width + denominator - 1) / denominator >= targetWidth &&
+                (cinfo.image_height + denominator - 1) / denominator >= targetHeight) {
+                cinfo.scale_num = 1;
+                cinfo.scale_denom = denominator;
+                break;
+            }
+        }
+    }
+#ifdef JCS_ALPHA_EXTENSIONS
+    // libjpeg-turbo writes the alpha channel itself, so JPG and PNG textures share one format.
+    cinfo.out_color_space = JCS_EXT_RGBA;
+    image.format = GL_RGBA;
+#else
+    cinfo.out_color_space = JCS_RGB;
+    image.format = GL_RGB;
+#endif
     jpeg_start_decompress(&cinfo);
 
-    int rowStride = cinfo.output_width * cinfo.output_components;
-    std::vector<unsigned char> imageData(cinfo.output_width * cinfo.output_height * 3);
+    image.width = cinfo.output_width;
+    image.height = cinfo.output_height;
+    size_t rowStride = static_cast<size_t>(cinfo.output_width) * cinfo.output_components;
+    resizePixels(image, rowStride * cinfo.output_height);
 
+    JSAMPROW rows[MAX_JPG_ROWS_PER_READ];
     while (cinfo.output_scanline < cinfo.output_height) {
-        unsigned char *rowPointer = &imageData[cinfo.output_scanline * rowStride];
-        jpeg_read_scanlines(&cinfo, &rowPointer, 1);
+        int rowCount = std::min<int>(MAX_JPG_ROWS_PER_READ, cinfo.output_height - cinfo.output_scanline);
+        for (int i = 0; i < rowCount; ++i) {
+            rows[i] = &image.pixels[(cinfo.output_scanline + i) * rowStride];
+        }
+        jpeg_read_scanlines(&cinfo, rows, rowCount);
     }
     jpeg_finish_decompress(&cinfo);
     jpeg_destroy_decompress(&cinfo);
-    fclose(infile);
-
-    logTrace("JPG image width: " + std::to_string(cinfo.output_width) +
-             ", height: " + std::to_string(cinfo.output_height));
-
-    GLuint textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, cinfo.output_width, cinfo.output_height, 0, GL_RGB, GL_UNSIGNED_BYTE,
-                 imageData.data());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glBindTexture(GL_TEXTURE_2D, 0);
 
-    logDebug("Successfully loaded JPG texture with ID: " + std::to_string(textureID));
-    return textureID;
+    LOG_TRACE("JPG image width: " + std::to_string(image.width) + ", height: " + std::to_string(image.height));
+    return true;
 }
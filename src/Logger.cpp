@@ -20,10 +20,16 @@
 #include "Logger.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cctype>
 #include <chrono>
-#include <iomanip>
-#include <sstream>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <mutex>
+#include <thread>
 
 namespace LoggerConfig {
 LogLevel currentLevel = LogLevel::INFO;
@@ -32,6 +38,285 @@ void setLogLevel(LogLevel level) { currentLevel = level; }
 
 } // namespace LoggerConfig
 
+namespace {
+
+/**
+ * A log message waiting to be written.
+ */
+struct LogRecord {
+    LogLevel level = LogLevel::INFO;
+    std::chrono::system_clock::time_point time;
+    std::string message;
+};
+
+/**
+ * Formats log records. The "[HH:MM:SS" part of the timestamp is only rebuilt when the second changes.
+ */
+class RecordFormatter {
+public:
+    void format(const LogRecord &record, std::string &line) {
+        auto sinceEpoch = record.time.time_since_epoch();
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch);
+        auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(sinceEpoch - seconds).count();
+        std::time_t second = static_cast<std::time_t>(seconds.count());
+        if (second != cachedSecond) {
+            std::tm localTime;
+            localtime_r(&second, &localTime);
+            char buffer[16];
+            std::snprintf(buffer, sizeof(buffer), "[%02d:%02d:%02d.", localTime.tm_hour, localTime.tm_min,
+                          localTime.tm_sec);
+            cachedPrefix = buffer;
+            cachedSecond = second;
+        }
+
+        char millisecondBuffer[8];
+        std::snprintf(millisecondBuffer, sizeof(millisecondBuffer), "%03d]", static_cast<int>(milliseconds));
+
+        line.clear();
+        line += cachedPrefix;
+        line += millisecondBuffer;
+        line += levelTag(record.level);
+        line += record.message;
+        line += '\n';
+    }
+
+private:
+    static const char *levelTag(LogLevel level) {
+        switch (level) {
+        case LogLevel::TRACE:
+            return " [TRC] ";
+        case LogLevel::DEBUG:
+            return " [DBG] ";
+        case LogLevel::INFO:
+            return " [INF] ";
+        case LogLevel::WARN:
+            return " [WRN] ";
+        case LogLevel::ERROR:
+            return " [ERR] ";
+        }
+        return " [???] ";
+    }
+
+    std::time_t cachedSecond = -1;
+    std::string cachedPrefix;
+};
+
+/**
+ * A bounded multi-producer, single-consumer queue. Producers claim a slot with a compare-and-swap on
+ * the enqueue position; per-slot sequence numbers tell the consumer when a slot has been filled and
+ * the producers when it has been drained.
+ */
+class LogQueue {
+public:
+    static constexpr size_t CAPACITY = 4096;
+
+    LogQueue() {
+        for (size_t i = 0; i < CAPACITY; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Adds a record without blocking.
+     *
+     * @return False if the queue is full.
+     */
+    bool push(LogRecord &&record) {
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        Slot *slot;
+        for (;;) {
+            slot = &slots[position % CAPACITY];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (difference == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+        slot->record = std::move(record);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Removes the oldest record. Must only be called from the consumer thread.
+     *
+     * @return False if the queue is empty.
+     */
+    bool pop(LogRecord &record) {
+        Slot &slot = slots[dequeuePosition % CAPACITY];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1) {
+            return false;
+        }
+        record = std::move(slot.record);
+        slot.sequence.store(dequeuePosition + CAPACITY, std::memory_order_release);
+        ++dequeuePosition;
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        LogRecord record;
+    };
+
+    std::array<Slot, CAPACITY> slots;
+    alignas(64) std::atomic<size_t> enqueuePosition{0};
+    alignas(64) size_t dequeuePosition = 0;
+};
+
+/**
+ * Writes log records to the console or the log file, either directly on the logging thread or
+ * through a queue drained by a background writer thread.
+ */
+class LogWriter {
+public:
+    ~LogWriter() { stopAsync(); }
+
+    bool setLogFile(const std::string &path) {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        logFile.close();
+        logFile.clear();
+        logFile.open(path, std::ios::app);
+        return logFile.is_open();
+    }
+
+    bool startAsync() {
+        if (asyncRunning.load()) {
+            return true;
+        }
+        stopRequested.store(false);
+        writerThread = std::thread(&LogWriter::writerLoop, this);
+        asyncRunning.store(true);
+        return true;
+    }
+
+    void stopAsync() {
+        if (!asyncRunning.exchange(false)) {
+            return;
+        }
+        // Producers that saw the writer running finish their push before the writer is stopped; later
+        // producers see it stopped and write directly.
+        while (activeProducers.load() != 0) {
+            std::this_thread::yield();
+        }
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopRequested.store(true);
+        }
+        wakeCondition.notify_one();
+        writerThread.join();
+    }
+
+    void write(LogRecord &&record) {
+        activeProducers.fetch_add(1);
+        if (asyncRunning.load()) {
+            if (!queue.push(std::move(record))) {
+                droppedMessages.fetch_add(1, std::memory_order_relaxed);
+            } else if (pendingRecords.fetch_add(1) == 0) {
+                // Only the record that makes the queue non-empty wakes the writer.
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                wakeCondition.notify_one();
+            }
+            activeProducers.fetch_sub(1);
+            return;
+        }
+        activeProducers.fetch_sub(1);
+
+        std::lock_guard<std::mutex> lock(outputMutex);
+        syncFormatter.format(record, syncLine);
+        output(syncLine);
+        flush();
+    }
+
+    uint64_t getDroppedMessages() const { return droppedMessages.load(std::memory_order_relaxed); }
+
+private:
+    void writerLoop() {
+        LogRecord record;
+        std::string line;
+        for (;;) {
+            int64_t written = 0;
+            {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                while (queue.pop(record)) {
+                    asyncFormatter.format(record, line);
+                    output(line);
+                    ++written;
+                }
+                if (written > 0) {
+                    flush();
+                }
+            }
+            pendingRecords.fetch_sub(written);
+
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCondition.wait(lock, [this] { return pendingRecords.load() > 0 || stopRequested.load(); });
+            if (pendingRecords.load() <= 0) {
+                // Stopped with no producers left, so the queue is empty.
+                return;
+            }
+        }
+    }
+
+    void output(const std::string &line) {
+        if (logFile.is_open()) {
+            logFile << line;
+        } else {
+            std::cout << line;
+        }
+    }
+
+    void flush() {
+        if (logFile.is_open()) {
+            logFile.flush();
+        } else {
+            std::cout.flush();
+        }
+    }
+
+    LogQueue queue;
+    std::thread writerThread;
+    std::atomic<bool> asyncRunning{false};
+    std::atomic<bool> stopRequested{false};
+    std::atomic<uint64_t> droppedMessages{0};
+    std::atomic<unsigned int> activeProducers{0}; ///< Producers between checking asyncRunning and pushing.
+    /// Records pushed but not yet written. Counted after the push, so it can briefly drop below zero.
+    std::atomic<int64_t> pendingRecords{0};
+    std::mutex wakeMutex; ///< Guards the writer's wait on wakeCondition.
+    std::condition_variable wakeCondition;
+
+    std::mutex outputMutex; ///< Guards the outputs and the formatters.
+    std::ofstream logFile;
+    RecordFormatter syncFormatter;
+    RecordFormatter asyncFormatter;
+    std::string syncLine;
+};
+
+LogWriter &getLogWriter() {
+    static LogWriter writer;
+    return writer;
+}
+
+} // namespace
+
+namespace LoggerConfig {
+
+bool setLogFile(const std::string &path) { return getLogWriter().setLogFile(path); }
+
+void startAsyncLogging() { getLogWriter().startAsync(); }
+
+void stopAsyncLogging() { getLogWriter().stopAsync(); }
+
+uint64_t getDroppedMessages() { return getLogWriter().getDroppedMessages(); }
+
+} // namespace LoggerConfig
+
 std::string toLowerCase(const std::string &str) {
     std::string lowerStr = str;
     std::transform(lowerStr.begin(), lowerStr.end(), lowerStr.begin(), [](unsigned char c) { return std::tolower(c); });
@@ -57,41 +342,9 @@ LogLevel stringToLogLevel(const std::string &levelStr) {
 }
 
 void logMessage(LogLevel level, const std::string &message) {
-    if (level < LoggerConfig::currentLevel) {
+    if (!isLogEnabled(level)) {
         return;
     }
 
-    auto now = std::chrono::system_clock::now();
-    auto now_ms = std::chrono::time_point_cast<std::chrono::milliseconds>(now);
-    auto in_time_t = std::chrono::system_clock::to_time_t(now);
-    auto duration_ms = now_ms.time_since_epoch().count() % 1000;
-
-    std::ostringstream timestamp;
-    std::tm *tm_ptr = std::localtime(&in_time_t);
-    timestamp << std::setfill('0') << std::setw(2) << tm_ptr->tm_hour << ':' << std::setfill('0') << std::setw(2)
-              << tm_ptr->tm_min << ':' << std::setfill('0') << std::setw(2) << tm_ptr->tm_sec << '.'
-              << std::setfill('0') << std::setw(3) << duration_ms;
-
-    std::string levelStr;
-    switch (level) {
-    case LogLevel::TRACE:
-        levelStr = " [TRC] ";
-        break;
-    case LogLevel::DEBUG:
-        levelStr = " [DBG] ";
-        break;
-    case LogLevel::INFO:
-        levelStr = " [INF] ";
-        break;
-    case LogLevel::WARN:
-        levelStr = " [WRN] ";
-        break;
-    case LogLevel::ERROR:
-        levelStr = " [ERR] ";
-        break;
-    }
-
-    std::ostringstream logEntry;
-    logEntry << "[" << timestamp.str() << "]" << levelStr << message << std::endl;
-    std::cout << logEntry.str();
+    getLogWriter().write(LogRecord{level, std::chrono::system_clock::now(), message});
 }
@@ -18,9 +18,13 @@
 */
 
 #include "MetricsCollector.h"
+#include "BinaryReport.h"
 #include "ConfigurationManager.h"
 #include "HTMLReportGenerator.h"
 #include "Logger.h"
+#include "RegressionAnalyzer.h"
+#include "Statistics.h"
+#include "Tracer.h"
 
 #include <algorithm>
 #include <chrono>
@@ -28,19 +32,51 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
-#include <numeric>
 #include <sstream>
 #include <sys/sysinfo.h>
+#include <utility>
 
 #include <GLES2/gl2.h>
 #include <cjson/cJSON.h>
 
-MetricsCollector::MetricsCollector() : frameCount(0), collecting(false), runtimeReport(nullptr), combinedScore(0.0) {
+namespace {
+
+/**
+ * Most per-frame work samples kept per task. Longer or unthrottled tasks keep every n-th frame, which bounds the
+ * report size and the cost of the baseline comparison.
+ */
+constexpr size_t MAX_FRAME_WORK_SAMPLES = 4096;
+
+} // namespace
+
+MetricsCollector::MetricsCollector()
+    : frameCount(0), recordFrameTimestamps(false), swapBlockThresholdMs(4.0), jankThresholdMs(0.0),
+      collecting(false), runtimeReport(nullptr), frameBudgetReport(nullptr), jankSpikeReport(nullptr),
+      combinedScore(0.0), baselineRegression(false), binaryReportFailed(false), finalizerBusy(false),
+      stopFinalizer(false) {
+    finalizerThread = std::thread(&MetricsCollector::runFinalizer, this);
     logTrace("MetricsCollector created.");
 }
 
 MetricsCollector::~MetricsCollector() {
     stopCollection();
+    {
+        std::lock_guard<std::mutex> lock(finalizerMutex);
+        stopFinalizer = true;
+    }
+    finalizerCondition.notify_all();
+    if (finalizerThread.joinable()) {
+        finalizerThread.join();
+    }
+    if (runtimeReport) {
+        cJSON_Delete(runtimeReport);
+    }
+    if (frameBudgetReport) {
+        cJSON_Delete(frameBudgetReport);
+    }
+    if (jankSpikeReport) {
+        cJSON_Delete(jankSpikeReport);
+    }
     logTrace("MetricsCollector destroyed.");
 }
 
@@ -68,10 +104,90 @@ void MetricsCollector::clearMetrics() {
     std::lock_guard<std::mutex> lock(metricsMutex);
     collectedMetrics.clear();
     frameCount = 0;
+    frameTimestamps.clear();
+    framePhases.clear();
+    jankSpikes.clear();
+    latestSamples.clear();
     logTrace("Metrics cleared for a new benchmark run.");
 }
 
-void MetricsCollector::incrementFrameCount() { ++frameCount; }
+void MetricsCollector::finishTask(const std::string &taskName, bool scored) {
+    TaskSamples samples;
+    samples.taskName = taskName;
+    samples.scored = scored;
+    {
+        std::lock_guard<std::mutex> lock(metricsMutex);
+        samples.metrics.swap(collectedMetrics);
+        samples.frameTimestamps.swap(frameTimestamps);
+        std::swap(samples.framePhases, framePhases);
+        samples.jankSpikes.swap(jankSpikes);
+        frameCount = 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(finalizerMutex);
+        pendingTasks.push_back(std::move(samples));
+    }
+    finalizerCondition.notify_all();
+    logTrace("Queued report finalization for task '" + taskName + "'.");
+}
+
+void MetricsCollector::runFinalizer() {
+    Tracer::getInstance().setThreadName("Finalizer");
+    std::unique_lock<std::mutex> lock(finalizerMutex);
+    while (true) {
+        finalizerCondition.wait(lock, [this]() { return stopFinalizer || !pendingTasks.empty(); });
+        if (pendingTasks.empty()) {
+            break;
+        }
+
+        TaskSamples samples = std::move(pendingTasks.front());
+        pendingTasks.pop_front();
+        finalizerBusy = true;
+        lock.unlock();
+
+        {
+            TraceScope finalizeScope("finalize report", "report");
+            addFrameWorkMetric(samples);
+            createBenchmarkReport(samples);
+            createFrameBudgetReport(samples);
+            createJankSpikeReport(samples);
+        }
+
+        lock.lock();
+        finalizerBusy = false;
+        finalizerCondition.notify_all();
+    }
+}
+
+void MetricsCollector::waitForFinalizer() {
+    std::unique_lock<std::mutex> lock(finalizerMutex);
+    finalizerCondition.wait(lock, [this]() { return pendingTasks.empty() && !finalizerBusy; });
+}
+
+void MetricsCollector::incrementFrameCount() {
+    ++frameCount;
+    if (recordFrameTimestamps) {
+        auto now = std::chrono::steady_clock::now();
+        frameTimestamps.push_back(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - startBenchTime).count());
+    }
+}
+
+void MetricsCollector::recordFramePhases(double updateMs, double renderMs, double displayMs, double sleepMs) {
+    framePhases.update.push_back(updateMs);
+    framePhases.render.push_back(renderMs);
+    framePhases.display.push_back(displayMs);
+    framePhases.sleep.push_back(sleepMs);
+}
+
+void MetricsCollector::recordJankSpike(JankSpike &&spike) {
+    {
+        std::lock_guard<std::mutex> lock(metricsMutex);
+        spike.collectorSamples = latestSamples;
+    }
+    jankSpikes.push_back(std::move(spike));
+}
 
 void MetricsCollector::collectStaticSystemInfo() {
     std::ifstream versionFile("/version.txt");
@@ -134,6 +250,8 @@ void MetricsCollector::collectStaticSystemInfo() {
     toolInfo["Benchmark duration (s)"] = configManager.getValue("benchmark_duration");
     toolInfo["Sampling rate (ms)"] = configManager.getValue("sampling_rate");
     toolInfo["Window size"] = configManager.getValue("window_width") + "x" + configManager.getValue("window_height");
+    recordFrameTimestamps = configManager.getValue("binary_report") == "true";
+    swapBlockThresholdMs = std::stod(configManager.getValue("swap_block_threshold"));
 
     auto now = std::chrono::system_clock::now();
     auto nowTime = std::chrono::system_clock::to_time_t(now);
@@ -157,7 +275,10 @@ void MetricsCollector::collectRuntimeMetrics() {
     double fps = 0.0;
     double frameTimeMs = 0.0;
     logTrace("Starting dynamic metrics collection.");
+    Tracer &tracer = Tracer::getInstance();
+    tracer.setThreadName("Collector");
     while (collecting) {
+        uint64_t sampleTraceStart = tracer.now();
         startTime = std::chrono::steady_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::seconds>(startTime - lastTime).count();
 
@@ -185,6 +306,7 @@ void MetricsCollector::collectRuntimeMetrics() {
         recordMetric("System memory usage", getSystemMemoryUsage(), MetricType::GAUGE);
 
         collectPlatformMetrics();
+        tracer.record("sample", "collector", sampleTraceStart, tracer.now());
 
         endTime = std::chrono::steady_clock::now();
         auto elapsedTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
@@ -197,16 +319,11 @@ void MetricsCollector::collectRuntimeMetrics() {
     logTrace("Dynamic metrics collection finished.");
 }
 
-std::string formatToTwoDecimalPlaces(double value) {
-    std::ostringstream out;
-    out << std::fixed << std::setprecision(2) << value;
-    return out.str();
-}
-
-void MetricsCollector::createBenchmarkReport(const std::string &taskName) {
+void MetricsCollector::createBenchmarkReport(const TaskSamples &samples) {
+    const std::string &taskName = samples.taskName;
     cJSON *runtimeMetricsJson = cJSON_CreateObject();
 
-    for (const auto &metricEntry : collectedMetrics) {
+    for (const auto &metricEntry : samples.metrics) {
         const std::string &metricName = metricEntry.first;
         const MetricData &metricData = metricEntry.second;
 
@@ -214,35 +331,33 @@ void MetricsCollector::createBenchmarkReport(const std::string &taskName) {
 
         if (!metricData.values.empty()) {
 
-            if (metricData.type == MetricType::GAUGE) {
-                double sum = std::accumulate(metricData.values.begin(), metricData.values.end(), 0.0);
-                double avgVal = sum / metricData.values.size();
-                double minVal = *std::min_element(metricData.values.begin(), metricData.values.end());
-                double maxVal = *std::max_element(metricData.values.begin(), metricData.values.end());
-
-                double variance = 0.0;
-                for (double value : metricData.values) {
-                    variance += std::pow(value - avgVal, 2);
+            if (metricData.type != MetricType::COUNTER) {
+                SummaryStatistics stats = Statistics::summarize(metricData.values);
+
+                cJSON_AddStringToObject(metricJson, "average", Statistics::formatTwoDecimals(stats.average).c_str());
+                cJSON_AddStringToObject(metricJson, "minimum", Statistics::formatTwoDecimals(stats.minimum).c_str());
+                cJSON_AddStringToObject(metricJson, "maximum", Statistics::formatTwoDecimals(stats.maximum).c_str());
+                cJSON_AddStringToObject(metricJson, "std_dev", Statistics::formatTwoDecimals(stats.stdDev).c_str());
+
+                if (metricData.type == MetricType::DISTRIBUTION) {
+                    for (double p : {50.0, 90.0, 99.0}) {
+                        std::string key = "p" + std::to_string(static_cast<int>(p));
+                        cJSON_AddStringToObject(metricJson, key.c_str(),
+                                                Statistics::formatTwoDecimals(
+                                                    Statistics::percentile(metricData.values, p)).c_str());
+                    }
                 }
-                variance /= metricData.values.size();
-                double stdDev = std::sqrt(variance);
 
-                cJSON_AddStringToObject(metricJson, "average", formatToTwoDecimalPlaces(avgVal).c_str());
-                cJSON_AddStringToObject(metricJson, "minimum", formatToTwoDecimalPlaces(minVal).c_str());
-                cJSON_AddStringToObject(metricJson, "maximum", formatToTwoDecimalPlaces(maxVal).c_str());
-                cJSON_AddStringToObject(metricJson, "std_dev", formatToTwoDecimalPlaces(stdDev).c_str());
-
-                if (metricName == "FPS") {
-                    double taskScore = ((avgVal - stdDev) / 60.0) * 1000.0;
-                    taskScore = std::clamp(taskScore, 0.0, 1000.0);
+                if (metricName == "FPS" && samples.scored) {
+                    double taskScore = Statistics::taskScore(stats);
                     combinedScore += taskScore;
-                    logDebug("Score for task '" + taskName + "': " + formatToTwoDecimalPlaces(taskScore));
+                    logDebug("Score for task '" + taskName + "': " + Statistics::formatTwoDecimals(taskScore));
                 }
             }
 
             cJSON *valuesArray = cJSON_CreateArray();
             for (double value : metricData.values) {
-                cJSON_AddItemToArray(valuesArray, cJSON_CreateString(formatToTwoDecimalPlaces(value).c_str()));
+                cJSON_AddItemToArray(valuesArray, cJSON_CreateString(Statistics::formatTwoDecimals(value).c_str()));
             }
             cJSON_AddItemToObject(metricJson, "values", valuesArray);
         }
@@ -254,9 +369,139 @@ void MetricsCollector::createBenchmarkReport(const std::string &taskName) {
     }
 
     cJSON_AddItemToObject(runtimeReport, taskName.c_str(), runtimeMetricsJson);
+
+    if (recordFrameTimestamps && !binaryReportFailed) {
+        writeBinaryTask(samples);
+    }
+    logDebug("Report for task '" + taskName + "' finalized.");
+}
+
+void MetricsCollector::addFrameWorkMetric(TaskSamples &samples) {
+    const FramePhaseSamples &phases = samples.framePhases;
+    if (phases.display.empty()) {
+        return;
+    }
+
+    // The sleep is left out: it pads every frame to the target frame rate, which would hide any change below it.
+    size_t stride = (phases.display.size() + MAX_FRAME_WORK_SAMPLES - 1) / MAX_FRAME_WORK_SAMPLES;
+    MetricData &frameWork = samples.metrics["Frame work (ms)"];
+    frameWork.type = MetricType::DISTRIBUTION;
+    frameWork.values.reserve(phases.display.size() / stride + 1);
+    for (size_t frame = 0; frame < phases.display.size(); frame += stride) {
+        frameWork.addValue(phases.update[frame] + phases.render[frame] + phases.display[frame]);
+    }
+}
+
+void MetricsCollector::createFrameBudgetReport(const TaskSamples &samples) {
+    const FramePhaseSamples &phases = samples.framePhases;
+    if (phases.display.empty()) {
+        return;
+    }
+
+    cJSON *taskJson = cJSON_CreateObject();
+    auto addPhase = [taskJson](const char *name, const std::vector<double> &values) {
+        cJSON *phaseJson = cJSON_CreateObject();
+        cJSON_AddStringToObject(phaseJson, "mean",
+                                Statistics::formatTwoDecimals(Statistics::summarize(values).average).c_str());
+        cJSON_AddStringToObject(phaseJson, "p99",
+                                Statistics::formatTwoDecimals(Statistics::percentile(values, 99.0)).c_str());
+        cJSON_AddItemToObject(taskJson, name, phaseJson);
+    };
+    addPhase("Update", phases.update);
+    addPhase("Render submit", phases.render);
+    addPhase("Swap", phases.display);
+    addPhase("Sleep", phases.sleep);
+
+    size_t blocked = std::count_if(phases.display.begin(), phases.display.end(),
+                                   [this](double displayMs) { return displayMs > swapBlockThresholdMs; });
+    cJSON_AddStringToObject(taskJson, "Swap blocked frames (%)",
+                            Statistics::formatTwoDecimals(100.0 * blocked / phases.display.size()).c_str());
+    cJSON_AddStringToObject(taskJson, "Frames", std::to_string(phases.display.size()).c_str());
+
+    if (!frameBudgetReport) {
+        frameBudgetReport = cJSON_CreateObject();
+    }
+    cJSON_AddItemToObject(frameBudgetReport, samples.taskName.c_str(), taskJson);
+}
+
+void MetricsCollector::createJankSpikeReport(const TaskSamples &samples) {
+    if (samples.jankSpikes.empty()) {
+        return;
+    }
+
+    auto formatMs = [](double value) { return Statistics::formatTwoDecimals(value); };
+    cJSON *spikesJson = cJSON_CreateArray();
+    for (const JankSpike &spike : samples.jankSpikes) {
+        const FrameRecord &frame = spike.spikeFrame;
+        cJSON *spikeJson = cJSON_CreateObject();
+        cJSON_AddStringToObject(spikeJson, "Frame", std::to_string(frame.frame).c_str());
+        cJSON_AddStringToObject(spikeJson, "Time (s)", formatMs(frame.startMs / 1000.0).c_str());
+        cJSON_AddStringToObject(spikeJson, "Frame time (ms)", formatMs(frame.totalMs()).c_str());
+        cJSON_AddStringToObject(spikeJson, "Update (ms)", formatMs(frame.updateMs).c_str());
+        cJSON_AddStringToObject(spikeJson, "Render submit (ms)", formatMs(frame.renderMs).c_str());
+        cJSON_AddStringToObject(spikeJson, "Swap (ms)", formatMs(frame.displayMs).c_str());
+        cJSON_AddStringToObject(spikeJson, "Sleep (ms)", formatMs(frame.sleepMs).c_str());
+        cJSON_AddStringToObject(spikeJson, "Voluntary context switches",
+                                std::to_string(spike.voluntaryContextSwitches).c_str());
+        cJSON_AddStringToObject(spikeJson, "Involuntary context switches",
+                                std::to_string(spike.involuntaryContextSwitches).c_str());
+        cJSON_AddStringToObject(spikeJson, "Load average", spike.loadAverage.c_str());
+
+        cJSON *collectorJson = cJSON_CreateObject();
+        for (const auto &sample : spike.collectorSamples) {
+            cJSON_AddStringToObject(collectorJson, sample.first.c_str(), formatMs(sample.second).c_str());
+        }
+        cJSON_AddItemToObject(spikeJson, "Collector samples", collectorJson);
+
+        // The history is stored per phase, like the values of a metric, so it can be charted directly.
+        cJSON *historyJson = cJSON_CreateObject();
+        auto addSeries = [historyJson, &spike, &formatMs](const char *name, float (*value)(const FrameRecord &)) {
+            cJSON *valuesArray = cJSON_CreateArray();
+            for (const FrameRecord &record : spike.history) {
+                cJSON_AddItemToArray(valuesArray, cJSON_CreateString(formatMs(value(record)).c_str()));
+            }
+            cJSON_AddItemToObject(historyJson, name, valuesArray);
+        };
+        addSeries("Frame time (ms)", [](const FrameRecord &record) { return record.totalMs(); });
+        addSeries("Update (ms)", [](const FrameRecord &record) { return record.updateMs; });
+        addSeries("Render submit (ms)", [](const FrameRecord &record) { return record.renderMs; });
+        addSeries("Swap (ms)", [](const FrameRecord &record) { return record.displayMs; });
+        addSeries("Sleep (ms)", [](const FrameRecord &record) { return record.sleepMs; });
+        cJSON_AddItemToObject(spikeJson, "History", historyJson);
+        cJSON_AddItemToArray(spikesJson, spikeJson);
+    }
+
+    if (!jankSpikeReport) {
+        jankSpikeReport = cJSON_CreateObject();
+    }
+    cJSON_AddItemToObject(jankSpikeReport, samples.taskName.c_str(), spikesJson);
 }
 
-cJSON *MetricsCollector::createJSONReport(const std::string &filePath, int tasks) const {
+void MetricsCollector::writeBinaryTask(const TaskSamples &samples) {
+    const std::string &taskName = samples.taskName;
+    if (!binaryReport) {
+        std::string filePath = ConfigurationManager::getInstance().getValue("output_dir") + "/valyria_report.vbr";
+        binaryReport = std::make_unique<BinaryReportWriter>();
+        if (!binaryReport->open(filePath, staticInfo, toolInfo)) {
+            logError("Failed to create the binary report: " + filePath);
+            binaryReportFailed = true;
+            binaryReport.reset();
+            return;
+        }
+    }
+
+    binaryReport->beginTask(taskName, samples.scored, samples.metrics.size() + 1);
+    binaryReport->writeTimestampColumn(BinaryReport::FRAME_TIMESTAMP_COLUMN, samples.frameTimestamps);
+    for (const auto &metricEntry : samples.metrics) {
+        binaryReport->writeFloatColumn(metricEntry.first, static_cast<uint8_t>(metricEntry.second.type),
+                                       metricEntry.second.values);
+    }
+    if (!binaryReport->endTask()) {
+        logError("Failed to write task '" + taskName + "' to the binary report.");
+    }
+}
+
+cJSON *MetricsCollector::createJSONReport(const std::string &filePath, int tasks) {
     logDebug("Creating the JSON report");
     cJSON *reportJson = cJSON_CreateObject();
 
@@ -278,8 +523,26 @@ cJSON *MetricsCollector::createJSONReport(const std::string &filePath, int tasks
         logWarn("No benchmark results to include in the report.");
     }
 
+    if (frameBudgetReport) {
+        cJSON *frameBudgetJson = cJSON_CreateObject();
+        cJSON_AddStringToObject(frameBudgetJson, "Swap block threshold (ms)",
+                                Statistics::formatTwoDecimals(swapBlockThresholdMs).c_str());
+        cJSON_AddItemToObject(frameBudgetJson, "Tasks", cJSON_Duplicate(frameBudgetReport, true));
+        cJSON_AddItemToObject(reportJson, "Frame Budget", frameBudgetJson);
+    }
+
+    if (jankSpikeReport) {
+        cJSON *jankSpikesJson = cJSON_CreateObject();
+        cJSON_AddStringToObject(jankSpikesJson, "Threshold (ms)",
+                                Statistics::formatTwoDecimals(jankThresholdMs).c_str());
+        cJSON_AddItemToObject(jankSpikesJson, "Tasks", cJSON_Duplicate(jankSpikeReport, true));
+        cJSON_AddItemToObject(reportJson, "Jank Spikes", jankSpikesJson);
+    }
+
     cJSON_AddStringToObject(reportJson, "Score", std::to_string(static_cast<int>(std::round(combinedScore / tasks))).c_str());
 
+    baselineRegression = !compareWithBaselines(reportJson);
+
     char *jsonString = cJSON_Print(reportJson);
     if (!jsonString) {
         logError("Failed to create JSON report string.");
@@ -302,7 +565,43 @@ cJSON *MetricsCollector::createJSONReport(const std::string &filePath, int tasks
     return reportJson;
 }
 
-void MetricsCollector::createReport(int tasks) {
+bool MetricsCollector::compareWithBaselines(cJSON *reportJson) const {
+    ConfigurationManager &configManager = ConfigurationManager::getInstance();
+    std::string baselines = configManager.getValue("baseline");
+    if (baselines.empty()) {
+        return true;
+    }
+
+    RegressionAnalyzer analyzer(std::stod(configManager.getValue("regression_threshold")),
+                                std::stod(configManager.getValue("significance_level")));
+    std::istringstream baselineStream(baselines);
+    std::string baselinePath;
+    bool loaded = false;
+    while (std::getline(baselineStream, baselinePath, ',')) {
+        if (!baselinePath.empty()) {
+            loaded = analyzer.loadBaseline(baselinePath) || loaded;
+        }
+    }
+    if (!loaded) {
+        logError("None of the baseline reports could be loaded; skipping the comparison.");
+        return true;
+    }
+
+    std::vector<TaskComparison> comparisons = analyzer.compare(cJSON_GetObjectItem(reportJson, "Benchmark Results"));
+    cJSON_AddItemToObject(reportJson, "Baseline Comparison", analyzer.createJSON(comparisons));
+
+    size_t regressions = std::count_if(comparisons.begin(), comparisons.end(),
+                                       [](const TaskComparison &comparison) { return comparison.regression; });
+    if (regressions > 0) {
+        logError(std::to_string(regressions) + " task(s) regressed against the baseline.");
+        return false;
+    }
+    logInfo("No significant regressions against the baseline.");
+    return true;
+}
+
+bool MetricsCollector::createReport(int tasks) {
+    waitForFinalizer();
     logDebug("Creating the reports");
     std::string output_dir = ConfigurationManager::getInstance().getValue("output_dir");
     cJSON *reportJson = createJSONReport(output_dir + "/valyria_report.json", tasks);
@@ -314,16 +613,31 @@ void MetricsCollector::createReport(int tasks) {
         logInfo("JSON report: " + output_dir + "/valyria_report.json");
         logInfo("HTML report: " + output_dir + "/valyria_report.html");
     }
+
+    if (binaryReport) {
+        if (binaryReport->close()) {
+            logInfo("Binary report: " + output_dir + "/valyria_report.vbr");
+        } else {
+            logError("Failed to finalize the binary report.");
+        }
+        binaryReport.reset();
+    }
+
+    return !baselineRegression;
 }
 
 void MetricsCollector::recordMetric(const std::string &name, double value, MetricType type) {
     std::lock_guard<std::mutex> lock(metricsMutex);
+    if (collecting) {
+        // While the render loop runs, only the background collection records metrics.
+        latestSamples[name] = value;
+    }
     if (collectedMetrics.find(name) == collectedMetrics.end()) {
         collectedMetrics[name] = MetricData{type, {value}};
     } else {
         collectedMetrics[name].addValue(value);
     }
-    logTrace("Metric recorded: " + name + " = " + std::to_string(value));
+    LOG_TRACE("Metric recorded: " + name + " = " + std::to_string(value));
 }
 
 double MetricsCollector::getCPULoad() const {
@@ -352,7 +666,7 @@ double MetricsCollector::getCPULoad() const {
     prevSystem = system;
     prevIdle = idle;
 
-    logTrace("CPU Load: " + std::to_string(usage));
+    LOG_TRACE("CPU Load: " + std::to_string(usage));
     return usage;
 }
 
@@ -363,7 +677,7 @@ double MetricsCollector::getCPUTemperature() const {
         tempFile >> temp;
         tempFile.close();
         double temperature = temp / 1000.0;
-        logTrace("CPU Temperature: " + std::to_string(temperature));
+        LOG_TRACE("CPU Temperature: " + std::to_string(temperature));
         return temperature;
     }
     logWarn("Failed to read CPU temperature.");
@@ -376,7 +690,7 @@ double MetricsCollector::getSystemMemoryUsage() const {
         double totalMemory = sysInfo.totalram * sysInfo.mem_unit;
         double freeMemory = sysInfo.freeram * sysInfo.mem_unit;
         double usage = ((totalMemory - freeMemory) / totalMemory) * 100.0;
-        logTrace("System Memory Usage: " + std::to_string(usage));
+        LOG_TRACE("System Memory Usage: " + std::to_string(usage));
         return usage;
     }
     logWarn("Failed to retrieve system information for system memory usage.");
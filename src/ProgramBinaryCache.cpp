@@ -0,0 +1,217 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "ProgramBinaryCache.h"
+#include "GraphicsContext.h"
+#include "Logger.h"
+
+#include <EGL/egl.h>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char ENTRY_MAGIC[4] = {'V', 'P', 'B', 'C'};
+constexpr const char *DRIVER_FILE = "driver.id";
+constexpr const char *ENTRY_EXTENSION = ".bin";
+
+struct EntryHeader {
+    char magic[4];
+    uint32_t format;
+    uint64_t key;
+    uint32_t length;
+};
+
+} // namespace
+
+ProgramBinaryCache::ProgramBinaryCache() : enabled(false), getProgramBinary(nullptr), programBinary(nullptr) {}
+
+bool ProgramBinaryCache::initialize(const std::string &cacheDir) {
+    enabled = false;
+    if (cacheDir.empty() || cacheDir == "none") {
+        logDebug("Program binary cache disabled.");
+        return false;
+    }
+
+    GLint formatCount = 0;
+    if (GraphicsContext::isExtensionSupported("GL_OES_get_program_binary")) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formatCount);
+    }
+    if (formatCount <= 0) {
+        logInfo("GL_OES_get_program_binary is not supported; programs are always built from source.");
+        return false;
+    }
+
+    getProgramBinary = reinterpret_cast<PFNGLGETPROGRAMBINARYOESPROC>(eglGetProcAddress("glGetProgramBinaryOES"));
+    programBinary = reinterpret_cast<PFNGLPROGRAMBINARYOESPROC>(eglGetProcAddress("glProgramBinaryOES"));
+    if (!getProgramBinary || !programBinary) {
+        logWarn("Failed to resolve the GL_OES_get_program_binary entry points.");
+        return false;
+    }
+
+    const char *renderer = reinterpret_cast<const char *>(glGetString(GL_RENDERER));
+    const char *version = reinterpret_cast<const char *>(glGetString(GL_VERSION));
+    std::string driverIdentity = std::string(renderer ? renderer : "Unknown") + "\n" + (version ? version : "Unknown");
+
+    directory = cacheDir;
+    if (!validateDriver(driverIdentity)) {
+        return false;
+    }
+
+    enabled = true;
+    logInfo("Program binary cache: " + directory);
+    return true;
+}
+
+bool ProgramBinaryCache::validateDriver(const std::string &driverIdentity) {
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if (error) {
+        logError("Failed to create the program binary cache directory: " + directory);
+        return false;
+    }
+
+    std::string driverPath = directory + "/" + DRIVER_FILE;
+    std::ifstream driverIn(driverPath);
+    std::stringstream cachedIdentity;
+    cachedIdentity << driverIn.rdbuf();
+    driverIn.close();
+    if (cachedIdentity.str() == driverIdentity) {
+        return true;
+    }
+
+    // Binaries are only valid for the driver that produced them.
+    unsigned int removed = 0;
+    for (const auto &entry : fs::directory_iterator(directory, error)) {
+        if (entry.path().extension() == ENTRY_EXTENSION && fs::remove(entry.path(), error)) {
+            ++removed;
+        }
+    }
+    if (removed > 0) {
+        logInfo("Driver changed; discarded " + std::to_string(removed) + " cached program binaries.");
+    }
+
+    std::ofstream driverOut(driverPath, std::ios::trunc);
+    driverOut << driverIdentity;
+    if (!driverOut) {
+        logError("Failed to write the program binary cache driver identity: " + driverPath);
+        return false;
+    }
+    return true;
+}
+
+std::string ProgramBinaryCache::entryPath(uint64_t key) const {
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+    return directory + "/" + name + ENTRY_EXTENSION;
+}
+
+bool ProgramBinaryCache::load(GLuint programID, uint64_t key) {
+    if (!enabled) {
+        return false;
+    }
+
+    std::string path = entryPath(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    EntryHeader header;
+    std::vector<char> binary;
+    bool valid = static_cast<bool>(file.read(reinterpret_cast<char *>(&header), sizeof(header))) &&
+                 std::memcmp(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC)) == 0 && header.key == key;
+    if (valid) {
+        binary.resize(header.length);
+        valid = static_cast<bool>(file.read(binary.data(), binary.size()));
+    }
+    file.close();
+
+    GLint linked = GL_FALSE;
+    if (valid) {
+        programBinary(programID, header.format, binary.data(), static_cast<GLint>(binary.size()));
+        glGetProgramiv(programID, GL_LINK_STATUS, &linked);
+    }
+    if (linked != GL_TRUE) {
+        logWarn("Discarding unusable program binary: " + path);
+        std::remove(path.c_str());
+        return false;
+    }
+
+    logTrace("Program binary loaded from: " + path);
+    return true;
+}
+
+bool ProgramBinaryCache::store(GLuint programID, uint64_t key) {
+    if (!enabled) {
+        return false;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+    if (length <= 0) {
+        return false;
+    }
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    getProgramBinary(programID, length, &written, &format, binary.data());
+    if (written <= 0) {
+        logWarn("Failed to retrieve the program binary.");
+        return false;
+    }
+
+    EntryHeader header;
+    std::memcpy(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC));
+    header.format = format;
+    header.key = key;
+    header.length = static_cast<uint32_t>(written);
+
+    // Write to a temporary file first so that an interrupted run never leaves a partial entry.
+    std::string path = entryPath(key);
+    std::string temporaryPath = path + ".tmp";
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(binary.data(), written);
+    file.close();
+    if (!file || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        logWarn("Failed to write program binary: " + path);
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    logTrace("Program binary stored to: " + path);
+    return true;
+}
+
+uint64_t ProgramBinaryCache::hash(const std::string &data, uint64_t seed) {
+    uint64_t value = seed;
+    for (unsigned char c : data) {
+        value ^= c;
+        value *= 0x100000001b3ULL;
+    }
+    return value;
+}
@@ -0,0 +1,151 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "RegressionAnalyzer.h"
+#include "Logger.h"
+#include "Statistics.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+RegressionAnalyzer::RegressionAnalyzer(double thresholdPercent, double significanceLevel)
+    : thresholdPercent(thresholdPercent), significanceLevel(significanceLevel) {}
+
+std::vector<double> RegressionAnalyzer::extractSamples(const cJSON *task) {
+    std::vector<double> samples;
+    cJSON *metric = cJSON_GetObjectItem(task, COMPARED_METRIC);
+    cJSON *values = metric ? cJSON_GetObjectItem(metric, "values") : nullptr;
+    cJSON *value = nullptr;
+    cJSON_ArrayForEach(value, values) {
+        samples.push_back(cJSON_IsString(value) ? std::strtod(value->valuestring, nullptr) : value->valuedouble);
+    }
+    return samples;
+}
+
+bool RegressionAnalyzer::loadBaseline(const std::string &filePath) {
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        logError("Failed to open baseline report: " + filePath);
+        return false;
+    }
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    cJSON *report = cJSON_Parse(buffer.str().c_str());
+    if (!report) {
+        logError("Failed to parse baseline report: " + filePath);
+        return false;
+    }
+
+    cJSON *results = cJSON_GetObjectItem(report, "Benchmark Results");
+    cJSON *task = nullptr;
+    cJSON_ArrayForEach(task, results) {
+        std::vector<double> samples = extractSamples(task);
+        std::vector<double> &pooled = baselineSamples[task->string];
+        pooled.insert(pooled.end(), samples.begin(), samples.end());
+    }
+    cJSON_Delete(report);
+
+    baselineFiles.push_back(filePath);
+    logInfo("Loaded baseline report: " + filePath);
+    return true;
+}
+
+std::vector<TaskComparison> RegressionAnalyzer::compare(const cJSON *benchmarkResults) const {
+    std::vector<TaskComparison> comparisons;
+    cJSON *task = nullptr;
+    cJSON_ArrayForEach(task, benchmarkResults) {
+        auto baseline = baselineSamples.find(task->string);
+        if (baseline == baselineSamples.end() || baseline->second.empty()) {
+            logWarn("No baseline data for task '" + std::string(task->string) + "'.");
+            continue;
+        }
+
+        std::vector<double> current = extractSamples(task);
+        if (current.empty()) {
+            continue;
+        }
+
+        TaskComparison comparison;
+        comparison.taskName = task->string;
+        comparison.baselineSamples = baseline->second.size();
+        comparison.currentSamples = current.size();
+        comparison.baselineMedian = Statistics::median(baseline->second);
+        comparison.currentMedian = Statistics::median(current);
+        if (comparison.baselineMedian > 0.0) {
+            comparison.changePercent = (comparison.currentMedian / comparison.baselineMedian - 1.0) * 100.0;
+        }
+        comparison.pValue = Statistics::mannWhitneyPValue(baseline->second, current);
+        std::pair<double, double> ci = Statistics::bootstrapMedianChangeCI(baseline->second, current);
+        comparison.ciLowPercent = ci.first;
+        comparison.ciHighPercent = ci.second;
+
+        bool significant = comparison.pValue < significanceLevel;
+        comparison.regression = significant && comparison.changePercent > thresholdPercent && ci.first > 0.0;
+        comparison.improvement = significant && comparison.changePercent < -thresholdPercent && ci.second < 0.0;
+
+        if (comparison.regression) {
+            logError("Regression in '" + comparison.taskName + "': median frame work " +
+                     Statistics::formatTwoDecimals(comparison.baselineMedian) + " -> " +
+                     Statistics::formatTwoDecimals(comparison.currentMedian) + " ms (" +
+                     Statistics::formatTwoDecimals(comparison.changePercent) + "%, p=" +
+                     std::to_string(comparison.pValue) + ")");
+        }
+        comparisons.push_back(comparison);
+    }
+    return comparisons;
+}
+
+cJSON *RegressionAnalyzer::createJSON(const std::vector<TaskComparison> &comparisons) const {
+    cJSON *comparisonJson = cJSON_CreateObject();
+
+    std::string baselines;
+    for (const auto &file : baselineFiles) {
+        baselines += (baselines.empty() ? "" : ", ") + file;
+    }
+    cJSON_AddStringToObject(comparisonJson, "Baselines", baselines.c_str());
+    cJSON_AddStringToObject(comparisonJson, "Metric", COMPARED_METRIC);
+    cJSON_AddStringToObject(comparisonJson, "Threshold (%)", Statistics::formatTwoDecimals(thresholdPercent).c_str());
+    cJSON_AddStringToObject(comparisonJson, "Significance level", std::to_string(significanceLevel).c_str());
+
+    cJSON *tasksJson = cJSON_CreateObject();
+    for (const auto &comparison : comparisons) {
+        cJSON *taskJson = cJSON_CreateObject();
+        cJSON_AddStringToObject(taskJson, "baseline_median",
+                                Statistics::formatTwoDecimals(comparison.baselineMedian).c_str());
+        cJSON_AddStringToObject(taskJson, "current_median",
+                                Statistics::formatTwoDecimals(comparison.currentMedian).c_str());
+        cJSON_AddStringToObject(taskJson, "change_percent",
+                                Statistics::formatTwoDecimals(comparison.changePercent).c_str());
+        cJSON_AddStringToObject(taskJson, "ci_low_percent",
+                                Statistics::formatTwoDecimals(comparison.ciLowPercent).c_str());
+        cJSON_AddStringToObject(taskJson, "ci_high_percent",
+                                Statistics::formatTwoDecimals(comparison.ciHighPercent).c_str());
+        cJSON_AddStringToObject(taskJson, "p_value", std::to_string(comparison.pValue).c_str());
+        cJSON_AddStringToObject(taskJson, "baseline_samples", std::to_string(comparison.baselineSamples).c_str());
+        cJSON_AddStringToObject(taskJson, "current_samples", std::to_string(comparison.currentSamples).c_str());
+        cJSON_AddStringToObject(taskJson, "status",
+                                comparison.regression ? "regression"
+                                                      : (comparison.improvement ? "improvement" : "unchanged"));
+        cJSON_AddItemToObject(tasksJson, comparison.taskName.c_str(), taskJson);
+    }
+    cJSON_AddItemToObject(comparisonJson, "Tasks", tasksJson);
+    return comparisonJson;
+}
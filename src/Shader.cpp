@@ -19,29 +19,49 @@
 
 #include "Shader.h"
 #include "ConfigurationManager.h"
+#include "EmbeddedShaders.h"
 #include "Logger.h"
 
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <vector>
 
+namespace {
+
+/**
+ * Value of the `shader_dir` option that selects the shaders compiled into the binary.
+ */
+constexpr const char *EMBEDDED_SHADER_DIR = "embedded";
+
+const EmbeddedShader *findEmbeddedShader(const std::string &fileName) {
+    for (size_t i = 0; i < EMBEDDED_SHADER_COUNT; ++i) {
+        if (fileName == EMBEDDED_SHADERS[i].fileName) {
+            return &EMBEDDED_SHADERS[i];
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
 Shader::Shader(GLenum type, const std::string &fileName) : type(type), shaderID(0), filename(fileName) {}
 
 Shader::~Shader() { release(); }
 
-bool Shader::compile() {
+bool Shader::compile() { return compile(loadShaderFromFile(filename)); }
+
+bool Shader::compile(const std::string &source, bool wait) {
     logTrace("Compiling " + std::string((type == GL_VERTEX_SHADER ? "Vertex" : "Fragment")) +
              " shader using file: " + filename);
-    shaderID = glCreateShader(type);
-    if (shaderID == 0) {
-        logError("Failed to create shader.");
+    if (source.empty()) {
         return false;
     }
 
-    std::string source = loadShaderFromFile(filename);
-    if (source.empty()) {
-        glDeleteShader(shaderID);
-        shaderID = 0;
+    shaderID = glCreateShader(type);
+    if (shaderID == 0) {
+        logError("Failed to create shader.");
         return false;
     }
 
@@ -49,6 +69,14 @@ bool Shader::compile() {
     glShaderSource(shaderID, 1, &src, nullptr);
     glCompileShader(shaderID);
 
+    return wait ? checkCompileStatus() : true;
+}
+
+bool Shader::checkCompileStatus() {
+    if (shaderID == 0) {
+        return false;
+    }
+
     GLint success;
     glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
     if (!success) {
@@ -84,7 +112,19 @@ void Shader::logShaderError() const {
 }
 
 std::string Shader::loadShaderFromFile(const std::string &fileName) {
-    std::string fullPath = ConfigurationManager::getInstance().getValue("asset_dir") + "/" + fileName;
+    ConfigurationManager &configManager = ConfigurationManager::getInstance();
+    std::string shaderDir = configManager.getValue("shader_dir");
+    if (shaderDir == EMBEDDED_SHADER_DIR) {
+        const EmbeddedShader *embedded = findEmbeddedShader(fileName);
+        if (embedded) {
+            logTrace("Shader file loaded from the embedded assets: " + fileName);
+            return std::string(embedded->source, embedded->size);
+        }
+        // Shaders added to the asset directory after the build are still found there.
+        shaderDir = configManager.getValue("asset_dir");
+    }
+
+    std::string fullPath = shaderDir + "/" + fileName;
     std::ifstream file(fullPath);
 
     if (!file.is_open()) {
@@ -99,3 +139,44 @@ std::string Shader::loadShaderFromFile(const std::string &fileName) {
     logTrace("Shader file loaded from: " + fullPath);
     return buffer.str();
 }
+
+std::vector<std::string> Shader::listShaderFiles(const std::string &extension) {
+    ConfigurationManager &configManager = ConfigurationManager::getInstance();
+    std::string shaderDir = configManager.getValue("shader_dir");
+    std::vector<std::string> fileNames;
+
+    auto hasExtension = [&extension](const std::string &fileName) {
+        return fileName.size() > extension.size() &&
+               fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0;
+    };
+    if (shaderDir == EMBEDDED_SHADER_DIR) {
+        for (size_t i = 0; i < EMBEDDED_SHADER_COUNT; ++i) {
+            if (hasExtension(EMBEDDED_SHADERS[i].fileName)) {
+                fileNames.push_back(EMBEDDED_SHADERS[i].fileName);
+            }
+        }
+        shaderDir = configManager.getValue("asset_dir");
+    }
+
+    std::error_code error;
+    for (const auto &entry : std::filesystem::directory_iterator(shaderDir, error)) {
+        std::string fileName = entry.path().filename().string();
+        if (hasExtension(fileName) && std::find(fileNames.begin(), fileNames.end(), fileName) == fileNames.end()) {
+            fileNames.push_back(fileName);
+        }
+    }
+    std::sort(fileNames.begin(), fileNames.end());
+    return fileNames;
+}
+
+std::string Shader::injectDefine(const std::string &source, const std::string &define) {
+    std::string line = "#define " + define + "\n";
+    if (source.compare(0, 8, "#version") == 0) {
+        size_t lineEnd = source.find('\n');
+        if (lineEnd == std::string::npos) {
+            return source + "\n" + line;
+        }
+        return source.substr(0, lineEnd + 1) + line + source.substr(lineEnd + 1);
+    }
+    return line + source;
+}
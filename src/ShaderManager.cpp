@@ -18,52 +18,263 @@
 */
 
 #include "ShaderManager.h"
+#include "GraphicsContext.h"
 #include "Logger.h"
+#include "ShaderPreprocessor.h"
+#include "Statistics.h"
+
+#include <EGL/egl.h>
+#include <chrono>
+#include <thread>
 
 ShaderManager &ShaderManager::getInstance() {
     static ShaderManager instance;
     return instance;
 }
 
-ShaderManager::ShaderManager() {  }
+ShaderManager::ShaderManager() : parallelCompileSupported(false), measureNonce(0) {}
 
 ShaderManager::~ShaderManager() { }
 
-bool ShaderManager::createShaderProgram(const std::string &programName, const std::string &vertexSource,
-                                        const std::string &fragmentSource) {
+void ShaderManager::initialize(const std::string &programBinaryCacheDir) {
+    programBinaryCache.initialize(programBinaryCacheDir);
+
+    parallelCompileSupported = false;
+    if (GraphicsContext::isExtensionSupported("GL_KHR_parallel_shader_compile")) {
+        auto maxShaderCompilerThreads = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(
+            eglGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+        if (maxShaderCompilerThreads) {
+            // 0xFFFFFFFF lets the driver pick the number of compiler threads.
+            maxShaderCompilerThreads(0xFFFFFFFF);
+            parallelCompileSupported = true;
+        }
+    }
+    logInfo(std::string("Parallel shader compilation: ") + (parallelCompileSupported ? "supported" : "not supported"));
+}
+
+ShaderProgramHandle ShaderManager::createShaderProgram(const std::string &programName,
+                                                       const std::string &vertexSource,
+                                                       const std::string &fragmentSource,
+                                                       const std::vector<std::string> &defines) {
     if (shaderPrograms.find(programName) != shaderPrograms.end()) {
         logWarn("Shader program '" + programName + "' already exists. Creation skipped.");
+        return ShaderProgramHandle();
+    }
+
+    auto pendingIt = pendingPrograms.find(programName);
+    if (pendingIt != pendingPrograms.end()) {
+        PendingProgram pending = std::move(pendingIt->second);
+        pendingPrograms.erase(pendingIt);
+        if (pending.vertexFile == vertexSource && pending.fragmentFile == fragmentSource &&
+            pending.defines == defines) {
+            return finishProgram(programName, pending);
+        }
+        logWarn("Preloaded shader program '" + programName + "' uses different shaders. Rebuilding it.");
+    }
+
+    PendingProgram pending;
+    if (!startProgram(programName, vertexSource, fragmentSource, defines, true, pending)) {
+        return ShaderProgramHandle();
+    }
+    return finishProgram(programName, pending);
+}
+
+void ShaderManager::preloadShaderPrograms(const std::vector<ShaderProgramSource> &programs) {
+    if (!parallelCompileSupported) {
+        return;
+    }
+
+    for (const auto &source : programs) {
+        if (shaderPrograms.count(source.programName) || pendingPrograms.count(source.programName)) {
+            continue;
+        }
+        PendingProgram pending;
+        if (startProgram(source.programName, source.vertexFile, source.fragmentFile, source.defines, false,
+                         pending)) {
+            pendingPrograms[source.programName] = std::move(pending);
+            logTrace("Shader program '" + source.programName + "' submitted for parallel compilation.");
+        }
+    }
+}
+
+bool ShaderManager::isShaderProgramReady(const std::string &programName) const {
+    auto pendingIt = pendingPrograms.find(programName);
+    if (pendingIt == pendingPrograms.end()) {
+        return shaderPrograms.find(programName) != shaderPrograms.end();
+    }
+    return pendingIt->second.fromBinary || pendingIt->second.program->isLinkComplete();
+}
+
+bool ShaderManager::measureParallelCompile(const std::vector<ShaderProgramSource> &programs, double &serialMs,
+                                           double &parallelMs) {
+    if (!parallelCompileSupported || programs.empty()) {
         return false;
     }
 
-    logTrace("Creating shaders for '" + programName + "' program.");
-    auto vertexShader = std::make_shared<Shader>(GL_VERTEX_SHADER, vertexSource);
-    auto fragmentShader = std::make_shared<Shader>(GL_FRAGMENT_SHADER, fragmentSource);
+    auto buildAll = [&](bool parallel) {
+        std::vector<GLuint> shaders;
+        std::vector<GLuint> programIDs;
+        auto start = std::chrono::steady_clock::now();
+
+        for (const auto &source : programs) {
+            std::string vertexCode;
+            std::string fragmentCode;
+            if (!preprocessShader(source.vertexFile, source.defines, vertexCode) ||
+                !preprocessShader(source.fragmentFile, source.defines, fragmentCode)) {
+                continue;
+            }
+
+            // A unique define per build keeps the driver from reusing the other pass's results.
+            std::string define = "VALYRIA_NONCE " + std::to_string(++measureNonce);
+            GLuint programID = glCreateProgram();
+            for (const auto &stage : {std::make_pair(GL_VERTEX_SHADER, &vertexCode),
+                                      std::make_pair(GL_FRAGMENT_SHADER, &fragmentCode)}) {
+                std::string code = Shader::injectDefine(*stage.second, define);
+                const char *src = code.c_str();
+                GLuint shaderID = glCreateShader(stage.first);
+                glShaderSource(shaderID, 1, &src, nullptr);
+                glCompileShader(shaderID);
+                if (!parallel) {
+                    GLint compiled;
+                    glGetShaderiv(shaderID, GL_COMPILE_STATUS, &compiled);
+                }
+                glAttachShader(programID, shaderID);
+                shaders.push_back(shaderID);
+            }
+            glLinkProgram(programID);
+            if (!parallel) {
+                GLint linked;
+                glGetProgramiv(programID, GL_LINK_STATUS, &linked);
+            }
+            programIDs.push_back(programID);
+        }
+
+        // Poll instead of blocking on the link status, as an application overlapping other work would.
+        bool pending = parallel;
+        while (pending) {
+            pending = false;
+            for (GLuint programID : programIDs) {
+                GLint complete = GL_TRUE;
+                glGetProgramiv(programID, GL_COMPLETION_STATUS_KHR, &complete);
+                if (complete != GL_TRUE) {
+                    pending = true;
+                    break;
+                }
+            }
+            if (pending) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+        double wallTimeMs = Statistics::elapsedMs(start, std::chrono::steady_clock::now());
+
+        for (GLuint programID : programIDs) {
+            glDeleteProgram(programID);
+        }
+        for (GLuint shaderID : shaders) {
+            glDeleteShader(shaderID);
+        }
+        return wallTimeMs;
+    };
+
+    serialMs = buildAll(false);
+    parallelMs = buildAll(true);
+    logDebug("Serial shader compilation: " + std::to_string(serialMs) + " ms, parallel: " +
+             std::to_string(parallelMs) + " ms.");
+    return true;
+}
+
+bool ShaderManager::startProgram(const std::string &programName, const std::string &vertexFile,
+                                 const std::string &fragmentFile, const std::vector<std::string> &defines, bool wait,
+                                 PendingProgram &pending) {
+    pending.vertexFile = vertexFile;
+    pending.fragmentFile = fragmentFile;
+    pending.defines = defines;
+    pending.binaryKey = 0;
+    pending.fromBinary = false;
+
+    std::string vertexCode;
+    std::string fragmentCode;
+    if (!preprocessShader(vertexFile, defines, vertexCode) || !preprocessShader(fragmentFile, defines, fragmentCode)) {
+        logError("Failed to load the shaders of program '" + programName + "'.");
+        return false;
+    }
+
+    if (programBinaryCache.isEnabled()) {
+        // The key covers the preprocessed sources, so every permutation gets its own entry.
+        pending.binaryKey = ProgramBinaryCache::hash(fragmentCode, ProgramBinaryCache::hash(vertexCode));
+        auto cachedProgram = std::make_shared<ShaderProgram>();
+        if (programBinaryCache.load(cachedProgram->getProgramID(), pending.binaryKey)) {
+            pending.program = cachedProgram;
+            pending.fromBinary = true;
+            return true;
+        }
+    }
 
-    if (!vertexShader->compile()) {
+    logTrace("Creating shaders for '" + programName + "' program.");
+    pending.vertexShader = getCompiledShader(GL_VERTEX_SHADER, vertexFile, vertexCode, wait);
+    if (!pending.vertexShader) {
         logError("Failed to compile vertex shader for program '" + programName + "'.");
         return false;
     }
-    if (!fragmentShader->compile()) {
+    pending.fragmentShader = getCompiledShader(GL_FRAGMENT_SHADER, fragmentFile, fragmentCode, wait);
+    if (!pending.fragmentShader) {
         logError("Failed to compile fragment shader for program '" + programName + "'.");
         return false;
     }
 
     logTrace("Create and link the shader program.");
-    auto shaderProgram = std::make_shared<ShaderProgram>();
-    if (shaderProgram->attachShader(vertexShader) && shaderProgram->attachShader(fragmentShader)) {
-        if (shaderProgram->link()) {
-            shaderPrograms[programName] = shaderProgram;
-            logDebug("Shader program '" + programName + "' successfully created.");
-            return true;
-        } else {
-            logError("Failed to link shader program '" + programName + "'.");
+    pending.program = std::make_shared<ShaderProgram>();
+    if (!pending.program->attachShader(pending.vertexShader) ||
+        !pending.program->attachShader(pending.fragmentShader)) {
+        logError("Failed to attach shaders for program '" + programName + "'.");
+        return false;
+    }
+    pending.program->submitLink();
+    return true;
+}
+
+ShaderProgramHandle ShaderManager::finishProgram(const std::string &programName, PendingProgram &pending) {
+    if (pending.fromBinary) {
+        pending.program->reflectUniforms();
+        ++cacheStatistics.programBinariesLoaded;
+        logDebug("Shader program '" + programName + "' loaded from the program binary cache.");
+        return storeProgram(programName, pending.program);
+    }
+
+    if (!pending.program->finishLink()) {
+        logError("Failed to link shader program '" + programName + "'.");
+        // Shaders submitted without waiting are only checked now; keep broken ones out of the cache.
+        for (const auto &shader : {pending.vertexShader, pending.fragmentShader}) {
+            if (!shader->checkCompileStatus()) {
+                evictShader(shader);
+            }
         }
+        return ShaderProgramHandle();
+    }
+
+    ++cacheStatistics.programsLinked;
+    if (pending.binaryKey != 0 && programBinaryCache.store(pending.program->getProgramID(), pending.binaryKey)) {
+        ++cacheStatistics.programBinariesStored;
+    }
+    logDebug("Shader program '" + programName + "' successfully created.");
+    return storeProgram(programName, pending.program);
+}
+
+ShaderProgramHandle ShaderManager::storeProgram(const std::string &programName,
+                                                std::shared_ptr<ShaderProgram> program) {
+    uint32_t index;
+    if (!freeProgramSlots.empty()) {
+        index = freeProgramSlots.back();
+        freeProgramSlots.pop_back();
     } else {
-        logError("Failed to attach shaders for program '" + programName + "'.");
+        index = static_cast<uint32_t>(programSlots.size());
+        programSlots.emplace_back();
     }
 
-    return false;
+    programSlots[index].program = std::move(program);
+    ShaderProgramHandle handle{index, programSlots[index].generation};
+    shaderPrograms[programName] = handle;
+    return handle;
 }
 
 bool ShaderManager::removeShaderProgram(const std::string &programName) {
@@ -73,6 +284,13 @@ bool ShaderManager::removeShaderProgram(const std::string &programName) {
         return false;
     }
 
+    ProgramSlot &slot = programSlots[it->second.index];
+    slot.program.reset();
+    // Generation 0 marks invalid handles, so it is skipped when the counter wraps.
+    if (++slot.generation == 0) {
+        slot.generation = 1;
+    }
+    freeProgramSlots.push_back(it->second.index);
     shaderPrograms.erase(it);
     logDebug("Shader program '" + programName + "' removed successfully.");
 
@@ -82,24 +300,105 @@ bool ShaderManager::removeShaderProgram(const std::string &programName) {
 std::shared_ptr<ShaderProgram> ShaderManager::getShaderProgram(const std::string &programName) const {
     auto it = shaderPrograms.find(programName);
     if (it != shaderPrograms.end()) {
-        logTrace("Shader program '" + programName + "' found.");
-        return it->second;
+        LOG_TRACE("Shader program '" + programName + "' found.");
+        return programSlots[it->second.index].program;
     }
     logWarn("Shader program '" + programName + "' not found.");
     return nullptr;
 }
 
-void ShaderManager::useShaderProgram(const std::string &programName) {
-    if (currentProgram == programName) {
-        return;
+std::shared_ptr<ShaderProgram> ShaderManager::getShaderProgram(ShaderProgramHandle handle) const {
+    if (handle.isValid() && handle.index < programSlots.size() &&
+        programSlots[handle.index].generation == handle.generation) {
+        return programSlots[handle.index].program;
     }
+    logWarn("Shader program handle " + std::to_string(handle.index) + ":" + std::to_string(handle.generation) +
+            " is stale or invalid.");
+    return nullptr;
+}
 
+void ShaderManager::useShaderProgram(const std::string &programName) {
+    // Redundant binds are filtered by the GLStateCache, which tracks the GL program object rather
+    // than its name.
     auto shaderProgram = getShaderProgram(programName);
     if (shaderProgram) {
-        logTrace("Using shader program '" + programName + "'.");
+        LOG_TRACE("Using shader program '" + programName + "'.");
         shaderProgram->use();
-        currentProgram = programName;
     } else {
         logError("Unable to use shader program '" + programName + "' because it was not found.");
     }
 }
+
+void ShaderManager::logStaleHandle(ShaderProgramHandle handle) const {
+    logError("Unable to use shader program handle " + std::to_string(handle.index) + ":" +
+             std::to_string(handle.generation) + " because it is stale or invalid.");
+}
+
+const std::string *ShaderManager::getShaderSource(const std::string &fileName) {
+    auto sourceIt = shaderSources.find(fileName);
+    if (sourceIt == shaderSources.end()) {
+        std::string source = Shader::loadShaderFromFile(fileName);
+        if (source.empty()) {
+            return nullptr;
+        }
+        sourceIt = shaderSources.emplace(fileName, std::move(source)).first;
+    }
+    return &sourceIt->second;
+}
+
+bool ShaderManager::preprocessShader(const std::string &fileName, const std::vector<std::string> &defines,
+                                     std::string &source) {
+    ShaderPreprocessor preprocessor([this](const std::string &file) {
+        const std::string *fileSource = getShaderSource(file);
+        return fileSource ? *fileSource : std::string();
+    });
+    return preprocessor.process(fileName, defines, source);
+}
+
+std::shared_ptr<Shader> ShaderManager::getCompiledShader(GLenum type, const std::string &fileName,
+                                                         const std::string &source, bool wait) {
+    ShaderCacheKey key{type, source};
+    auto cached = shaderCache.find(key);
+    if (cached != shaderCache.end()) {
+        ++cacheStatistics.compilesAvoided;
+        if (cached->second.timed) {
+            cacheStatistics.timeSavedMs += cached->second.compileTimeMs;
+        }
+        LOG_TRACE("Shader '" + fileName + "' served from the shader cache.");
+        return cached->second.shader;
+    }
+
+    auto shader = std::make_shared<Shader>(type, fileName);
+    auto start = std::chrono::steady_clock::now();
+    if (!shader->compile(key.source, wait)) {
+        return nullptr;
+    }
+    double compileTimeMs = Statistics::elapsedMs(start, std::chrono::steady_clock::now());
+
+    ++cacheStatistics.compiles;
+    if (wait) {
+        cacheStatistics.compileTimeMs += compileTimeMs;
+    }
+    shaderCache.emplace(std::move(key), CachedShader{shader, compileTimeMs, wait});
+    return shader;
+}
+
+void ShaderManager::evictShader(const std::shared_ptr<Shader> &shader) {
+    for (auto it = shaderCache.begin(); it != shaderCache.end(); ++it) {
+        if (it->second.shader == shader) {
+            shaderCache.erase(it);
+            return;
+        }
+    }
+}
+
+void ShaderManager::clearShaderCache() {
+    logDebug("Shader cache: " + std::to_string(cacheStatistics.compiles) + " compiles, " +
+             std::to_string(cacheStatistics.compilesAvoided) + " avoided, " +
+             std::to_string(cacheStatistics.timeSavedMs) + " ms saved, " +
+             std::to_string(cacheStatistics.programBinariesLoaded) + " program binaries loaded.");
+    pendingPrograms.clear();
+    shaderCache.clear();
+    shaderSources.clear();
+    cacheStatistics = ShaderCacheStatistics();
+}
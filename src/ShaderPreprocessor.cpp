@@ -0,0 +1,103 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "ShaderPreprocessor.h"
+#include "Logger.h"
+#include "Shader.h"
+
+#include <sstream>
+
+namespace {
+
+/**
+ * Extracts the file name of an `#include "file"` line.
+ *
+ * @return True if the line is an include directive.
+ */
+bool parseInclude(const std::string &line, std::string &fileName) {
+    size_t pos = line.find_first_not_of(" \t");
+    if (pos == std::string::npos || line[pos] != '#') {
+        return false;
+    }
+    pos = line.find_first_not_of(" \t", pos + 1);
+    if (pos == std::string::npos || line.compare(pos, 7, "include") != 0) {
+        return false;
+    }
+
+    size_t open = line.find('"', pos + 7);
+    size_t close = open == std::string::npos ? std::string::npos : line.find('"', open + 1);
+    if (close == std::string::npos) {
+        return false;
+    }
+    fileName = line.substr(open + 1, close - open - 1);
+    return true;
+}
+
+} // namespace
+
+ShaderPreprocessor::ShaderPreprocessor(FileLoader loader) : loader(loader ? loader : Shader::loadShaderFromFile) {}
+
+bool ShaderPreprocessor::process(const std::string &fileName, const std::vector<std::string> &defines,
+                                 std::string &output) const {
+    std::set<std::string> included;
+    std::string source;
+    if (!expand(fileName, 0, included, source)) {
+        return false;
+    }
+
+    // Injected in reverse, so that they end up in the given order.
+    for (auto it = defines.rbegin(); it != defines.rend(); ++it) {
+        source = Shader::injectDefine(source, *it);
+    }
+    output = std::move(source);
+    return true;
+}
+
+bool ShaderPreprocessor::expand(const std::string &fileName, int depth, std::set<std::string> &included,
+                                std::string &output) const {
+    if (depth > MAX_INCLUDE_DEPTH) {
+        logError("Shader include depth exceeded at '" + fileName + "'.");
+        return false;
+    }
+    if (!included.insert(fileName).second) {
+        return true;
+    }
+
+    std::string source = loader(fileName);
+    if (source.empty()) {
+        logError("Failed to load shader file '" + fileName + "'.");
+        return false;
+    }
+
+    std::istringstream stream(source);
+    std::string line;
+    std::string includeName;
+    while (std::getline(stream, line)) {
+        if (parseInclude(line, includeName)) {
+            if (!expand(includeName, depth + 1, included, output)) {
+                logError("Included from '" + fileName + "'.");
+                return false;
+            }
+            continue;
+        }
+        output += line;
+        output += '\n';
+    }
+    return true;
+}
@@ -18,9 +18,14 @@
 */
 
 #include "ShaderProgram.h"
+#include "GLStateCache.h"
 #include "Logger.h"
+#include <algorithm>
+#include <cstring>
 #include <vector>
 
+UniformStatistics ShaderProgram::uniformStatistics;
+
 ShaderProgram::ShaderProgram() {
     programID = glCreateProgram();
     if (programID == 0) {
@@ -45,8 +50,19 @@ bool ShaderProgram::attachShader(std::shared_ptr<Shader> shader) {
 }
 
 bool ShaderProgram::link() {
-    glLinkProgram(programID);
+    submitLink();
+    return finishLink();
+}
+
+void ShaderProgram::submitLink() { glLinkProgram(programID); }
+
+bool ShaderProgram::isLinkComplete() const {
+    GLint complete = GL_TRUE;
+    glGetProgramiv(programID, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete == GL_TRUE;
+}
 
+bool ShaderProgram::finishLink() {
     GLint success;
     glGetProgramiv(programID, GL_LINK_STATUS, &success);
     if (!success) {
@@ -59,6 +75,7 @@ bool ShaderProgram::link() {
         glDetachShader(programID, shader->getShaderID());
     }
     attachedShaders.clear();
+    reflectUniforms();
 
     logTrace("Shader program linked successfully. Program ID: " + std::to_string(programID));
     return true;
@@ -66,8 +83,8 @@ bool ShaderProgram::link() {
 
 void ShaderProgram::use() const {
     if (programID != 0) {
-        glUseProgram(programID);
-        logTrace("Shader program in use. Program ID: " + std::to_string(programID));
+        GLStateCache::getInstance().useProgram(programID);
+        LOG_TRACE("Shader program in use. Program ID: " + std::to_string(programID));
     } else {
         logError("Attempted to use an invalid shader program.");
     }
@@ -77,11 +94,88 @@ GLuint ShaderProgram::getProgramID() const { return programID; }
 
 void ShaderProgram::release() {
     if (programID != 0) {
-        glDeleteProgram(programID);
+        GLStateCache::getInstance().deleteProgram(programID);
         logTrace("Shader program deleted. Program ID: " + std::to_string(programID));
         programID = 0;
     }
     attachedShaders.clear();
+    uniformLocations.clear();
+    uniforms.clear();
+}
+
+void ShaderProgram::reflectUniforms() {
+    uniformLocations.clear();
+    uniforms.clear();
+
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(programID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<GLchar> nameBuffer(std::max(maxLength, 1));
+
+    for (GLint i = 0; i < count; ++i) {
+        UniformInfo info;
+        GLsizei length = 0;
+        glGetActiveUniform(programID, i, nameBuffer.size(), &length, &info.size, &info.type, nameBuffer.data());
+        std::string name(nameBuffer.data(), length);
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0) {
+            name.erase(name.size() - 3);
+        }
+
+        GLint location = glGetUniformLocation(programID, name.c_str());
+        uniformLocations[name] = location;
+        uniforms[location] = info;
+    }
+    logTrace("Reflected " + std::to_string(count) + " uniforms of program ID: " + std::to_string(programID));
+}
+
+GLint ShaderProgram::getUniformLocation(const std::string &name) const {
+    auto it = uniformLocations.find(name);
+    return it != uniformLocations.end() ? it->second : -1;
+}
+
+bool ShaderProgram::updateShadow(GLint location, const void *value, size_t size) {
+    if (location < 0) {
+        return false;
+    }
+
+    auto it = uniforms.find(location);
+    if (it != uniforms.end()) {
+        UniformInfo &info = it->second;
+        if (info.hasValue && std::memcmp(info.value, value, size) == 0) {
+            ++uniformStatistics.skipped;
+            return false;
+        }
+        std::memcpy(info.value, value, size);
+        info.hasValue = true;
+    }
+    ++uniformStatistics.issued;
+    return true;
+}
+
+void ShaderProgram::setUniform(GLint location, GLfloat x) {
+    if (updateShadow(location, &x, sizeof(x))) {
+        glUniform1f(location, x);
+    }
+}
+
+void ShaderProgram::setUniform(GLint location, GLfloat x, GLfloat y) {
+    const GLfloat value[2] = {x, y};
+    if (updateShadow(location, value, sizeof(value))) {
+        glUniform2f(location, x, y);
+    }
+}
+
+void ShaderProgram::setUniform(GLint location, GLint x) {
+    if (updateShadow(location, &x, sizeof(x))) {
+        glUniform1i(location, x);
+    }
+}
+
+void ShaderProgram::setUniformMatrix4(GLint location, const GLfloat *matrix) {
+    if (updateShadow(location, matrix, 16 * sizeof(GLfloat))) {
+        glUniformMatrix4fv(location, 1, GL_FALSE, matrix);
+    }
 }
 
 void ShaderProgram::logProgramError() const {
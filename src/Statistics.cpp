@@ -0,0 +1,221 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "Statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+namespace Statistics {
+
+SummaryStatistics summarize(const std::vector<double> &values) {
+    SummaryStatistics stats;
+    if (values.empty()) {
+        return stats;
+    }
+
+    double sum = std::accumulate(values.begin(), values.end(), 0.0);
+    stats.average = sum / values.size();
+    stats.minimum = *std::min_element(values.begin(), values.end());
+    stats.maximum = *std::max_element(values.begin(), values.end());
+
+    double variance = 0.0;
+    for (double value : values) {
+        variance += std::pow(value - stats.average, 2);
+    }
+    variance /= values.size();
+    stats.stdDev = std::sqrt(variance);
+
+    return stats;
+}
+
+double taskScore(const SummaryStatistics &fps) {
+    double score = ((fps.average - fps.stdDev) / 60.0) * 1000.0;
+    return std::clamp(score, 0.0, 1000.0);
+}
+
+double median(std::vector<double> values) { return percentile(std::move(values), 50.0); }
+
+double percentile(std::vector<double> values, double percentile) {
+    if (values.empty()) {
+        return 0.0;
+    }
+
+    double rank = std::clamp(percentile, 0.0, 100.0) / 100.0 * (values.size() - 1);
+    size_t lower = static_cast<size_t>(std::floor(rank));
+    std::nth_element(values.begin(), values.begin() + lower, values.end());
+    double lowerValue = values[lower];
+    if (lower + 1 >= values.size()) {
+        return lowerValue;
+    }
+    double upperValue = *std::min_element(values.begin() + lower + 1, values.end());
+    return lowerValue + (rank - lower) * (upperValue - lowerValue);
+}
+
+double mannWhitneyPValue(const std::vector<double> &a, const std::vector<double> &b) {
+    if (a.empty() || b.empty()) {
+        return 1.0;
+    }
+
+    std::vector<std::pair<double, bool>> pooled;
+    pooled.reserve(a.size() + b.size());
+    for (double value : a) {
+        pooled.emplace_back(value, true);
+    }
+    for (double value : b) {
+        pooled.emplace_back(value, false);
+    }
+    std::sort(pooled.begin(), pooled.end(),
+              [](const std::pair<double, bool> &x, const std::pair<double, bool> &y) { return x.first < y.first; });
+
+    // Assign average ranks to ties and accumulate the tie correction term.
+    double rankSumA = 0.0;
+    double tieTerm = 0.0;
+    for (size_t i = 0; i < pooled.size();) {
+        size_t j = i;
+        while (j < pooled.size() && pooled[j].first == pooled[i].first) {
+            ++j;
+        }
+        double averageRank = (i + 1 + j) / 2.0;
+        for (size_t k = i; k < j; ++k) {
+            if (pooled[k].second) {
+                rankSumA += averageRank;
+            }
+        }
+        double ties = static_cast<double>(j - i);
+        tieTerm += ties * ties * ties - ties;
+        i = j;
+    }
+
+    double n1 = static_cast<double>(a.size());
+    double n2 = static_cast<double>(b.size());
+    double n = n1 + n2;
+    double u = rankSumA - n1 * (n1 + 1) / 2.0;
+    double meanU = n1 * n2 / 2.0;
+    double varianceU = n1 * n2 / 12.0 * ((n + 1) - tieTerm / (n * (n - 1)));
+    if (varianceU <= 0.0) {
+        return 1.0;
+    }
+
+    double z = (std::fabs(u - meanU) - 0.5) / std::sqrt(varianceU);
+    if (z < 0.0) {
+        z = 0.0;
+    }
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+std::pair<double, double> bootstrapMedianChangeCI(const std::vector<double> &baseline,
+                                                  const std::vector<double> &current, double confidence,
+                                                  int iterations) {
+    if (baseline.empty() || current.empty() || iterations <= 0) {
+        return {0.0, 0.0};
+    }
+
+    std::mt19937 generator(0x5eed);
+    std::uniform_int_distribution<size_t> pickBaseline(0, baseline.size() - 1);
+    std::uniform_int_distribution<size_t> pickCurrent(0, current.size() - 1);
+    std::vector<double> baselineSample(baseline.size());
+    std::vector<double> currentSample(current.size());
+    std::vector<double> changes;
+    changes.reserve(iterations);
+
+    for (int i = 0; i < iterations; ++i) {
+        for (double &value : baselineSample) {
+            value = baseline[pickBaseline(generator)];
+        }
+        for (double &value : currentSample) {
+            value = current[pickCurrent(generator)];
+        }
+        double baselineMedian = median(baselineSample);
+        if (baselineMedian != 0.0) {
+            changes.push_back((median(currentSample) / baselineMedian - 1.0) * 100.0);
+        }
+    }
+
+    double tail = (1.0 - confidence) / 2.0 * 100.0;
+    return {percentile(changes, tail), percentile(changes, 100.0 - tail)};
+}
+
+std::vector<std::pair<double, double>> downsampleLTTB(const std::vector<double> &values, size_t threshold) {
+    std::vector<std::pair<double, double>> sampled;
+    size_t count = values.size();
+    if (threshold >= count || threshold < 3) {
+        sampled.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            sampled.emplace_back(static_cast<double>(i), values[i]);
+        }
+        return sampled;
+    }
+
+    sampled.reserve(threshold);
+    double bucketSize = static_cast<double>(count - 2) / (threshold - 2);
+    size_t anchor = 0;
+    sampled.emplace_back(0.0, values[0]);
+
+    for (size_t bucket = 0; bucket < threshold - 2; ++bucket) {
+        // Average of the next bucket is the third vertex of the triangle.
+        size_t nextStart = static_cast<size_t>(std::floor((bucket + 1) * bucketSize)) + 1;
+        size_t nextEnd = std::min(static_cast<size_t>(std::floor((bucket + 2) * bucketSize)) + 1, count);
+        double avgX = 0.0;
+        double avgY = 0.0;
+        for (size_t i = nextStart; i < nextEnd; ++i) {
+            avgX += i;
+            avgY += values[i];
+        }
+        size_t nextSize = nextEnd > nextStart ? nextEnd - nextStart : 1;
+        avgX /= nextSize;
+        avgY /= nextSize;
+
+        size_t start = static_cast<size_t>(std::floor(bucket * bucketSize)) + 1;
+        size_t end = static_cast<size_t>(std::floor((bucket + 1) * bucketSize)) + 1;
+        double anchorX = static_cast<double>(anchor);
+        double anchorY = values[anchor];
+        double maxArea = -1.0;
+        size_t selected = start;
+        for (size_t i = start; i < end; ++i) {
+            double area = std::fabs((anchorX - avgX) * (values[i] - anchorY) - (anchorX - i) * (avgY - anchorY));
+            if (area > maxArea) {
+                maxArea = area;
+                selected = i;
+            }
+        }
+
+        sampled.emplace_back(static_cast<double>(selected), values[selected]);
+        anchor = selected;
+    }
+
+    sampled.emplace_back(static_cast<double>(count - 1), values[count - 1]);
+    return sampled;
+}
+
+std::string formatTwoDecimals(double value) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << value;
+    return out.str();
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+} // namespace Statistics
@@ -0,0 +1,112 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "TextureCache.h"
+#include "GLStateCache.h"
+#include "Logger.h"
+
+namespace {
+
+/**
+ * Most GPUs store RGB textures with a padding byte, so every decoded pixel is counted as four bytes.
+ */
+constexpr size_t ESTIMATED_BYTES_PER_PIXEL = 4;
+
+} // namespace
+
+TextureCache &TextureCache::getInstance() {
+    static TextureCache instance;
+    return instance;
+}
+
+TextureCache::TextureCache() : budget(0), usedBytes(0) {}
+
+void TextureCache::setBudget(size_t bytes) {
+    budget = bytes;
+    evict();
+    logDebug(budget > 0 ? "Texture cache budget: " + std::to_string(budget / (1024 * 1024)) + " MB."
+                        : std::string("Texture cache budget: unlimited."));
+}
+
+GLuint TextureCache::acquire(const std::string &filePath, unsigned int targetWidth, unsigned int targetHeight,
+                             MipmapGeneration mipmaps) {
+    std::string key = filePath + "@" + std::to_string(targetWidth) + "x" + std::to_string(targetHeight) + "/" +
+                      std::to_string(static_cast<int>(mipmaps));
+    auto found = index.find(key);
+    if (found != index.end()) {
+        ++statistics.hits;
+        entries.splice(entries.begin(), entries, found->second);
+        return found->second->texture;
+    }
+
+    ++statistics.misses;
+    size_t sizeBytes = 0;
+    GLuint texture = load(filePath, targetWidth, targetHeight, mipmaps, sizeBytes);
+    if (texture == 0) {
+        return 0;
+    }
+    statistics.bytesLoaded += sizeBytes;
+    entries.push_front({key, texture, sizeBytes});
+    index[key] = entries.begin();
+    usedBytes += sizeBytes;
+    evict();
+    return texture;
+}
+
+GLuint TextureCache::load(const std::string &filePath, unsigned int targetWidth, unsigned int targetHeight,
+                          MipmapGeneration mipmaps, size_t &sizeBytes) {
+    if (ImageLoader::hasExtension(filePath, {".ktx", ".ktx2"})) {
+        CompressedTextureInfo info;
+        GLuint texture = ImageLoader::loadCompressedTexture(filePath, &info);
+        sizeBytes = info.sizeBytes;
+        return texture;
+    }
+
+    if (!ImageLoader::decodeImage(filePath, image, targetWidth, targetHeight)) {
+        return 0;
+    }
+    GLuint texture = ImageLoader::createTexture(image);
+    bool mipmapped = ImageLoader::generateMipmaps(texture, image, mipmaps);
+    sizeBytes = ImageLoader::getTextureSizeBytes(image.width, image.height, ESTIMATED_BYTES_PER_PIXEL, mipmapped);
+    return texture;
+}
+
+void TextureCache::evict() {
+    GLStateCache &stateCache = GLStateCache::getInstance();
+    while (budget > 0 && usedBytes > budget && entries.size() > 1) {
+        const Entry &entry = entries.back();
+        LOG_TRACE("Texture cache evicting " + entry.key);
+        stateCache.deleteTexture(entry.texture);
+        usedBytes -= entry.sizeBytes;
+        index.erase(entry.key);
+        entries.pop_back();
+        ++statistics.evictions;
+    }
+}
+
+void TextureCache::clear() {
+    GLStateCache &stateCache = GLStateCache::getInstance();
+    for (const Entry &entry : entries) {
+        stateCache.deleteTexture(entry.texture);
+    }
+    entries.clear();
+    index.clear();
+    usedBytes = 0;
+    image = ImageData();
+}
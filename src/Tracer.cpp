@@ -0,0 +1,189 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "Tracer.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+/**
+ * Appends a string as a JSON string literal.
+ */
+void appendJsonString(std::string &out, const char *value) {
+    out += '"';
+    for (const char *c = value; *c; ++c) {
+        switch (*c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        default:
+            if (static_cast<unsigned char>(*c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(*c));
+                out += escaped;
+            } else {
+                out += *c;
+            }
+        }
+    }
+    out += '"';
+}
+
+/**
+ * Formats nanoseconds as the microseconds used by the trace event format.
+ */
+void appendMicroseconds(std::string &out, uint64_t ns) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%llu.%03llu", static_cast<unsigned long long>(ns / 1000),
+                  static_cast<unsigned long long>(ns % 1000));
+    out += buffer;
+}
+
+thread_local uint32_t currentThreadId = 0;
+
+} // namespace
+
+Tracer &Tracer::getInstance() {
+    static Tracer instance;
+    return instance;
+}
+
+Tracer::Tracer() : epoch(std::chrono::steady_clock::now()), enabled(false), nextEvent(0), nextThreadId(1) {}
+
+void Tracer::enable(size_t capacity) {
+    if (capacity == 0) {
+        return;
+    }
+    events.assign(capacity, TraceEvent{nullptr, nullptr, 0, 0, 0});
+    nextEvent.store(0, std::memory_order_relaxed);
+    enabled.store(true, std::memory_order_release);
+    logInfo("Tracing enabled, keeping the last " + std::to_string(capacity) + " spans.");
+}
+
+const char *Tracer::intern(const std::string &name) {
+    std::lock_guard<std::mutex> lock(namesMutex);
+    for (const auto &interned : internedNames) {
+        if (interned == name) {
+            return interned.c_str();
+        }
+    }
+    internedNames.push_back(name);
+    return internedNames.back().c_str();
+}
+
+uint32_t Tracer::getThreadId() {
+    if (currentThreadId == 0) {
+        currentThreadId = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+    }
+    return currentThreadId;
+}
+
+void Tracer::setThreadName(const char *name) {
+    uint32_t threadId = getThreadId();
+    std::lock_guard<std::mutex> lock(namesMutex);
+    for (auto &threadName : threadNames) {
+        if (threadName.first == threadId) {
+            threadName.second = name;
+            return;
+        }
+    }
+    threadNames.emplace_back(threadId, name);
+}
+
+void Tracer::record(const char *name, const char *category, uint64_t startNs, uint64_t endNs) {
+    if (!isEnabled()) {
+        return;
+    }
+    uint64_t index = nextEvent.fetch_add(1, std::memory_order_relaxed);
+    events[index % events.size()] = TraceEvent{name, category, startNs, endNs - startNs, getThreadId()};
+}
+
+bool Tracer::writeChromeTrace(const std::string &filePath) const {
+    if (!isEnabled()) {
+        return false;
+    }
+
+    std::ofstream file(filePath, std::ios::trunc);
+    if (!file.is_open()) {
+        logError("Failed to open trace file: " + filePath);
+        return false;
+    }
+
+    uint64_t recorded = nextEvent.load(std::memory_order_acquire);
+    uint64_t count = std::min<uint64_t>(recorded, events.size());
+    uint64_t first = recorded - count;
+
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool firstEntry = true;
+    {
+        std::lock_guard<std::mutex> lock(namesMutex);
+        for (const auto &threadName : threadNames) {
+            out += firstEntry ? "" : ",\n";
+            firstEntry = false;
+            out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(threadName.first) +
+                   ",\"args\":{\"name\":";
+            appendJsonString(out, threadName.second);
+            out += "}}";
+        }
+    }
+
+    for (uint64_t i = first; i < recorded; ++i) {
+        const TraceEvent &event = events[i % events.size()];
+        if (!event.name) {
+            continue;
+        }
+        out += firstEntry ? "" : ",\n";
+        firstEntry = false;
+        out += "{\"name\":";
+        appendJsonString(out, event.name);
+        out += ",\"cat\":";
+        appendJsonString(out, event.category);
+        out += ",\"ph\":\"X\",\"ts\":";
+        appendMicroseconds(out, event.startNs);
+        out += ",\"dur\":";
+        appendMicroseconds(out, event.durationNs);
+        out += ",\"pid\":1,\"tid\":" + std::to_string(event.threadId) + "}";
+
+        // Keep memory bounded for large buffers.
+        if (out.size() > (1 << 20)) {
+            file << out;
+            out.clear();
+        }
+    }
+    out += "\n]}\n";
+    file << out;
+    file.close();
+    if (!file) {
+        logError("Failed to write trace file: " + filePath);
+        return false;
+    }
+
+    if (recorded > count) {
+        logWarn("Trace buffer overflowed; the oldest " + std::to_string(recorded - count) + " spans were dropped.");
+    }
+    logInfo("Trace with " + std::to_string(count) + " spans written to: " + filePath);
+    return true;
+}
@@ -21,6 +21,11 @@
 #include "ConfigurationManager.h"
 #include "Logger.h"
 
+/**
+ * Exit status reported when the run regressed significantly against the baseline reports.
+ */
+constexpr int EXIT_REGRESSION = 2;
+
 int main(int argc, char *argv[]) {
 
     try {
@@ -28,11 +33,58 @@ int main(int argc, char *argv[]) {
 
         ConfigurationManager &configManager = ConfigurationManager::getInstance();
         configManager.setOption("asset_dir", std::string(ASSET_BASE_DIR), "Asset directory");
+        configManager.setOption("baseline", "",
+                                "Comma-separated list of baseline JSON reports to compare the results against.");
         configManager.setOption("benchmark_duration", "30", "The duration for running each render task in seconds.");
+        configManager.setOption("binary_report", "false",
+                                "Whether to also record per-frame timings in the compact binary report.");
+        configManager.setOption("shader_dir", "embedded",
+                                "Directory to load shaders from instead of the shaders embedded in the binary.");
+        configManager.setOption("program_binary_cache", "/tmp/valyria-program-cache",
+                                "Directory of the program binary cache. `none` to always build programs from source.");
+        configManager.setOption("async_shader_compile", "on",
+                                "Compile task shaders in parallel with GL_KHR_parallel_shader_compile (on, off, "
+                                "compare).");
+        configManager.setOption("shader_specialization", "off",
+                                "Bake task parameters into the Cube shaders instead of passing uniforms (on, off, "
+                                "compare).");
+        configManager.setOption("state_cache", "on",
+                                "Filter redundant GL state changes (on, off, compare).");
+        configManager.setOption("trace_file", "none",
+                                "File to write a Chrome trace event JSON of per-frame phases to.");
+        configManager.setOption("swap_block_threshold", "4",
+                                "Time in milliseconds after which a buffer swap counts as blocked in the frame "
+                                "budget.");
+        configManager.setOption("jank_threshold", "2",
+                                "Frames taking longer than this multiple of the target frame time are jank spikes. "
+                                "`none` to disable.");
+        configManager.setOption("jank_history", "300", "Number of frames kept for jank spike snapshots.");
+        configManager.setOption("texture_corpus", "/tmp/valyria-texture-corpus",
+                                "Directory of PNG and JPG images for the TextureUpload task. A synthetic corpus is "
+                                "generated if it contains no PNG or JPG images.");
+        configManager.setOption("async_texture_loading", "on",
+                                "Decode images for the TextureUpload task on worker threads (on, off, compare).");
+        configManager.setOption("texture_upload_budget", "4096",
+                                "Kilobytes of texture data uploaded per frame by the asynchronous texture loader.");
+        configManager.setOption("mipmap_generation", "gpu",
+                                "How the ThumbnailDecode tasks create mipmap levels (none, cpu, gpu).");
+        configManager.setOption("texture_cache_budget", "64",
+                                "Megabytes of textures the texture cache keeps before evicting the least recently "
+                                "used. `none` for no limit.");
+        configManager.setOption("inter_task_gap", "0",
+                                "Idle time in milliseconds between the setup and the first frame of each task after "
+                                "the first.");
         configManager.setOption("log_level", "INFO", "Log level");
+        configManager.setOption("log_file", "none", "File to write the log to instead of the console.");
+        configManager.setOption("async_logging", "true",
+                                "Whether to write the log on a background thread instead of the logging thread.");
         configManager.setOption("direct_mode", "false", "Whether to use Essos direct mode or run as a wayland client.");
         configManager.setOption("output_dir", "/tmp", "Directory to save results in.");
+        configManager.setOption("regression_threshold", "5",
+                                "Minimum increase of the median frame time in percent that counts as a regression.");
         configManager.setOption("sampling_rate", "1000", "The sampling rate for metrics collection in milliseconds.");
+        configManager.setOption("significance_level", "0.05",
+                                "Significance level of the statistical test used for the baseline comparison.");
         configManager.setOption("target_frame_rate", "60", "Specifies the target frame rate for rendering.");
         configManager.setOption("window_width", "0", "Width of the application window. 0 for fullscreen.");
         configManager.setOption("window_height", "0", "Height of the application window. 0 for fullscreen.");
@@ -43,6 +95,13 @@ int main(int argc, char *argv[]) {
 
         std::string logLevelStr = configManager.getValue("log_level");
         LoggerConfig::setLogLevel(stringToLogLevel(logLevelStr));
+        std::string logFile = configManager.getValue("log_file");
+        if (logFile != "none" && !LoggerConfig::setLogFile(logFile)) {
+            logWarn("Failed to open the log file '" + logFile + "'. Logging to the console.");
+        }
+        if (configManager.getValue("async_logging") == "true") {
+            LoggerConfig::startAsyncLogging();
+        }
 
         BenchmarkEngine benchmarkEngine;
         if (!benchmarkEngine.initialize()) {
@@ -50,7 +109,9 @@ int main(int argc, char *argv[]) {
             return EXIT_FAILURE;
         }
 
-        benchmarkEngine.runBenchmarks();
+        if (!benchmarkEngine.runBenchmarks()) {
+            return EXIT_REGRESSION;
+        }
     } catch (const std::exception &e) {
         logError(std::string("An error occurred: ") + e.what());
         return EXIT_FAILURE;
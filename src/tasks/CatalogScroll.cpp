@@ -0,0 +1,186 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "tasks/CatalogScroll.h"
+#include "ConfigurationManager.h"
+#include "GLStateCache.h"
+#include "Logger.h"
+#include "Statistics.h"
+#include "TextureCache.h"
+#include "tasks/TextureUpload.h"
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int CATALOG_COLUMNS = 6;
+constexpr int CATALOG_ROWS = 40;
+constexpr float SCROLL_ROWS_PER_SECOND = 2.0f;
+
+/**
+ * Posters are drawn in portrait tiles, as high as 1.5 times their width.
+ */
+constexpr float POSTER_ASPECT = 1.5f;
+
+std::string catalogDirectory() {
+    std::error_code error;
+    fs::path directory = fs::temp_directory_path(error);
+    if (error) {
+        directory = "/tmp";
+    }
+    return (directory / "valyria-catalog").string();
+}
+
+} // namespace
+
+CatalogScroll::CatalogScroll(const std::string &taskName)
+    : RenderTask(taskName), scrollRows(0.0f), quadVBO(0), imageLocation(-1) {}
+
+bool CatalogScroll::setup() {
+    scrollRows = 0.0f;
+    std::string corpusDirectory = ConfigurationManager::getInstance().getValue("texture_corpus");
+    std::vector<std::string> corpus;
+    if (!TextureUpload::loadCorpus(corpusDirectory, corpus) || !createCatalog(catalogDirectory(), corpus)) {
+        logError("CatalogScroll: no posters to load.");
+        return false;
+    }
+
+    GLfloat quadVertices[] = {
+        -1.0f, -1.0f, // Bottom left
+        1.0f,  -1.0f, // Bottom right
+        -1.0f, 1.0f,  // Top left
+        1.0f,  1.0f   // Top right
+    };
+
+    glGenBuffers(1, &quadVBO);
+    GLStateCache::getInstance().bindArrayBuffer(quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
+
+    programHandle = ShaderManager::getInstance().createShaderProgram("CatalogShader", "quad.vert", "texture.frag");
+    if (!programHandle.isValid()) {
+        logError("Failed to create the CatalogShader program.");
+        return false;
+    }
+
+    program = ShaderManager::getInstance().getShaderProgram(programHandle);
+    imageLocation = program->getUniformLocation("image");
+    if (imageLocation == -1) {
+        logError("CatalogScroll: Failed to retrieve the image uniform location.");
+        return false;
+    }
+
+    logDebug("CatalogScroll setup OK, " + std::to_string(posters.size()) + " posters.");
+    return true;
+}
+
+std::vector<ShaderProgramSource> CatalogScroll::getShaderPrograms() const {
+    return {{"CatalogShader", "quad.vert", "texture.frag", {}}};
+}
+
+void CatalogScroll::teardown() {
+    TextureCache::getInstance().clear();
+    GLStateCache::getInstance().deleteBuffer(quadVBO);
+    quadVBO = 0;
+    program.reset();
+    programHandle = ShaderProgramHandle();
+    posters.clear();
+
+    if (!ShaderManager::getInstance().removeShaderProgram("CatalogShader")) {
+        logError("Failed to remove the CatalogShader program.");
+    }
+}
+
+void CatalogScroll::render(int width, int height) {
+    ShaderManager::getInstance().use(programHandle);
+    program->setUniform(imageLocation, 0);
+
+    GLStateCache &stateCache = GLStateCache::getInstance();
+    stateCache.activeTexture(GL_TEXTURE0);
+    stateCache.bindArrayBuffer(quadVBO);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    stateCache.setVertexAttribArrays(1u << 0);
+
+    TextureCache &textureCache = TextureCache::getInstance();
+    uint64_t missesBefore = textureCache.getStatistics().misses;
+    double stallMs = 0.0;
+
+    int tileWidth = std::max(width / CATALOG_COLUMNS, 1);
+    int tileHeight = static_cast<int>(tileWidth * POSTER_ASPECT);
+    int firstRow = static_cast<int>(std::floor(scrollRows));
+    int scrollOffset = static_cast<int>((scrollRows - firstRow) * tileHeight);
+    for (int visibleRow = 0; visibleRow * tileHeight - scrollOffset < height; ++visibleRow) {
+        int row = (firstRow + visibleRow) % CATALOG_ROWS;
+        int top = visibleRow * tileHeight - scrollOffset;
+        for (int column = 0; column < CATALOG_COLUMNS; ++column) {
+            // Posters are decoded at the size they are drawn at; a miss loads the poster within the frame.
+            uint64_t missesBeforePoster = textureCache.getStatistics().misses;
+            auto acquireStart = std::chrono::steady_clock::now();
+            GLuint texture = textureCache.acquire(posters[row * CATALOG_COLUMNS + column], tileWidth, tileHeight);
+            if (textureCache.getStatistics().misses != missesBeforePoster) {
+                stallMs += Statistics::elapsedMs(acquireStart, std::chrono::steady_clock::now());
+            }
+            if (texture == 0) {
+                continue;
+            }
+            stateCache.viewport(column * tileWidth, height - top - tileHeight, tileWidth, tileHeight);
+            stateCache.bindTexture(GL_TEXTURE_2D, texture);
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        }
+    }
+
+    uint64_t loads = textureCache.getStatistics().misses - missesBefore;
+    recordTaskMetric("Texture loads per frame", loads);
+    if (loads > 0) {
+        recordTaskMetric("Reload stall (ms)", stallMs);
+    }
+    recordTaskMetric("Texture cache memory (MB)", textureCache.getUsedBytes() / (1024.0 * 1024.0));
+}
+
+void CatalogScroll::update(float elapsedTime, float deltaTime) {
+    scrollRows = std::fmod(elapsedTime / 1000.0f * SCROLL_ROWS_PER_SECOND, static_cast<float>(CATALOG_ROWS));
+}
+
+bool CatalogScroll::createCatalog(const std::string &directory, const std::vector<std::string> &corpus) {
+    posters.clear();
+    // The catalog is rebuilt on every run, so it always links to the current corpus.
+    std::error_code error;
+    fs::remove_all(directory, error);
+    fs::create_directories(directory, error);
+    if (error) {
+        logError("Failed to create the catalog directory: " + directory);
+        return false;
+    }
+
+    for (int poster = 0; poster < CATALOG_ROWS * CATALOG_COLUMNS; ++poster) {
+        fs::path source = fs::absolute(corpus[poster % corpus.size()], error);
+        fs::path target = fs::path(directory) / ("poster-" + std::to_string(poster) + source.extension().string());
+        // Linking avoids duplicating the data; file systems without symbolic links get a copy.
+        fs::create_symlink(source, target, error);
+        if (error && !fs::copy_file(source, target, error)) {
+            logError("Failed to create catalog poster: " + target.string());
+            return false;
+        }
+        posters.push_back(target.string());
+    }
+    return true;
+}
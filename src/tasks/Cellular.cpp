@@ -18,6 +18,7 @@
 */
 
 #include "tasks/Cellular.h"
+#include "GLStateCache.h"
 #include "Logger.h"
 #include "ShaderManager.h"
 
@@ -33,20 +34,20 @@ bool Cellular::setup() {
     };
 
     glGenBuffers(1, &quadVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    GLStateCache::getInstance().bindArrayBuffer(quadVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    if (!ShaderManager::getInstance().createShaderProgram("CellularShader", "quad.vert", "cellular.frag")) {
+    programHandle = ShaderManager::getInstance().createShaderProgram("CellularShader", "quad.vert", "cellular.frag");
+    if (!programHandle.isValid()) {
         logError("Failed to create the CellularShader program.");
         return false;
     }
 
-    GLuint programID = ShaderManager::getInstance().getShaderProgram("CellularShader")->getProgramID();
+    program = ShaderManager::getInstance().getShaderProgram(programHandle);
 
-    iTimeLocation = glGetUniformLocation(programID, "iTime");
-    iResolutionLocation = glGetUniformLocation(programID, "iResolution");
-    enableFBMLocation = glGetUniformLocation(programID, "enableFBM");
+    iTimeLocation = program->getUniformLocation("iTime");
+    iResolutionLocation = program->getUniformLocation("iResolution");
+    enableFBMLocation = program->getUniformLocation("enableFBM");
 
     if (iTimeLocation == -1 || iResolutionLocation == -1 || enableFBMLocation == -1) {
         logError("Cellular: Failed to retrieve one or more uniform locations.");
@@ -57,8 +58,14 @@ bool Cellular::setup() {
     return true;
 }
 
+std::vector<ShaderProgramSource> Cellular::getShaderPrograms() const {
+    return {{"CellularShader", "quad.vert", "cellular.frag", {}}};
+}
+
 void Cellular::teardown() {
-    glDeleteBuffers(1, &quadVBO);
+    GLStateCache::getInstance().deleteBuffer(quadVBO);
+    program.reset();
+    programHandle = ShaderProgramHandle();
 
     if (!ShaderManager::getInstance().removeShaderProgram("CellularShader")) {
         logError("Failed to remove the CellularShader program.");
@@ -66,18 +73,17 @@ void Cellular::teardown() {
 }
 
 void Cellular::render(int width, int height) {
-    ShaderManager::getInstance().useShaderProgram("CellularShader");
+    ShaderManager::getInstance().use(programHandle);
 
-    glUniform1f(iTimeLocation, elapsedTime);
-    glUniform2f(iResolutionLocation, width, height);
-    glUniform1i(enableFBMLocation, enableFBM ? 1 : 0);
+    program->setUniform(iTimeLocation, elapsedTime);
+    program->setUniform(iResolutionLocation, width, height);
+    program->setUniform(enableFBMLocation, enableFBM ? 1 : 0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    GLStateCache &stateCache = GLStateCache::getInstance();
+    stateCache.bindArrayBuffer(quadVBO);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-    glEnableVertexAttribArray(0);
+    stateCache.setVertexAttribArrays(1u << 0);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    glDisableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void Cellular::update(float elapsed, float deltaTime) { elapsedTime = elapsed / 1000.0; }
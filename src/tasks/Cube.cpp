@@ -18,12 +18,13 @@
 */
 
 #include "tasks/Cube.h"
+#include "GLStateCache.h"
 #include "Logger.h"
 #include "ShaderManager.h"
 
-Cube::Cube(const std::string &taskName, int AA, int maxSteps)
-    : RenderTask(taskName), AA(AA), maxSteps(maxSteps), elapsedTime(0.0f), iTimeLocation(-1), iResolutionLocation(-1),
-      AALocation(-1), maxStepsLocation(-1) {}
+Cube::Cube(const std::string &taskName, int AA, int maxSteps, bool specialized, bool scored)
+    : RenderTask(taskName), AA(AA), maxSteps(maxSteps), specialized(specialized), scored(scored), elapsedTime(0.0f),
+      iTimeLocation(-1), iResolutionLocation(-1), AALocation(-1), maxStepsLocation(-1) {}
 
 bool Cube::setup() {
     GLfloat quadVertices[] = {
@@ -34,23 +35,27 @@ bool Cube::setup() {
     };
 
     glGenBuffers(1, &quadVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    GLStateCache::getInstance().bindArrayBuffer(quadVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    if (!ShaderManager::getInstance().createShaderProgram("CubeShader", "quad.vert", "cube.frag")) {
-        logError("Failed to create the CubeShader program.");
+    ShaderProgramSource source = getShaderPrograms().front();
+    programHandle = ShaderManager::getInstance().createShaderProgram(source.programName, source.vertexFile,
+                                                                     source.fragmentFile, source.defines);
+    if (!programHandle.isValid()) {
+        logError("Failed to create the " + source.programName + " program.");
         return false;
     }
 
-    GLuint programID = ShaderManager::getInstance().getShaderProgram("CubeShader")->getProgramID();
+    program = ShaderManager::getInstance().getShaderProgram(programHandle);
 
-    iTimeLocation = glGetUniformLocation(programID, "iTime");
-    iResolutionLocation = glGetUniformLocation(programID, "iResolution");
-    AALocation = glGetUniformLocation(programID, "AA");
-    maxStepsLocation = glGetUniformLocation(programID, "maxSteps");
+    iTimeLocation = program->getUniformLocation("iTime");
+    iResolutionLocation = program->getUniformLocation("iResolution");
+    AALocation = program->getUniformLocation("AA");
+    maxStepsLocation = program->getUniformLocation("maxSteps");
 
-    if (iTimeLocation == -1 || iResolutionLocation == -1 || AALocation == -1 || maxStepsLocation == -1) {
+    // Specialized permutations have no AA and maxSteps uniforms.
+    bool parametersFound = specialized || (AALocation != -1 && maxStepsLocation != -1);
+    if (iTimeLocation == -1 || iResolutionLocation == -1 || !parametersFound) {
         logError("Cube: Failed to retrieve one or more uniform locations.");
         return false;
     }
@@ -59,28 +64,38 @@ bool Cube::setup() {
     return true;
 }
 
+std::vector<ShaderProgramSource> Cube::getShaderPrograms() const {
+    if (specialized) {
+        return {{"CubeShader-AA" + std::to_string(AA) + "-S" + std::to_string(maxSteps), "quad.vert", "cube.frag",
+                 {"AA_SAMPLES " + std::to_string(AA), "MAX_STEPS " + std::to_string(maxSteps)}}};
+    }
+    return {{"CubeShader", "quad.vert", "cube.frag", {}}};
+}
+
 void Cube::teardown() {
-    glDeleteBuffers(1, &quadVBO);
+    GLStateCache::getInstance().deleteBuffer(quadVBO);
+    program.reset();
+    programHandle = ShaderProgramHandle();
 
-    if (!ShaderManager::getInstance().removeShaderProgram("CubeShader")) {
-        logError("Failed to remove the CubeShader program.");
+    std::string programName = getShaderPrograms().front().programName;
+    if (!ShaderManager::getInstance().removeShaderProgram(programName)) {
+        logError("Failed to remove the " + programName + " program.");
     }
 }
 
 void Cube::render(int width, int height) {
-    ShaderManager::getInstance().useShaderProgram("CubeShader");
+    ShaderManager::getInstance().use(programHandle);
 
-    glUniform1f(iTimeLocation, elapsedTime);
-    glUniform2f(iResolutionLocation, width, height);
-    glUniform1i(AALocation, AA);
-    glUniform1i(maxStepsLocation, maxSteps);
+    program->setUniform(iTimeLocation, elapsedTime);
+    program->setUniform(iResolutionLocation, width, height);
+    program->setUniform(AALocation, AA);
+    program->setUniform(maxStepsLocation, maxSteps);
 
-    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    GLStateCache &stateCache = GLStateCache::getInstance();
+    stateCache.bindArrayBuffer(quadVBO);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-    glEnableVertexAttribArray(0);
+    stateCache.setVertexAttribArrays(1u << 0);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    glDisableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void Cube::update(float elapsed, float deltaTime) { elapsedTime = elapsed / 1000.0; }
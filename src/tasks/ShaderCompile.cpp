@@ -0,0 +1,206 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "tasks/ShaderCompile.h"
+#include "GLStateCache.h"
+#include "Logger.h"
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+#include "Statistics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char *GENERATED_VERTEX_SHADER = R"(attribute vec2 position;
+varying vec2 fragCoord;
+
+void main() {
+    fragCoord = position;
+    gl_Position = vec4(position, 0.0, 1.0);
+}
+)";
+
+const int GENERATED_SHADER_STEPS[] = {8, 32, 128, 512};
+
+} // namespace
+
+ShaderCompile::ShaderCompile(const std::string &taskName)
+    : RenderTask(taskName), nextProgram(0), nonce(0), quadVBO(0) {}
+
+bool ShaderCompile::setup() {
+    programs.clear();
+    nextProgram = 0;
+
+    std::vector<std::string> fragmentFiles = Shader::listShaderFiles(".frag");
+    std::vector<std::string> vertexFiles = Shader::listShaderFiles(".vert");
+
+    ShaderPreprocessor preprocessor;
+    for (const auto &fragmentFile : fragmentFiles) {
+        // Pair each fragment shader with the vertex shader of the same name, or the full-screen quad.
+        std::string vertexFile = fs::path(fragmentFile).stem().string() + ".vert";
+        if (std::find(vertexFiles.begin(), vertexFiles.end(), vertexFile) == vertexFiles.end()) {
+            vertexFile = "quad.vert";
+        }
+
+        ProgramSource program;
+        program.name = fragmentFile;
+        if (!preprocessor.process(vertexFile, {}, program.vertexSource) ||
+            !preprocessor.process(fragmentFile, {}, program.fragmentSource)) {
+            logWarn("ShaderCompile: skipping '" + fragmentFile + "'.");
+            continue;
+        }
+        programs.push_back(program);
+    }
+
+    for (int steps : GENERATED_SHADER_STEPS) {
+        programs.push_back({"generated-" + std::to_string(steps), GENERATED_VERTEX_SHADER,
+                            generateFragmentShader(steps)});
+    }
+
+    GLfloat quadVertices[] = {
+        -1.0f, -1.0f, // Bottom left
+        1.0f,  -1.0f, // Bottom right
+        -1.0f, 1.0f,  // Top left
+        1.0f,  1.0f   // Top right
+    };
+
+    glGenBuffers(1, &quadVBO);
+    GLStateCache::getInstance().bindArrayBuffer(quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
+
+    logDebug("ShaderCompile setup OK, " + std::to_string(programs.size()) + " programs.");
+    return true;
+}
+
+void ShaderCompile::teardown() {
+    GLStateCache::getInstance().deleteBuffer(quadVBO);
+    quadVBO = 0;
+    programs.clear();
+}
+
+void ShaderCompile::render(int width, int height) {
+    if (programs.empty()) {
+        return;
+    }
+
+    const ProgramSource &source = programs[nextProgram];
+    nextProgram = (nextProgram + 1) % programs.size();
+    ++nonce;
+
+    auto compileStart = std::chrono::steady_clock::now();
+    std::string define = "VALYRIA_NONCE " + std::to_string(nonce);
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, Shader::injectDefine(source.vertexSource, define));
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, Shader::injectDefine(source.fragmentSource, define));
+    auto compileEnd = std::chrono::steady_clock::now();
+
+    if (vertexShader == 0 || fragmentShader == 0) {
+        logError("ShaderCompile: failed to compile '" + source.name + "'.");
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glBindAttribLocation(program, 0, "position");
+    glLinkProgram(program);
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    auto linkEnd = std::chrono::steady_clock::now();
+
+    if (linked == GL_TRUE) {
+        // Many drivers finish compilation lazily on the first draw, so it is measured separately.
+        GLStateCache &stateCache = GLStateCache::getInstance();
+        stateCache.viewport(0, 0, width, height);
+        stateCache.useProgram(program);
+        stateCache.bindArrayBuffer(quadVBO);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+        stateCache.setVertexAttribArrays(1u << 0);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glFinish();
+        auto drawEnd = std::chrono::steady_clock::now();
+
+        recordTaskMetric(source.name + " compile (ms)", Statistics::elapsedMs(compileStart, compileEnd));
+        recordTaskMetric(source.name + " link (ms)", Statistics::elapsedMs(compileEnd, linkEnd));
+        recordTaskMetric(source.name + " first draw (ms)", Statistics::elapsedMs(linkEnd, drawEnd));
+    } else {
+        logError("ShaderCompile: failed to link '" + source.name + "'.");
+    }
+
+    GLStateCache::getInstance().deleteProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+}
+
+void ShaderCompile::update(float elapsedTime, float deltaTime) {}
+
+std::string ShaderCompile::generateFragmentShader(int steps) {
+    std::string source = "precision mediump float;\n"
+                         "varying vec2 fragCoord;\n"
+                         "uniform float iTime;\n\n"
+                         "void main() {\n"
+                         "    vec4 c = vec4(fragCoord, iTime, 1.0);\n";
+    for (int i = 0; i < steps; ++i) {
+        // Each step depends on the previous one, so the compiler cannot fold or drop it.
+        std::string k = std::to_string(i + 1) + ".0";
+        switch (i % 4) {
+        case 0:
+            source += "    c = sin(c * " + k + " + c.yzwx);\n";
+            break;
+        case 1:
+            source += "    c = c * c.wxyz + vec4(" + k + ") * 0.01;\n";
+            break;
+        case 2:
+            source += "    c = mix(c, cos(c.zwxy), fract(c.x * " + k + "));\n";
+            break;
+        default:
+            source += "    c = normalize(c + vec4(0.001)) * dot(c, vec4(0.25)) + 0.5;\n";
+            break;
+        }
+    }
+    source += "    gl_FragColor = c;\n"
+              "}\n";
+    return source;
+}
+
+GLuint ShaderCompile::compileShader(GLenum type, const std::string &source) {
+    GLuint shader = glCreateShader(type);
+    if (shader == 0) {
+        return 0;
+    }
+
+    const char *src = source.c_str();
+    glShaderSource(shader, 1, &src, nullptr);
+    glCompileShader(shader);
+
+    // Querying the status waits for drivers that compile asynchronously.
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (compiled != GL_TRUE) {
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
@@ -0,0 +1,485 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "tasks/TextureSampling.h"
+#include "GLStateCache.h"
+#include "ImageLoader.h"
+#include "Logger.h"
+#include "Statistics.h"
+
+#include <GLES2/gl2ext.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/**
+ * Size of the base level. Larger than the screen, so that the layers sample different texels.
+ */
+constexpr unsigned int TEXTURE_SIZE = 2048;
+
+/**
+ * Full-screen layers drawn per frame. They are blended, so that no GPU can discard hidden layers.
+ */
+constexpr int SAMPLING_LAYERS = 8;
+
+/**
+ * Size of the tiles the generated content is made of, like the cells of a UI atlas.
+ */
+constexpr unsigned int CONTENT_TILE_SIZE = 256;
+
+constexpr unsigned char KTX_SIGNATURE[] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+constexpr uint32_t KTX_BYTE_ORDER = 0x04030201;
+
+/**
+ * The ETC1 intensity modifier tables; each subblock adds one of +-small or +-large to its base color.
+ */
+constexpr int ETC1_MODIFIERS[8][2] = {{2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+constexpr size_t ETC1_BLOCK_BYTES = 8;
+
+/**
+ * Fits the modifier table and per-pixel modifiers of an ETC1 subblock to its pixels.
+ *
+ * @param block The 16 pixels of the block in ETC1 order, column by column.
+ * @param pixels The indices of the subblock's 8 pixels.
+ * @param base The base color of the subblock.
+ * @param table Receives the table.
+ * @param selectors Receives the modifier of each pixel of the block in the subblock.
+ * @return The squared error.
+ */
+int fitETC1Subblock(const int (&block)[16][3], const int (&pixels)[8], const int (&base)[3], int &table,
+                    int (&selectors)[16]) {
+    int bestError = -1;
+    int tableSelectors[8];
+    for (int candidate = 0; candidate < 8; ++candidate) {
+        int error = 0;
+        for (int i = 0; i < 8; ++i) {
+            const int *pixel = block[pixels[i]];
+            int bestPixelError = -1;
+            // Selector bit 0 picks the large modifier, bit 1 negates it.
+            for (int selector = 0; selector < 4; ++selector) {
+                int modifier = ETC1_MODIFIERS[candidate][selector & 1] * ((selector & 2) ? -1 : 1);
+                int pixelError = 0;
+                for (int c = 0; c < 3; ++c) {
+                    int difference = std::clamp(base[c] + modifier, 0, 255) - pixel[c];
+                    pixelError += difference * difference;
+                }
+                if (bestPixelError < 0 || pixelError < bestPixelError) {
+                    bestPixelError = pixelError;
+                    tableSelectors[i] = selector;
+                }
+            }
+            error += bestPixelError;
+        }
+        if (bestError < 0 || error < bestError) {
+            bestError = error;
+            table = candidate;
+            for (int i = 0; i < 8; ++i) {
+                selectors[pixels[i]] = tableSelectors[i];
+            }
+        }
+    }
+    return bestError;
+}
+
+/**
+ * Encodes a 4x4 block to ETC1, trying both subblock orientations and preferring the differential
+ * mode's 5-bit base colors when the subblock averages are close enough.
+ *
+ * @param block The 16 pixels of the block in ETC1 order, column by column.
+ * @param output Receives the 8 bytes of the block.
+ */
+void encodeETC1Block(const int (&block)[16][3], unsigned char *output) {
+    int bestError = -1;
+    uint64_t bestBits = 0;
+    for (int flip = 0; flip < 2; ++flip) {
+        // Unflipped subblocks are the left and right 2x4 halves, flipped ones the top and bottom 4x2 halves.
+        int subblocks[2][8];
+        int counts[2] = {0, 0};
+        for (int p = 0; p < 16; ++p) {
+            int half = flip ? (p % 4) / 2 : p / 8;
+            subblocks[half][counts[half]++] = p;
+        }
+
+        int quantized[2][3];
+        int base[2][3];
+        for (int half = 0; half < 2; ++half) {
+            for (int c = 0; c < 3; ++c) {
+                int sum = 0;
+                for (int p : subblocks[half]) {
+                    sum += block[p][c];
+                }
+                quantized[half][c] = (sum * 31 + 8 * 255 / 2) / (8 * 255);
+            }
+        }
+        bool differential = true;
+        for (int c = 0; c < 3; ++c) {
+            int delta = quantized[1][c] - quantized[0][c];
+            differential = differential && delta >= -4 && delta <= 3;
+        }
+        for (int half = 0; half < 2; ++half) {
+            for (int c = 0; c < 3; ++c) {
+                if (differential) {
+                    base[half][c] = (quantized[half][c] << 3) | (quantized[half][c] >> 2);
+                } else {
+                    int sum = 0;
+                    for (int p : subblocks[half]) {
+                        sum += block[p][c];
+                    }
+                    quantized[half][c] = (sum * 15 + 8 * 255 / 2) / (8 * 255);
+                    base[half][c] = quantized[half][c] * 17;
+                }
+            }
+        }
+
+        int tables[2];
+        int selectors[16];
+        int error = fitETC1Subblock(block, subblocks[0], base[0], tables[0], selectors) +
+                    fitETC1Subblock(block, subblocks[1], base[1], tables[1], selectors);
+        if (bestError >= 0 && error >= bestError) {
+            continue;
+        }
+        bestError = error;
+
+        uint64_t bits = 0;
+        for (int c = 0; c < 3; ++c) {
+            int shift = 56 - 8 * c;
+            if (differential) {
+                bits |= static_cast<uint64_t>(quantized[0][c]) << (shift + 3);
+                bits |= static_cast<uint64_t>((quantized[1][c] - quantized[0][c]) & 7) << shift;
+            } else {
+                bits |= static_cast<uint64_t>(quantized[0][c]) << (shift + 4);
+                bits |= static_cast<uint64_t>(quantized[1][c]) << shift;
+            }
+        }
+        bits |= static_cast<uint64_t>(tables[0]) << 37 | static_cast<uint64_t>(tables[1]) << 34;
+        bits |= static_cast<uint64_t>(differential) << 33 | static_cast<uint64_t>(flip) << 32;
+        for (int p = 0; p < 16; ++p) {
+            bits |= static_cast<uint64_t>(selectors[p] >> 1) << (16 + p) | static_cast<uint64_t>(selectors[p] & 1) << p;
+        }
+        bestBits = bits;
+    }
+
+    for (size_t i = 0; i < ETC1_BLOCK_BYTES; ++i) {
+        output[i] = static_cast<unsigned char>(bestBits >> (56 - 8 * i));
+    }
+}
+
+/**
+ * Encodes a square RGB image to ETC1. Blocks extending past the image repeat its edge pixels.
+ */
+std::vector<unsigned char> encodeETC1(const std::vector<unsigned char> &pixels, unsigned int size) {
+    unsigned int blocksPerRow = (size + 3) / 4;
+    std::vector<unsigned char> output(static_cast<size_t>(blocksPerRow) * blocksPerRow * ETC1_BLOCK_BYTES);
+    unsigned char *block = output.data();
+    int blockPixels[16][3];
+    for (unsigned int blockY = 0; blockY < blocksPerRow; ++blockY) {
+        for (unsigned int blockX = 0; blockX < blocksPerRow; ++blockX) {
+            for (int p = 0; p < 16; ++p) {
+                unsigned int x = std::min(blockX * 4 + p / 4, size - 1);
+                unsigned int y = std::min(blockY * 4 + p % 4, size - 1);
+                const unsigned char *pixel = &pixels[(static_cast<size_t>(y) * size + x) * 3];
+                for (int c = 0; c < 3; ++c) {
+                    blockPixels[p][c] = pixel[c];
+                }
+            }
+            encodeETC1Block(blockPixels, block);
+            block += ETC1_BLOCK_BYTES;
+        }
+    }
+    return output;
+}
+
+std::string etc1CachePath() {
+    std::error_code error;
+    fs::path directory = fs::temp_directory_path(error);
+    if (error) {
+        directory = "/tmp";
+    }
+    return (directory / ("valyria-sampling-etc1-" + std::to_string(TEXTURE_SIZE) + ".ktx")).string();
+}
+
+} // namespace
+
+TextureSampling::TextureSampling(const std::string &taskName, Format format)
+    : RenderTask(taskName), format(format), bitsPerTexel(0.0), quadVBO(0), texture(0), imageLocation(-1),
+      offsetLocation(-1), scaleLocation(-1) {}
+
+bool TextureSampling::setup() {
+    if (!createTexture()) {
+        logError("TextureSampling: failed to create the texture.");
+        return false;
+    }
+
+    GLfloat quadVertices[] = {
+        -1.0f, -1.0f, // Bottom left
+        1.0f,  -1.0f, // Bottom right
+        -1.0f, 1.0f,  // Top left
+        1.0f,  1.0f   // Top right
+    };
+
+    glGenBuffers(1, &quadVBO);
+    GLStateCache::getInstance().bindArrayBuffer(quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
+
+    programHandle =
+        ShaderManager::getInstance().createShaderProgram("SamplingShader", "sampling.vert", "sampling.frag");
+    if (!programHandle.isValid()) {
+        logError("Failed to create the SamplingShader program.");
+        return false;
+    }
+
+    program = ShaderManager::getInstance().getShaderProgram(programHandle);
+    imageLocation = program->getUniformLocation("image");
+    offsetLocation = program->getUniformLocation("offset");
+    scaleLocation = program->getUniformLocation("scale");
+    if (imageLocation == -1 || offsetLocation == -1 || scaleLocation == -1) {
+        logError("TextureSampling: Failed to retrieve the uniform locations.");
+        return false;
+    }
+
+    logDebug("TextureSampling setup OK.");
+    return true;
+}
+
+std::vector<ShaderProgramSource> TextureSampling::getShaderPrograms() const {
+    return {{"SamplingShader", "sampling.vert", "sampling.frag", {}}};
+}
+
+void TextureSampling::teardown() {
+    GLStateCache &stateCache = GLStateCache::getInstance();
+    stateCache.setBlendEnabled(false);
+    stateCache.deleteTexture(texture);
+    texture = 0;
+    stateCache.deleteBuffer(quadVBO);
+    quadVBO = 0;
+    program.reset();
+    programHandle = ShaderProgramHandle();
+
+    if (!ShaderManager::getInstance().removeShaderProgram("SamplingShader")) {
+        logError("Failed to remove the SamplingShader program.");
+    }
+}
+
+void TextureSampling::render(int width, int height) {
+    ShaderManager::getInstance().use(programHandle);
+    program->setUniform(imageLocation, 0);
+    // One texel per pixel, so that the base level is sampled.
+    program->setUniform(scaleLocation, static_cast<GLfloat>(width) / TEXTURE_SIZE,
+                        static_cast<GLfloat>(height) / TEXTURE_SIZE);
+
+    GLStateCache &stateCache = GLStateCache::getInstance();
+    stateCache.viewport(0, 0, width, height);
+    stateCache.setBlendEnabled(true);
+    stateCache.blendFunc(GL_ONE, GL_ONE);
+    stateCache.activeTexture(GL_TEXTURE0);
+    stateCache.bindTexture(GL_TEXTURE_2D, texture);
+    stateCache.bindArrayBuffer(quadVBO);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    stateCache.setVertexAttribArrays(1u << 0);
+
+    auto samplingStart = std::chrono::steady_clock::now();
+    for (int layer = 0; layer < SAMPLING_LAYERS; ++layer) {
+        // Golden ratio offsets spread the layers over the texture.
+        float intPart;
+        program->setUniform(offsetLocation, std::modf(layer * 0.618034f, &intPart),
+                            std::modf(layer * 0.381966f, &intPart));
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+    glFinish();
+    double samplingMs = Statistics::elapsedMs(samplingStart, std::chrono::steady_clock::now());
+
+    double texels = static_cast<double>(SAMPLING_LAYERS) * width * height;
+    recordTaskMetric("Sampling time (ms)", samplingMs);
+    if (samplingMs > 0.0) {
+        recordTaskMetric("Texel rate (Mtexels/s)", texels / (samplingMs * 1000.0));
+        recordTaskMetric("Texture bandwidth (MB/s)", texels * bitsPerTexel / 8.0 / (samplingMs * 1000.0));
+    }
+}
+
+void TextureSampling::update(float elapsedTime, float deltaTime) {}
+
+bool TextureSampling::createTexture() {
+    MipmapChain chain = generateContent(TEXTURE_SIZE);
+    if (format == Format::ETC1) {
+        return loadETC1Texture(chain);
+    }
+
+    GLStateCache &stateCache = GLStateCache::getInstance();
+    glGenTextures(1, &texture);
+    stateCache.activeTexture(GL_TEXTURE0);
+    stateCache.bindTexture(GL_TEXTURE_2D, texture);
+
+    bitsPerTexel = format == Format::RGBA8 ? 32.0 : 16.0;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, format == Format::RGBA8 ? 4 : 2);
+    size_t sizeBytes = 0;
+    std::vector<unsigned char> converted;
+    for (size_t level = 0; level < chain.levels.size(); ++level) {
+        const std::vector<unsigned char> &rgb = chain.levels[level].pixels;
+        size_t texels = rgb.size() / 3;
+        GLsizei levelSize = static_cast<GLsizei>(std::max(chain.size >> level, 1u));
+        if (format == Format::RGBA8) {
+            converted.resize(texels * 4);
+            for (size_t i = 0; i < texels; ++i) {
+                std::memcpy(&converted[i * 4], &rgb[i * 3], 3);
+                converted[i * 4 + 3] = 255;
+            }
+            glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGBA, levelSize, levelSize, 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, converted.data());
+        } else {
+            converted.resize(texels * 2);
+            uint16_t *texel = reinterpret_cast<uint16_t *>(converted.data());
+            for (size_t i = 0; i < texels; ++i) {
+                const unsigned char *color = &rgb[i * 3];
+                texel[i] = static_cast<uint16_t>((color[0] >> 3) << 11 | (color[1] >> 2) << 5 | color[2] >> 3);
+            }
+            glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGB, levelSize, levelSize, 0, GL_RGB,
+                         GL_UNSIGNED_SHORT_5_6_5, converted.data());
+        }
+        sizeBytes += converted.size();
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    stateCache.bindTexture(GL_TEXTURE_2D, 0);
+
+    recordTaskMetric("Texture memory (KB)", sizeBytes / 1024.0);
+    return true;
+}
+
+bool TextureSampling::loadETC1Texture(const MipmapChain &chain) {
+    if (!ImageLoader::isCompressedFormatSupported(GL_ETC1_RGB8_OES)) {
+        logError("TextureSampling: the driver does not support ETC1 textures.");
+        return false;
+    }
+
+    std::string filePath = etc1CachePath();
+    std::error_code error;
+    if (!fs::exists(filePath, error)) {
+        logInfo("Encoding the ETC1 sampling texture to " + filePath);
+        if (!writeETC1KTX(filePath, chain)) {
+            return false;
+        }
+    }
+
+    CompressedTextureInfo info;
+    texture = ImageLoader::loadCompressedTexture(filePath, &info);
+    if (texture == 0) {
+        // Encode it again on the next run.
+        fs::remove(filePath, error);
+        return false;
+    }
+
+    bitsPerTexel = 4.0;
+    recordTaskMetric("Texture memory (KB)", info.sizeBytes / 1024.0);
+    return true;
+}
+
+TextureSampling::MipmapChain TextureSampling::generateContent(unsigned int size) {
+    MipmapChain chain;
+    chain.size = size;
+    ImageData base;
+    base.width = size;
+    base.height = size;
+    base.format = GL_RGB;
+    base.pixels.resize(static_cast<size_t>(size) * size * 3);
+    unsigned char *pixel = base.pixels.data();
+    for (unsigned int y = 0; y < size; ++y) {
+        for (unsigned int x = 0; x < size; ++x) {
+            // Each tile has a gradient background, a lighter rounded panel and lines of text-like marks.
+            unsigned int tile = (y / CONTENT_TILE_SIZE) * (size / CONTENT_TILE_SIZE) + x / CONTENT_TILE_SIZE;
+            float u = static_cast<float>(x % CONTENT_TILE_SIZE) / CONTENT_TILE_SIZE;
+            float v = static_cast<float>(y % CONTENT_TILE_SIZE) / CONTENT_TILE_SIZE;
+            float color[3] = {static_cast<float>(40 + tile * 67 % 160), static_cast<float>(40 + tile * 31 % 160),
+                              static_cast<float>(40 + tile * 97 % 160)};
+            float shade = 0.55f + 0.45f * v;
+
+            float dx = std::max(std::fabs(u - 0.5f) - 0.32f, 0.0f);
+            float dy = std::max(std::fabs(v - 0.32f) - 0.16f, 0.0f);
+            bool panel = dx * dx + dy * dy < 0.06f * 0.06f;
+            unsigned int line = (y % CONTENT_TILE_SIZE) / 16;
+            unsigned int glyph = (x % CONTENT_TILE_SIZE) / 6;
+            bool text = v > 0.62f && v < 0.94f && (y % 16) < 9 && u > 0.1f && u < 0.9f &&
+                        ((glyph * 7 + line * 13 + tile) % 5 != 0) && (x % 6) < 4;
+
+            for (int c = 0; c < 3; ++c) {
+                float value = color[c] * shade;
+                if (panel) {
+                    value = 0.5f * (value + 255.0f);
+                } else if (text) {
+                    value = 235.0f;
+                }
+                pixel[c] = static_cast<unsigned char>(value);
+            }
+            pixel += 3;
+        }
+    }
+    chain.levels.push_back(std::move(base));
+
+    // Box-filtered mipmap levels down to 1x1.
+    while (chain.levels.back().width > 1) {
+        ImageData level;
+        ImageLoader::downsample(chain.levels.back(), level);
+        chain.levels.push_back(std::move(level));
+    }
+    return chain;
+}
+
+bool TextureSampling::writeETC1KTX(const std::string &filePath, const MipmapChain &chain) {
+    uint32_t header[13] = {KTX_BYTE_ORDER,
+                           0, // glType: compressed
+                           1, // glTypeSize
+                           0, // glFormat: compressed
+                           GL_ETC1_RGB8_OES,
+                           GL_RGB,
+                           chain.size,
+                           chain.size,
+                           0, // pixelDepth
+                           0, // numberOfArrayElements
+                           1, // numberOfFaces
+                           static_cast<uint32_t>(chain.levels.size()),
+                           0}; // bytesOfKeyValueData
+
+    // Encoding takes seconds; the file only appears under its final name once complete, so a run
+    // interrupted meanwhile encodes again instead of loading a truncated texture.
+    std::string temporaryPath = filePath + ".tmp";
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(KTX_SIGNATURE), sizeof(KTX_SIGNATURE));
+    file.write(reinterpret_cast<const char *>(header), sizeof(header));
+    for (size_t level = 0; level < chain.levels.size(); ++level) {
+        // ETC1 levels are a multiple of 8 bytes, so they need no padding.
+        std::vector<unsigned char> blocks = encodeETC1(chain.levels[level].pixels, std::max(chain.size >> level, 1u));
+        uint32_t imageSize = static_cast<uint32_t>(blocks.size());
+        file.write(reinterpret_cast<const char *>(&imageSize), sizeof(imageSize));
+        file.write(reinterpret_cast<const char *>(blocks.data()), blocks.size());
+    }
+    file.close();
+    if (!file || std::rename(temporaryPath.c_str(), filePath.c_str()) != 0) {
+        logError("Failed to write the ETC1 texture: " + filePath);
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
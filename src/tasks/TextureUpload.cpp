@@ -0,0 +1,399 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "tasks/TextureUpload.h"
+#include "ConfigurationManager.h"
+#include "GLStateCache.h"
+#include "Logger.h"
+#include "Statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <thread>
+
+#include <jpeglib.h>
+#include <png.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/**
+ * Sizes of the synthetic corpus: posters and full-screen backgrounds.
+ */
+const std::pair<unsigned int, unsigned int> CORPUS_SIZES[] = {{256, 384}, {512, 768}, {1280, 720}, {1920, 1080}};
+
+constexpr int CORPUS_JPG_QUALITY = 85;
+
+/**
+ * An image is uploaded every this many frames, so that frames with and without an upload alternate.
+ */
+constexpr unsigned int UPLOAD_INTERVAL = 2;
+
+/**
+ * Pooled decode buffers and requests in flight per async loader worker.
+ */
+constexpr size_t BUFFERS_PER_WORKER = 1;
+constexpr size_t PENDING_LOADS_PER_WORKER = 2;
+
+double megabytesPerSecond(size_t bytes, double ms) { return ms > 0.0 ? bytes / (ms * 1000.0) : 0.0; }
+
+void listImages(const std::string &directory, std::vector<std::string> &files) {
+    files.clear();
+    std::error_code error;
+    for (const auto &entry : fs::directory_iterator(directory, error)) {
+        if (entry.is_regular_file() && ImageLoader::hasExtension(entry.path().string(), {".png", ".jpg", ".jpeg"})) {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+}
+
+/**
+ * Throughput metrics are grouped by decoded resolution and file format, e.g. "1920x1080 JPG decode (MB/s)",
+ * as PNG and JPG decode at very different rates. The format is taken from the extension the corpus is listed by.
+ */
+std::string metricGroup(const std::string &filePath, unsigned int width, unsigned int height) {
+    const char *format = ImageLoader::hasExtension(filePath, {".jpg", ".jpeg"}) ? "JPG" : "PNG";
+    return std::to_string(width) + "x" + std::to_string(height) + " " + format;
+}
+
+/**
+ * Fills an RGB image with smooth gradients, shapes and fine noise, which compresses like poster art
+ * rather than like a flat color.
+ */
+ImageData generateImage(unsigned int width, unsigned int height) {
+    ImageData image;
+    image.width = width;
+    image.height = height;
+    image.format = GL_RGB;
+    image.pixels.resize(static_cast<size_t>(width) * height * 3);
+
+    uint32_t noise = 0x9e3779b9u;
+    unsigned char *pixel = image.pixels.data();
+    for (unsigned int y = 0; y < height; ++y) {
+        float v = static_cast<float>(y) / height;
+        for (unsigned int x = 0; x < width; ++x) {
+            float u = static_cast<float>(x) / width;
+            float shape = 0.5f + 0.5f * std::sin(u * 11.0f + std::cos(v * 7.0f) * 3.0f) * std::cos(v * 9.0f);
+            noise = noise * 1664525u + 1013904223u;
+            int grain = static_cast<int>(noise >> 28) - 8;
+            pixel[0] = static_cast<unsigned char>(std::clamp(static_cast<int>(255.0f * u * shape) + grain, 0, 255));
+            pixel[1] = static_cast<unsigned char>(std::clamp(static_cast<int>(255.0f * v) + grain, 0, 255));
+            pixel[2] = static_cast<unsigned char>(std::clamp(static_cast<int>(255.0f * shape) + grain, 0, 255));
+            pixel += 3;
+        }
+    }
+    return image;
+}
+
+} // namespace
+
+TextureUpload::TextureUpload(const std::string &taskName, bool async)
+    : RenderTask(taskName), async(async), nextImage(0), frame(0), uploadedLastFrame(false), maxPendingLoads(0),
+      uploadBudgetBytes(0), loadedInWindow(0), quadVBO(0), texture(0), imageLocation(-1) {}
+
+bool TextureUpload::setup() {
+    nextImage = 0;
+    frame = 0;
+    uploadedLastFrame = false;
+    ConfigurationManager &configManager = ConfigurationManager::getInstance();
+    if (!loadCorpus(configManager.getValue("texture_corpus"), corpus)) {
+        logError("TextureUpload: no images to load.");
+        return false;
+    }
+
+    if (async) {
+        // One core is left to the GL thread.
+        unsigned int workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        loader.start(workerCount, workerCount + BUFFERS_PER_WORKER);
+        maxPendingLoads = workerCount * PENDING_LOADS_PER_WORKER;
+        uploadBudgetBytes = std::stoul(configManager.getValue("texture_upload_budget")) * 1024;
+        loadedInWindow = 0;
+        windowStart = std::chrono::steady_clock::now();
+    }
+
+    GLfloat quadVertices[] = {
+        -1.0f, -1.0f, // Bottom left
+        1.0f,  -1.0f, // Bottom right
+        -1.0f, 1.0f,  // Top left
+        1.0f,  1.0f   // Top right
+    };
+
+    glGenBuffers(1, &quadVBO);
+    GLStateCache::getInstance().bindArrayBuffer(quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
+
+    programHandle = ShaderManager::getInstance().createShaderProgram("TextureShader", "quad.vert", "texture.frag");
+    if (!programHandle.isValid()) {
+        logError("Failed to create the TextureShader program.");
+        return false;
+    }
+
+    program = ShaderManager::getInstance().getShaderProgram(programHandle);
+    imageLocation = program->getUniformLocation("image");
+    if (imageLocation == -1) {
+        logError("TextureUpload: Failed to retrieve the image uniform location.");
+        return false;
+    }
+
+    logDebug("TextureUpload setup OK, " + std::to_string(corpus.size()) + " images.");
+    return true;
+}
+
+std::vector<ShaderProgramSource> TextureUpload::getShaderPrograms() const {
+    return {{"TextureShader", "quad.vert", "texture.frag", {}}};
+}
+
+void TextureUpload::teardown() {
+    loader.stop();
+    pendingLoads.clear();
+    GLStateCache &stateCache = GLStateCache::getInstance();
+    stateCache.deleteTexture(texture);
+    texture = 0;
+    stateCache.deleteBuffer(quadVBO);
+    quadVBO = 0;
+    program.reset();
+    programHandle = ShaderProgramHandle();
+    corpus.clear();
+    image = ImageData();
+
+    if (!ShaderManager::getInstance().removeShaderProgram("TextureShader")) {
+        logError("Failed to remove the TextureShader program.");
+    }
+}
+
+void TextureUpload::render(int width, int height) {
+    // The interval to the next frame includes the swap, which may wait for the upload to complete.
+    auto renderTime = std::chrono::steady_clock::now();
+    if (frame > 0 && async) {
+        recordTaskMetric("Frame interval (ms)", Statistics::elapsedMs(lastRenderTime, renderTime));
+    } else if (frame > 0) {
+        recordTaskMetric(uploadedLastFrame ? "Frame interval after upload (ms)" : "Frame interval without upload (ms)",
+                         Statistics::elapsedMs(lastRenderTime, renderTime));
+    }
+    lastRenderTime = renderTime;
+
+    if (async) {
+        streamImages();
+    } else {
+        uploadedLastFrame = frame % UPLOAD_INTERVAL == 0;
+        if (uploadedLastFrame) {
+            uploadNextImage();
+        }
+    }
+    ++frame;
+
+    if (texture == 0) {
+        return;
+    }
+
+    ShaderManager::getInstance().use(programHandle);
+    program->setUniform(imageLocation, 0);
+
+    GLStateCache &stateCache = GLStateCache::getInstance();
+    stateCache.viewport(0, 0, width, height);
+    stateCache.activeTexture(GL_TEXTURE0);
+    stateCache.bindTexture(GL_TEXTURE_2D, texture);
+    stateCache.bindArrayBuffer(quadVBO);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    stateCache.setVertexAttribArrays(1u << 0);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
+
+void TextureUpload::update(float elapsedTime, float deltaTime) {}
+
+void TextureUpload::uploadNextImage() {
+    const std::string &filePath = corpus[nextImage];
+    nextImage = (nextImage + 1) % corpus.size();
+
+    ImageDecodeStatistics decodeBefore = ImageLoader::getDecodeStatistics();
+    auto decodeStart = std::chrono::steady_clock::now();
+    if (!ImageLoader::decodeImage(filePath, image)) {
+        logError("TextureUpload: failed to decode '" + filePath + "'.");
+        return;
+    }
+    auto decodeEnd = std::chrono::steady_clock::now();
+    ImageDecodeStatistics decodeAfter = ImageLoader::getDecodeStatistics();
+    GLuint newTexture = ImageLoader::createTexture(image);
+    auto uploadEnd = std::chrono::steady_clock::now();
+
+    // Throughput is relative to the decoded size, which is what the upload transfers.
+    std::string group = metricGroup(filePath, image.width, image.height);
+    double decodeMs = Statistics::elapsedMs(decodeStart, decodeEnd);
+    double uploadMs = Statistics::elapsedMs(decodeEnd, uploadEnd);
+    recordTaskMetric(group + " decode (MB/s)", megabytesPerSecond(image.getSizeBytes(), decodeMs));
+    recordTaskMetric(group + " upload (MB/s)", megabytesPerSecond(image.getSizeBytes(), uploadMs));
+    recordTaskMetric("Images per second", 1000.0 / (decodeMs + uploadMs));
+    recordTaskMetric("Files opened per image", decodeAfter.fileOpens - decodeBefore.fileOpens);
+    recordTaskMetric("Buffer allocations per image", decodeAfter.bufferAllocations - decodeBefore.bufferAllocations);
+    recordTaskMetric("Bytes copied per image", decodeAfter.bytesCopied - decodeBefore.bytesCopied);
+
+    GLStateCache::getInstance().deleteTexture(texture);
+    texture = newTexture;
+}
+
+void TextureUpload::streamImages() {
+    while (pendingLoads.size() < maxPendingLoads) {
+        pendingLoads.push_back(loader.load(corpus[nextImage]));
+        nextImage = (nextImage + 1) % corpus.size();
+    }
+
+    loader.processUploads(uploadBudgetBytes);
+
+    for (auto it = pendingLoads.begin(); it != pendingLoads.end();) {
+        if (it->wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++it;
+            continue;
+        }
+        GLuint newTexture = it->get();
+        it = pendingLoads.erase(it);
+        if (newTexture != 0) {
+            GLStateCache::getInstance().deleteTexture(texture);
+            texture = newTexture;
+            ++loadedInWindow;
+        }
+    }
+
+    for (const TextureLoadTiming &timing : loader.takeTimings()) {
+        std::string group = metricGroup(timing.filePath, timing.width, timing.height);
+        recordTaskMetric(group + " decode (MB/s)", megabytesPerSecond(timing.bytes, timing.decodeMs));
+        recordTaskMetric(group + " upload (MB/s)", megabytesPerSecond(timing.bytes, timing.uploadCallMs));
+        recordTaskMetric("Decode wait (ms)", timing.decodeWaitMs);
+        recordTaskMetric("Upload wait (ms)", timing.uploadWaitMs);
+        recordTaskMetric("Upload latency (ms)", timing.uploadMs);
+        recordTaskMetric("Load latency (ms)", timing.totalMs);
+    }
+    recordTaskMetric("Decode queue depth", loader.getDecodeQueueDepth());
+    recordTaskMetric("Upload queue depth", loader.getUploadQueueDepth());
+
+    auto now = std::chrono::steady_clock::now();
+    double windowMs = Statistics::elapsedMs(windowStart, now);
+    if (windowMs >= 1000.0) {
+        recordTaskMetric("Images loaded per second", loadedInWindow * 1000.0 / windowMs);
+        loadedInWindow = 0;
+        windowStart = now;
+    }
+}
+
+bool TextureUpload::loadCorpus(const std::string &directory, std::vector<std::string> &files) {
+    listImages(directory, files);
+    if (files.empty()) {
+        logInfo("Generating a synthetic texture corpus in " + directory);
+        if (!generateCorpus(directory)) {
+            return false;
+        }
+        listImages(directory, files);
+    }
+    return !files.empty();
+}
+
+bool TextureUpload::generateCorpus(const std::string &directory) {
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if (error) {
+        logError("Failed to create the texture corpus directory: " + directory);
+        return false;
+    }
+
+    for (const auto &size : CORPUS_SIZES) {
+        ImageData image = generateImage(size.first, size.second);
+        std::string baseName = directory + "/" + std::to_string(size.first) + "x" + std::to_string(size.second);
+        if (!writeJPG(baseName + ".jpg", image, CORPUS_JPG_QUALITY) || !writePNG(baseName + ".png", image)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TextureUpload::writePNG(const std::string &filePath, const ImageData &image) {
+    FILE *outfile = fopen(filePath.c_str(), "wb");
+    if (!outfile) {
+        logError("Failed to create image file: " + filePath);
+        return false;
+    }
+
+    png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info_ptr = png_ptr ? png_create_info_struct(png_ptr) : nullptr;
+    if (!info_ptr) {
+        png_destroy_write_struct(&png_ptr, nullptr);
+        fclose(outfile);
+        logError("Failed to create PNG write structure");
+        return false;
+    }
+
+    if (setjmp(png_jmpbuf(png_ptr))) {
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        fclose(outfile);
+        logError("Failed to write PNG image: " + filePath);
+        return false;
+    }
+
+    int colorType = image.format == GL_RGBA ? PNG_COLOR_TYPE_RGBA : PNG_COLOR_TYPE_RGB;
+    size_t rowStride = image.getSizeBytes() / image.height;
+    png_init_io(png_ptr, outfile);
+    png_set_IHDR(png_ptr, info_ptr, image.width, image.height, 8, colorType, PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png_ptr, info_ptr);
+    for (unsigned int y = 0; y < image.height; ++y) {
+        png_write_row(png_ptr, const_cast<png_bytep>(&image.pixels[y * rowStride]));
+    }
+    png_write_end(png_ptr, nullptr);
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+    fclose(outfile);
+    return true;
+}
+
+bool TextureUpload::writeJPG(const std::string &filePath, const ImageData &image, int quality) {
+    if (image.format != GL_RGB) {
+        logError("Only RGB images can be written as JPG: " + filePath);
+        return false;
+    }
+
+    FILE *outfile = fopen(filePath.c_str(), "wb");
+    if (!outfile) {
+        logError("Failed to create image file: " + filePath);
+        return false;
+    }
+
+    struct jpeg_compress_struct cinfo;
+    struct jpeg_error_mgr jerr;
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_compress(&cinfo);
+    jpeg_stdio_dest(&cinfo, outfile);
+    cinfo.image_width = image.width;
+    cinfo.image_height = image.height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, quality, TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+
+    size_t rowStride = static_cast<size_t>(image.width) * 3;
+    while (cinfo.next_scanline < cinfo.image_height) {
+        JSAMPROW row = const_cast<JSAMPROW>(&image.pixels[cinfo.next_scanline * rowStride]);
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    fclose(outfile);
+    return true;
+}
@@ -0,0 +1,186 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "tasks/ThumbnailDecode.h"
+#include "ConfigurationManager.h"
+#include "GLStateCache.h"
+#include "Logger.h"
+#include "Statistics.h"
+#include "tasks/TextureUpload.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+/**
+ * Size a thumbnail is drawn at: a quarter of a full HD poster.
+ */
+constexpr unsigned int THUMBNAIL_WIDTH = 480;
+constexpr unsigned int THUMBNAIL_HEIGHT = 270;
+
+/**
+ * Number of recent thumbnails kept and drawn.
+ */
+constexpr size_t THUMBNAIL_SLOTS = 8;
+
+} // namespace
+
+ThumbnailDecode::ThumbnailDecode(const std::string &taskName, bool scaledDecode, MipmapGeneration mipmaps)
+    : RenderTask(taskName), scaledDecode(scaledDecode), mipmaps(mipmaps), nextImage(0), nextThumbnail(0), quadVBO(0),
+      imageLocation(-1) {}
+
+bool ThumbnailDecode::setup() {
+    nextImage = 0;
+    nextThumbnail = 0;
+    thumbnails.assign(THUMBNAIL_SLOTS, 0);
+    TextureUpload::loadCorpus(ConfigurationManager::getInstance().getValue("texture_corpus"), corpus);
+    corpus.erase(std::remove_if(corpus.begin(), corpus.end(),
+                                [](const std::string &file) {
+                                    return !ImageLoader::hasExtension(file, {".jpg", ".jpeg"});
+                                }),
+                 corpus.end());
+    if (corpus.empty()) {
+        logError("ThumbnailDecode: no JPG images to load.");
+        return false;
+    }
+
+    GLfloat quadVertices[] = {
+        -1.0f, -1.0f, // Bottom left
+        1.0f,  -1.0f, // Bottom right
+        -1.0f, 1.0f,  // Top left
+        1.0f,  1.0f   // Top right
+    };
+
+    glGenBuffers(1, &quadVBO);
+    GLStateCache::getInstance().bindArrayBuffer(quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
+
+    programHandle = ShaderManager::getInstance().createShaderProgram("ThumbnailShader", "quad.vert", "texture.frag");
+    if (!programHandle.isValid()) {
+        logError("Failed to create the ThumbnailShader program.");
+        return false;
+    }
+
+    program = ShaderManager::getInstance().getShaderProgram(programHandle);
+    imageLocation = program->getUniformLocation("image");
+    if (imageLocation == -1) {
+        logError("ThumbnailDecode: Failed to retrieve the image uniform location.");
+        return false;
+    }
+
+    logDebug("ThumbnailDecode setup OK, " + std::to_string(corpus.size()) + " images.");
+    return true;
+}
+
+std::vector<ShaderProgramSource> ThumbnailDecode::getShaderPrograms() const {
+    return {{"ThumbnailShader", "quad.vert", "texture.frag", {}}};
+}
+
+void ThumbnailDecode::teardown() {
+    GLStateCache &stateCache = GLStateCache::getInstance();
+    for (GLuint thumbnail : thumbnails) {
+        stateCache.deleteTexture(thumbnail);
+    }
+    thumbnails.clear();
+    stateCache.deleteBuffer(quadVBO);
+    quadVBO = 0;
+    program.reset();
+    programHandle = ShaderProgramHandle();
+    corpus.clear();
+    image = ImageData();
+
+    if (!ShaderManager::getInstance().removeShaderProgram("ThumbnailShader")) {
+        logError("Failed to remove the ThumbnailShader program.");
+    }
+}
+
+void ThumbnailDecode::render(int width, int height) {
+    loadNextThumbnail();
+
+    ShaderManager::getInstance().use(programHandle);
+    program->setUniform(imageLocation, 0);
+
+    GLStateCache &stateCache = GLStateCache::getInstance();
+    stateCache.activeTexture(GL_TEXTURE0);
+    stateCache.bindArrayBuffer(quadVBO);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    stateCache.setVertexAttribArrays(1u << 0);
+
+    // Each thumbnail fills its own grid cell, so the full-screen quad is drawn into the cell's viewport.
+    int columns = std::max(width / static_cast<int>(THUMBNAIL_WIDTH), 1);
+    for (size_t slot = 0; slot < thumbnails.size(); ++slot) {
+        int x = static_cast<int>(slot % columns) * THUMBNAIL_WIDTH;
+        int y = static_cast<int>(slot / columns) * THUMBNAIL_HEIGHT;
+        if (thumbnails[slot] == 0 || y >= height) {
+            continue;
+        }
+        stateCache.viewport(x, height - y - THUMBNAIL_HEIGHT, THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT);
+        stateCache.bindTexture(GL_TEXTURE_2D, thumbnails[slot]);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+}
+
+void ThumbnailDecode::update(float elapsedTime, float deltaTime) {}
+
+void ThumbnailDecode::loadNextThumbnail() {
+    const std::string &filePath = corpus[nextImage];
+    nextImage = (nextImage + 1) % corpus.size();
+
+    auto decodeStart = std::chrono::steady_clock::now();
+    bool decoded = scaledDecode ? ImageLoader::decodeImage(filePath, image, THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT)
+                                : ImageLoader::decodeImage(filePath, image);
+    if (!decoded) {
+        logError("ThumbnailDecode: failed to decode '" + filePath + "'.");
+        return;
+    }
+    auto decodeEnd = std::chrono::steady_clock::now();
+
+    // The driver may defer both the upload and glGenerateMipmap, so each GPU step is timed to completion with
+    // glFinish, after draining earlier frames, to make CPU and GPU mipmap generation comparable.
+    glFinish();
+    auto uploadStart = std::chrono::steady_clock::now();
+    GLuint texture = ImageLoader::createTexture(image);
+    glFinish();
+    auto uploadEnd = std::chrono::steady_clock::now();
+    bool mipmapped = ImageLoader::generateMipmaps(texture, image, mipmaps);
+    glFinish();
+    auto mipmapEnd = std::chrono::steady_clock::now();
+
+    GLStateCache::getInstance().deleteTexture(thumbnails[nextThumbnail]);
+    thumbnails[nextThumbnail] = texture;
+    nextThumbnail = (nextThumbnail + 1) % thumbnails.size();
+
+    // Memory is compared with the full-size texture the image would need without scaled decoding.
+    size_t bytesPerPixel = image.format == GL_RGBA ? 4 : 3;
+    size_t sizeBytes = ImageLoader::getTextureSizeBytes(image.width, image.height, bytesPerPixel, mipmapped);
+    size_t fullSizeBytes =
+        ImageLoader::getTextureSizeBytes(image.sourceWidth, image.sourceHeight, bytesPerPixel, mipmapped);
+    double decodeMs = Statistics::elapsedMs(decodeStart, decodeEnd);
+    double uploadMs = Statistics::elapsedMs(uploadStart, uploadEnd);
+    double mipmapMs = Statistics::elapsedMs(uploadEnd, mipmapEnd);
+    recordTaskMetric("Decode (ms)", decodeMs);
+    recordTaskMetric("Upload (ms)", uploadMs);
+    if (mipmapped) {
+        recordTaskMetric("Mipmap generation (ms)", mipmapMs);
+    }
+    recordTaskMetric("Images per second", 1000.0 / (decodeMs + uploadMs + mipmapMs));
+    recordTaskMetric("Texture memory (KB)", sizeBytes / 1024.0);
+    recordTaskMetric("Texture memory saved (%)", 100.0 * (1.0 - static_cast<double>(sizeBytes) / fullSizeBytes));
+}
@@ -18,6 +18,7 @@
 */
 
 #include "tasks/Triangle.h"
+#include "GLStateCache.h"
 #include "Logger.h"
 #include "ShaderManager.h"
 
@@ -27,15 +28,17 @@ Triangle::Triangle(const std::string &taskName)
     : RenderTask(taskName), rotationUniform(0), posAttrib(0), colorAttrib(0), rotationAngle(0.0f) {}
 
 bool Triangle::setup() {
-    if (!ShaderManager::getInstance().createShaderProgram("TriangleShader", "triangle.vert", "triangle.frag")) {
+    programHandle = ShaderManager::getInstance().createShaderProgram("TriangleShader", "triangle.vert", "triangle.frag");
+    if (!programHandle.isValid()) {
         logError("Failed to create the TriangleShader program.");
         return false;
     }
 
-    GLuint programID = ShaderManager::getInstance().getShaderProgram("TriangleShader")->getProgramID();
+    program = ShaderManager::getInstance().getShaderProgram(programHandle);
+    GLuint programID = program->getProgramID();
     posAttrib = glGetAttribLocation(programID, "pos");
     colorAttrib = glGetAttribLocation(programID, "color");
-    rotationUniform = glGetUniformLocation(programID, "rotation");
+    rotationUniform = program->getUniformLocation("rotation");
 
    if (posAttrib == -1 || colorAttrib == -1 || rotationUniform == -1) {
         logError("Triangle: Failed to retrieve one or more uniform locations.");
@@ -46,14 +49,20 @@ bool Triangle::setup() {
     return true;
 }
 
+std::vector<ShaderProgramSource> Triangle::getShaderPrograms() const {
+    return {{"TriangleShader", "triangle.vert", "triangle.frag", {}}};
+}
+
 void Triangle::teardown() {
+    program.reset();
+    programHandle = ShaderProgramHandle();
     if (!ShaderManager::getInstance().removeShaderProgram("TriangleShader")) {
-        logError("Failed to remove the CubeShader program.");
+        logError("Failed to remove the TriangleShader program.");
     }
 }
 
 void Triangle::render(int width, int height) {
-    ShaderManager::getInstance().useShaderProgram("TriangleShader");
+    ShaderManager::getInstance().use(programHandle);
 
     static const GLfloat verts[3][2] = {
         {-0.5f, -0.5f},
@@ -66,7 +75,8 @@ void Triangle::render(int width, int height) {
         {0.0f, 0.0f, 1.0f, 1.0f}
     };
 
-    glViewport(0, 0, width, height);
+    GLStateCache &stateCache = GLStateCache::getInstance();
+    stateCache.viewport(0, 0, width, height);
     glClear(GL_COLOR_BUFFER_BIT);
 
     GLfloat rotation[4][4] = {
@@ -76,17 +86,15 @@ void Triangle::render(int width, int height) {
         {0.0f, 0.0f, 0.0f, 1.0f}
     };
 
-    glUniformMatrix4fv(rotationUniform, 1, GL_FALSE, (GLfloat *)rotation);
+    program->setUniformMatrix4(rotationUniform, (GLfloat *)rotation);
 
+    // Client-side arrays require the array buffer binding to be 0.
+    stateCache.bindArrayBuffer(0);
     glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, 0, verts);
     glVertexAttribPointer(colorAttrib, 4, GL_FLOAT, GL_FALSE, 0, colors);
-    glEnableVertexAttribArray(posAttrib);
-    glEnableVertexAttribArray(colorAttrib);
+    stateCache.setVertexAttribArrays((1u << posAttrib) | (1u << colorAttrib));
 
     glDrawArrays(GL_TRIANGLES, 0, 3);
-
-    glDisableVertexAttribArray(posAttrib);
-    glDisableVertexAttribArray(colorAttrib);
 }
 
 void Triangle::update(float elapsedTime, float deltaTime) {
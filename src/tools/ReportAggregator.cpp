@@ -0,0 +1,95 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/**
+ * valyria-aggregate: summarizes a directory tree of Valyria JSON reports collected from a device fleet.
+ */
+
+#include "FleetAggregator.h"
+#include "Logger.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: valyria-aggregate <reports_dir> [--output_dir=<dir>] [--threads=<n>]" << std::endl
+              << "Writes fleet_distributions.csv, fleet_trends.csv and fleet_report.html." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string inputDir;
+    std::string outputDir = ".";
+    unsigned threads = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "-h" || argument == "--help") {
+            printUsage();
+            return EXIT_SUCCESS;
+        } else if (argument.rfind("--output_dir=", 0) == 0) {
+            outputDir = argument.substr(13);
+        } else if (argument.rfind("--threads=", 0) == 0) {
+            std::string value = argument.substr(10);
+            try {
+                if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos) {
+                    throw std::invalid_argument(value);
+                }
+                threads = static_cast<unsigned>(std::stoul(value));
+            } catch (const std::exception &) {
+                logError("Invalid thread count: " + value);
+                printUsage();
+                return EXIT_FAILURE;
+            }
+        } else if (inputDir.empty()) {
+            inputDir = argument;
+        } else {
+            logWarn("Ignoring unexpected argument: " + argument);
+        }
+    }
+
+    if (inputDir.empty()) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    FleetAggregator aggregator;
+    size_t parsed = aggregator.ingest(inputDir, threads);
+    auto parseTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+    logInfo("Parsed " + std::to_string(parsed) + " reports in " + std::to_string(parseTime.count()) + " ms.");
+
+    if (parsed == 0) {
+        logError("No Valyria reports found in " + inputDir);
+        return EXIT_FAILURE;
+    }
+
+    bool ok = aggregator.writeDistributionsCSV(outputDir + "/fleet_distributions.csv");
+    ok = aggregator.writeTrendsCSV(outputDir + "/fleet_trends.csv") && ok;
+    ok = aggregator.writeHTML(outputDir + "/fleet_report.html") && ok;
+    if (ok) {
+        logInfo("Fleet report: " + outputDir + "/fleet_report.html");
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
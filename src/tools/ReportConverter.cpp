@@ -0,0 +1,249 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 Sky UK
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/**
+ * valyria-convert: turns a compact binary report (.vbr) into CSV, the JSON report consumed
+ * by HTMLReportGenerator, and the HTML report itself.
+ */
+
+#include "BinaryReport.h"
+#include "HTMLReportGenerator.h"
+#include "Logger.h"
+#include "MetricsCollector.h"
+#include "Statistics.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <cjson/cJSON.h>
+
+namespace {
+
+const char *FRAME_INTERVAL_METRIC = "Frame interval (ms)";
+
+void printUsage() {
+    std::cout << "Usage: valyria-convert <report.vbr> [--csv=<file>] [--json=<file>] [--html=<file>]" << std::endl
+              << "Without output options, <report.vbr>.csv, .json and .html are written next to the input." << std::endl;
+}
+
+bool writeCSV(const BinaryReportReader &reader, const std::string &filePath) {
+    std::FILE *out = std::fopen(filePath.c_str(), "w");
+    if (!out) {
+        logError("Failed to open CSV output: " + filePath);
+        return false;
+    }
+
+    std::fputs("task,column,index,value\n", out);
+    std::vector<double> values;
+    for (const auto &task : reader.getTasks()) {
+        for (const auto &column : task.columns) {
+            if (!BinaryReportReader::decodeColumn(column, values)) {
+                logWarn("Skipping malformed column '" + column.name + "' of task '" + task.name + "'.");
+                continue;
+            }
+            for (size_t i = 0; i < values.size(); ++i) {
+                std::fprintf(out, "\"%s\",\"%s\",%zu,%.6g\n", task.name.c_str(), column.name.c_str(), i, values[i]);
+            }
+        }
+    }
+
+    bool ok = std::fclose(out) == 0;
+    if (ok) {
+        logInfo("CSV report: " + filePath);
+    }
+    return ok;
+}
+
+cJSON *createMetricJSON(const std::vector<double> &values, MetricType type, SummaryStatistics &stats) {
+    cJSON *metricJson = cJSON_CreateObject();
+    if (values.empty()) {
+        return metricJson;
+    }
+
+    stats = Statistics::summarize(values);
+    if (type != MetricType::COUNTER) {
+        cJSON_AddStringToObject(metricJson, "average", Statistics::formatTwoDecimals(stats.average).c_str());
+        cJSON_AddStringToObject(metricJson, "minimum", Statistics::formatTwoDecimals(stats.minimum).c_str());
+        cJSON_AddStringToObject(metricJson, "maximum", Statistics::formatTwoDecimals(stats.maximum).c_str());
+        cJSON_AddStringToObject(metricJson, "std_dev", Statistics::formatTwoDecimals(stats.stdDev).c_str());
+    }
+    if (type == MetricType::DISTRIBUTION) {
+        for (double p : {50.0, 90.0, 99.0}) {
+            std::string key = "p" + std::to_string(static_cast<int>(p));
+            cJSON_AddStringToObject(metricJson, key.c_str(),
+                                    Statistics::formatTwoDecimals(Statistics::percentile(values, p)).c_str());
+        }
+    }
+
+    cJSON *valuesArray = cJSON_CreateArray();
+    for (double value : values) {
+        cJSON_AddItemToArray(valuesArray, cJSON_CreateString(Statistics::formatTwoDecimals(value).c_str()));
+    }
+    cJSON_AddItemToObject(metricJson, "values", valuesArray);
+    return metricJson;
+}
+
+/**
+ * Rebuilds the JSON report structure written by MetricsCollector, adding the per-frame interval
+ * series derived from the frame timestamp column.
+ */
+cJSON *createJSONReport(const BinaryReportReader &reader) {
+    cJSON *reportJson = cJSON_CreateObject();
+
+    cJSON *environmentJson = cJSON_CreateObject();
+    for (const auto &entry : reader.getEnvironment()) {
+        cJSON_AddStringToObject(environmentJson, entry.first.c_str(), entry.second.c_str());
+    }
+    cJSON_AddItemToObject(reportJson, "Environment", environmentJson);
+
+    cJSON *configurationJson = cJSON_CreateObject();
+    for (const auto &entry : reader.getConfiguration()) {
+        cJSON_AddStringToObject(configurationJson, entry.first.c_str(), entry.second.c_str());
+    }
+    cJSON_AddItemToObject(reportJson, "Configuration", configurationJson);
+
+    double combinedScore = 0.0;
+    size_t scoredTasks = 0;
+    cJSON *resultsJson = cJSON_CreateObject();
+    std::vector<double> values;
+    for (const auto &task : reader.getTasks()) {
+        if (task.scored) {
+            ++scoredTasks;
+        }
+        cJSON *taskJson = cJSON_CreateObject();
+        for (const auto &column : task.columns) {
+            if (!BinaryReportReader::decodeColumn(column, values)) {
+                logWarn("Skipping malformed column '" + column.name + "' of task '" + task.name + "'.");
+                continue;
+            }
+
+            SummaryStatistics stats;
+            if (column.name == BinaryReport::FRAME_TIMESTAMP_COLUMN) {
+                std::vector<double> intervals;
+                intervals.reserve(values.size());
+                for (size_t i = 1; i < values.size(); ++i) {
+                    intervals.push_back((values[i] - values[i - 1]) / 1000.0);
+                }
+                cJSON_AddItemToObject(taskJson, FRAME_INTERVAL_METRIC,
+                                      createMetricJSON(intervals, MetricType::GAUGE, stats));
+                continue;
+            }
+
+            MetricType type = static_cast<MetricType>(column.metricType);
+            cJSON_AddItemToObject(taskJson, column.name.c_str(), createMetricJSON(values, type, stats));
+            if (type == MetricType::GAUGE && column.name == "FPS" && task.scored) {
+                combinedScore += Statistics::taskScore(stats);
+            }
+        }
+        cJSON_AddItemToObject(resultsJson, task.name.c_str(), taskJson);
+    }
+    cJSON_AddItemToObject(reportJson, "Benchmark Results", resultsJson);
+
+    int score = scoredTasks ? static_cast<int>(std::round(combinedScore / scoredTasks)) : 0;
+    cJSON_AddStringToObject(reportJson, "Score", std::to_string(score).c_str());
+    return reportJson;
+}
+
+bool writeJSON(const cJSON *reportJson, const std::string &filePath) {
+    char *jsonString = cJSON_Print(reportJson);
+    if (!jsonString) {
+        logError("Failed to create JSON report string.");
+        return false;
+    }
+
+    std::ofstream outFile(filePath);
+    bool ok = outFile.is_open();
+    if (ok) {
+        outFile << jsonString;
+        ok = outFile.good();
+        logInfo("JSON report: " + filePath);
+    } else {
+        logError("Failed to open JSON output: " + filePath);
+    }
+    cJSON_free(jsonString);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string inputPath;
+    std::string csvPath, jsonPath, htmlPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "-h" || argument == "--help") {
+            printUsage();
+            return EXIT_SUCCESS;
+        } else if (argument.rfind("--csv=", 0) == 0) {
+            csvPath = argument.substr(6);
+        } else if (argument.rfind("--json=", 0) == 0) {
+            jsonPath = argument.substr(7);
+        } else if (argument.rfind("--html=", 0) == 0) {
+            htmlPath = argument.substr(7);
+        } else if (inputPath.empty()) {
+            inputPath = argument;
+        } else {
+            logWarn("Ignoring unexpected argument: " + argument);
+        }
+    }
+
+    if (inputPath.empty()) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    if (csvPath.empty() && jsonPath.empty() && htmlPath.empty()) {
+        // Append rather than replace the extension, so converting valyria_report.vbr never overwrites the
+        // JSON and HTML reports written by the same run.
+        csvPath = inputPath + ".csv";
+        jsonPath = inputPath + ".json";
+        htmlPath = inputPath + ".html";
+    }
+
+    BinaryReportReader reader;
+    if (!reader.open(inputPath)) {
+        return EXIT_FAILURE;
+    }
+
+    bool ok = true;
+    if (!csvPath.empty()) {
+        ok = writeCSV(reader, csvPath) && ok;
+    }
+
+    if (!jsonPath.empty() || !htmlPath.empty()) {
+        cJSON *reportJson = createJSONReport(reader);
+        if (!jsonPath.empty()) {
+            ok = writeJSON(reportJson, jsonPath) && ok;
+        }
+        if (!htmlPath.empty()) {
+            HTMLReportGenerator html(reportJson, htmlPath);
+            html.generateReport();
+            logInfo("HTML report: " + htmlPath);
+        }
+        cJSON_Delete(reportJson);
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}